@@ -85,8 +85,12 @@ void ChallengeRunner::operate() {
 
 //　Activate challengeRunner PWM control according to g_challenge_stepNo
 void ChallengeRunner::runChallenge() {
+    runChallenge(g_challenge_stepNo);
+}
+
+void ChallengeRunner::runChallenge(int16_t stepNo) {
 
-    switch (g_challenge_stepNo) {
+    switch (stepNo) {
         //スラローム専用処理
         case 0: // changed
             printf("ぶつかり\n");
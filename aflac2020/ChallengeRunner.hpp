@@ -23,6 +23,7 @@ public:
     void haveControl();
     void operate(); // method to invoke from the cyclic handler
     void runChallenge();
+    void runChallenge(int16_t stepNo); // by the step when the event was posted
     void setPwmLR(int p_L,int p_R,int mode, int proc_count);
     void rest(int16_t rest_time);
     int8_t getPwmL();
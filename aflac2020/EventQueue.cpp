@@ -0,0 +1,63 @@
+//
+//  EventQueue.cpp
+//  aflac2020
+//
+//  Copyright © 2020 Ahiruchan Koubou. All rights reserved.
+//
+
+#include "EventQueue.hpp"
+
+#define _compiler_barrier() __asm__ __volatile__("" ::: "memory")
+
+EventQueue::EventQueue(uint32_t coalescable_mask) : head(0), tail(0), coalescable(coalescable_mask),
+    posted(0), coalesced(0), overflows(0), maxDepth(0) {}
+
+bool EventQueue::post(uint8_t event, int16_t stepNo, uint32_t time) {
+    uint32_t t = tail, depth = t - head;
+    if (depth > 0 && (coalescable & (1UL << event))) {
+        // the newest pending event stays pending as fetch() never runs meanwhile
+        event_t& newest = ring[(t - 1) % EVQ_SIZE];
+        if (newest.event == event && newest.stepNo == stepNo) {
+            coalesced = coalesced + 1;
+            return false;
+        }
+    }
+    if (depth >= EVQ_SIZE) {
+        overflows = overflows + 1;
+        return false;
+    }
+    event_t& e = ring[t % EVQ_SIZE];
+    e.time = time;
+    e.stepNo = stepNo;
+    e.event = event;
+    _compiler_barrier();
+    tail = t + 1;   // publish
+    posted = posted + 1;
+    if (depth + 1 > maxDepth) maxDepth = depth + 1;
+    return true;
+}
+
+bool EventQueue::fetch(event_t& e) {
+    uint32_t h = head;
+    if (h == tail) return false;
+    e = ring[h % EVQ_SIZE];
+    _compiler_barrier();
+    head = h + 1;   // release the slot
+    return true;
+}
+
+uint32_t EventQueue::getPosted() {
+    return posted;
+}
+
+uint32_t EventQueue::getCoalesced() {
+    return coalesced;
+}
+
+uint32_t EventQueue::getOverflows() {
+    return overflows;
+}
+
+uint32_t EventQueue::getMaxDepth() {
+    return maxDepth;
+}
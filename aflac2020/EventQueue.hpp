@@ -0,0 +1,46 @@
+//
+//  EventQueue.hpp
+//  aflac2020
+//
+//  Copyright © 2020 Ahiruchan Koubou. All rights reserved.
+//
+
+#ifndef EventQueue_hpp
+#define EventQueue_hpp
+
+#include <stdint.h>
+
+#define EVQ_SIZE    16  // capacity of EventQueue; a power of two
+
+// an event posted to StateMachine
+typedef struct {
+    uint32_t time;      // when posted in microsecond
+    int16_t  stepNo;    // g_challenge_stepNo when posted
+    uint8_t  event;     // EVT_xxx
+} event_t;
+
+// bounded lock-free queue of events from Observer and Navigator to StateMachine
+//   post() has to be called from tasks of the same priority, which never preempt each other,
+//   and fetch() from a single task of lower priority, e.g., SM_TSK;
+//   thus no lock is necessary as post() is never preempted by fetch().
+//   Posting the event equal to the newest pending one is coalesced
+//   when the event is in the coalescable mask, e.g., repeated sensor edges.
+//   Posting to the full queue drops the event and counts an overflow.
+class EventQueue {
+private:
+    event_t ring[EVQ_SIZE];
+    volatile uint32_t head, tail;   // fetch from head, post to tail
+    uint32_t coalescable;           // bit mask of EVT_xxx
+    volatile uint32_t posted, coalesced, overflows, maxDepth;
+protected:
+public:
+    EventQueue(uint32_t coalescable_mask);
+    bool post(uint8_t event, int16_t stepNo, uint32_t time); // false when coalesced or dropped
+    bool fetch(event_t& e);                                  // false when empty
+    uint32_t getPosted();
+    uint32_t getCoalesced();
+    uint32_t getOverflows();
+    uint32_t getMaxDepth();
+};
+
+#endif /* EventQueue_hpp */
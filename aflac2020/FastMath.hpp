@@ -0,0 +1,95 @@
+//
+//  FastMath.hpp
+//  aflac2020
+//
+//  table-driven trigonometry for the soft-float target
+//
+//  Copyright © 2020 Ahiruchan Koubou. All rights reserved.
+//
+#ifndef FastMath_hpp
+#define FastMath_hpp
+
+#include <stdint.h>
+/* M_PI is NOT available even with math header file under -std=c++11
+   this program is compiled under -std=gnu++11 option */
+#include <math.h>
+
+/*
+    Accuracy is given by the number of table entries per turn, i.e., 2^FM_TABLE_BITS.
+    Linear interpolation between entries bounds the error to (2*pi / 2^FM_TABLE_BITS)^2 / 8:
+      FM_TABLE_BITS =  8 :  7.5e-05 (1 KB for float, 0.5 KB for fixed-point)
+      FM_TABLE_BITS =  9 :  1.9e-05 (2 KB for float, 1 KB for fixed-point)
+      FM_TABLE_BITS = 10 :  4.7e-06 (4 KB for float, 2 KB for fixed-point)
+    The tables are filled by fm_init() before main_task(), see FastMath.cpp.
+*/
+#ifndef FM_TABLE_BITS
+#define FM_TABLE_BITS   9
+#endif
+#define FM_TABLE_SIZE   (1 << FM_TABLE_BITS)
+#define FM_TABLE_MASK   (FM_TABLE_SIZE - 1)
+
+/* fixed-point angle in BAM (binary angular measurement), 65536 per turn,
+   and fixed-point sine/cosine in Q14, i.e., 16384 for 1.0 */
+#define FM_BAM_TURN     65536
+#define FM_Q14_ONE      16384
+
+extern float   fm_sin_table[FM_TABLE_SIZE + 1];
+extern int16_t fm_sin_table_q14[FM_TABLE_SIZE + 1];
+void fm_init();
+
+/* sine and cosine of rad in float; accurate within a few turns from zero */
+inline void fm_sincos(float rad, float& s, float& c) {
+    float idx = rad * (float)(FM_TABLE_SIZE / (2.0 * M_PI));
+    int32_t i = (int32_t)idx;
+    if (idx < (float)i) i--; /* floor toward negative */
+    float frac = idx - (float)i;
+    uint32_t ks = (uint32_t)i & FM_TABLE_MASK;
+    uint32_t kc = (ks + FM_TABLE_SIZE / 4) & FM_TABLE_MASK;
+    s = fm_sin_table[ks] + frac * (fm_sin_table[ks + 1] - fm_sin_table[ks]);
+    c = fm_sin_table[kc] + frac * (fm_sin_table[kc + 1] - fm_sin_table[kc]);
+}
+
+inline float fm_sin(float rad) {
+    float s, c;
+    fm_sincos(rad, s, c);
+    return s;
+}
+
+inline float fm_cos(float rad) {
+    float s, c;
+    fm_sincos(rad, s, c);
+    return c;
+}
+
+/* sine and cosine of bam in Q14, free of floating point operations;
+   quantization of BAM and Q14 adds up to 2e-4 to the error */
+inline void fm_sincos_q14(uint16_t bam, int16_t& s, int16_t& c) {
+    const int SHIFT = 16 - FM_TABLE_BITS;
+    uint32_t ks = bam >> SHIFT;
+    uint32_t kc = (ks + FM_TABLE_SIZE / 4) & FM_TABLE_MASK;
+    int32_t frac = bam & ((1 << SHIFT) - 1);
+    s = fm_sin_table_q14[ks] + (((fm_sin_table_q14[ks + 1] - fm_sin_table_q14[ks]) * frac) >> SHIFT);
+    c = fm_sin_table_q14[kc] + (((fm_sin_table_q14[kc + 1] - fm_sin_table_q14[kc]) * frac) >> SHIFT);
+}
+
+/* radian to BAM, wrapping into one turn */
+inline uint16_t fm_rad_to_bam(float rad) {
+    return (uint16_t)(int32_t)(rad * (float)(FM_BAM_TURN / (2.0 * M_PI)));
+}
+
+/* arc tangent of y/x in radian within [-pi, pi] by a minimax polynomial,
+   absolute error less than 2e-6 */
+inline float fm_atan2(float y, float x) {
+    float ax = fabsf(x), ay = fabsf(y);
+    if (ax == 0.0F && ay == 0.0F) return 0.0F;
+    bool swap = (ay > ax);
+    float z = swap ? ax / ay : ay / ax;
+    float z2 = z * z;
+    float a = z * (0.99997726F + z2 * (-0.33262347F + z2 * (0.19354346F
+            + z2 * (-0.11643287F + z2 * (0.05265332F + z2 * (-0.01172120F))))));
+    if (swap) a = (float)(M_PI / 2.0) - a;
+    if (x < 0.0F) a = (float)M_PI - a;
+    return (y < 0.0F) ? -a : a;
+}
+
+#endif /* FastMath_hpp */
@@ -8,6 +8,7 @@
 #include "app.h"
 #include "Observer.hpp"
 #include "StateMachine.hpp"
+#include "FastMath.hpp"
 
 //DataLogger angLLogger("angL",10);
 //DataLogger angRLogger("angR",10);
@@ -176,7 +177,7 @@ void Observer::operate() {
     prevAngL = curAngL;
     prevAngR = curAngR;
     // calculate azimuth
-    double deltaAzi = atan2((deltaDistL - deltaDistR), WHEEL_TREAD);
+    double deltaAzi = fm_atan2((deltaDistL - deltaDistR), WHEEL_TREAD);
     azimuth += deltaAzi;
     if (azimuth > M_2PI) {
         azimuth -= M_2PI;
@@ -184,8 +185,10 @@ void Observer::operate() {
         azimuth += M_2PI;
     }
     // estimate location
-    locX += (deltaDist * sin(azimuth));
-    locY += (deltaDist * cos(azimuth));
+    float sinAzi, cosAzi;
+    fm_sincos(azimuth, sinAzi, cosAzi);
+    locX += (deltaDist * sinAzi);
+    locY += (deltaDist * cosAzi);
 
 // modify start by Furuta 2020.09.23
     // monitor good timing to swith to BlindRunner
@@ -26,6 +26,7 @@ void StateMachine::initialize() {
     tailMotor   = new Motor(PORT_D);
     armMotor   = new Motor(PORT_A);
     steering    = new Steering(*leftMotor, *rightMotor);
+    eventQueue  = new EventQueue(EVT_COALESCABLE);
     
     /* LCD画面表示 */
     //ev3_lcd_fill_rect(0, 0, EV3_LCD_WIDTH, EV3_LCD_HEIGHT, EV3_LCD_WHITE);
@@ -44,8 +45,25 @@ void StateMachine::initialize() {
     state = ST_start;
 }
 
+// post the event to be dispatched by SM_TSK, which never stalls the caller
 void StateMachine::sendTrigger(uint8_t event) {
-    syslog(LOG_NOTICE, "%08u, StateMachine::sendTrigger(): event %s received by state %s", clock->now(), eventName[event], stateName[state]);
+    if (eventQueue->post(event, g_challenge_stepNo, clock->now())) {
+        ER ercd = act_tsk(SM_TSK); // E_QOVR when SM_TSK is already activated to drain again
+        assert(ercd == E_OK || ercd == E_QOVR);
+    }
+}
+
+// dispatch the pending events in SM_TSK
+void StateMachine::drain() {
+    event_t e;
+    while (eventQueue->fetch(e)) {
+        dispatch(e);
+    }
+}
+
+void StateMachine::dispatch(event_t& e) {
+    uint8_t event = e.event;
+    syslog(LOG_NOTICE, "%08u, StateMachine::dispatch(): event %s posted at %08u received by state %s", clock->now(), eventName[event], e.time, stateName[state]);
     switch (state) {
         case ST_start:
             switch (event) {
@@ -158,10 +176,10 @@ void StateMachine::sendTrigger(uint8_t event) {
         case ST_slalom:
             switch (event) {
                 case EVT_slalom_reached:
-                    challengeRunner->runChallenge();
+                    challengeRunner->runChallenge(e.stepNo);
                     break;
                 case EVT_slalom_challenge:
-                    challengeRunner->runChallenge();
+                    challengeRunner->runChallenge(e.stepNo);
                     break;
                 case EVT_line_on_pid_cntl: //hinutest
                     lineTracer->haveControl();
@@ -170,7 +188,7 @@ void StateMachine::sendTrigger(uint8_t event) {
                     break;
                 case EVT_block_area_in: //hinutest
                     challengeRunner->haveControl();
-                    challengeRunner->runChallenge();
+                    challengeRunner->runChallenge(e.stepNo);
                     break;
                 default:
                     break;
@@ -179,7 +197,7 @@ void StateMachine::sendTrigger(uint8_t event) {
         case ST_block:
             switch (event) {
                 case EVT_block_challenge:
-                    challengeRunner->runChallenge();
+                    challengeRunner->runChallenge(e.stepNo);
                     break;
                 case EVT_line_on_p_cntl:
                     lineTracer->haveControl();
@@ -193,7 +211,7 @@ void StateMachine::sendTrigger(uint8_t event) {
                     break;
                 case EVT_block_area_in:
                     challengeRunner->haveControl();
-                    challengeRunner->runChallenge();
+                    challengeRunner->runChallenge(e.stepNo);
                     break;
                 default:
                     break;
@@ -211,6 +229,8 @@ void StateMachine::wakeupMain() {
 }
 
 void StateMachine::exit() {
+    syslog(LOG_NOTICE, "%08u, events: %u posted, %u coalesced, %u overflows, max depth %u", clock->now(),
+        eventQueue->getPosted(), eventQueue->getCoalesced(), eventQueue->getOverflows(), eventQueue->getMaxDepth());
     if (activeNavigator != NULL) {
         activeNavigator->deactivate();
     }
@@ -231,6 +251,7 @@ void StateMachine::exit() {
     delete colorSensor;
     delete sonarSensor;
     delete touchSensor;
+    delete eventQueue;
 }
 
 StateMachine::~StateMachine() {
@@ -11,6 +11,7 @@
 #include "aflac_common.hpp"
 #include "BlindRunner.hpp"
 #include "ChallengeRunner.hpp"
+#include "EventQueue.hpp"
 
 /* LCDフォントサイズ */
 #define CALIB_FONT (EV3_FONT_SMALL)
@@ -31,11 +32,14 @@ private:
     LineTracer*     lineTracer;
     BlindRunner*    blindRunner;
     ChallengeRunner*    challengeRunner;
+    EventQueue*     eventQueue;
+    void dispatch(event_t& e);
 protected:
 public:
     StateMachine();
     void initialize();
-    void sendTrigger(uint8_t event);
+    void sendTrigger(uint8_t event);    // post the event; the state machine runs in SM_TSK
+    void drain();                       // method to invoke from SM_TSK
     void wakeupMain();
     void exit();
     ~StateMachine();
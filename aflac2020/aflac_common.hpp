@@ -139,6 +139,13 @@ const char stateName[][ST_NAME_LEN] = {
 #define EVT_distance_over   23
 #define EVT_NAME_LEN        24  // maximum number of characters for an event name
 
+// sensor edges whose duplicates pending in EventQueue are coalesced
+#define EVT_BIT(evt)        (1UL << (evt))
+#define EVT_COALESCABLE     (EVT_BIT(EVT_touch_On) | EVT_BIT(EVT_touch_Off) | EVT_BIT(EVT_sonar_On) | \
+                             EVT_BIT(EVT_sonar_Off) | EVT_BIT(EVT_backButton_On) | EVT_BIT(EVT_backButton_Off) | \
+                             EVT_BIT(EVT_bk2bl) | EVT_BIT(EVT_bl2bk) | EVT_BIT(EVT_line_lost) | \
+                             EVT_BIT(EVT_line_found) | EVT_BIT(EVT_tilt))
+
 const char eventName[][EVT_NAME_LEN] = {
     "EVT_cmdStart_L",
     "EVT_cmdStart_R",
@@ -39,6 +39,11 @@ void navigator_task(intptr_t unused) {
     if (activeNavigator != NULL) activeNavigator->operate();
 }
 
+// StateMachine's task activated by sendTrigger()
+void statemachine_task(intptr_t unused) {
+    if (stateMachine != NULL) stateMachine->drain();
+}
+
 void main_task(intptr_t unused) {
     clock    = new Clock;
     stateMachine  = new StateMachine;
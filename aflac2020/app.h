@@ -24,7 +24,8 @@ extern "C" {
  */
 #define PRIORITY_OBS_TSK    TMIN_APP_TPRI
 #define PRIORITY_NAV_TSK    TMIN_APP_TPRI
-#define PRIORITY_MAIN_TASK  (TMIN_APP_TPRI + 1)
+#define PRIORITY_SM_TSK     (TMIN_APP_TPRI + 1)  // lower than the posters to EventQueue
+#define PRIORITY_MAIN_TASK  (TMIN_APP_TPRI + 2)
 
 /**
  * Task periods in micro seconds
@@ -49,6 +50,7 @@ extern "C" {
 extern void main_task(intptr_t unused);
 extern void observer_task(intptr_t unused);
 extern void navigator_task(intptr_t unused);
+extern void statemachine_task(intptr_t unused);
 
 extern void task_activator(intptr_t tskid);
 
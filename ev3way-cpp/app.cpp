@@ -44,6 +44,8 @@ static FILE     *bt = NULL;      /* Bluetoothファイルハンドル */
 //#define DEVICE_NAME     "ET0"  /* Bluetooth名 hrp2/target/ev3.h BLUETOOTH_LOCAL_NAMEで設定 */
 //#define PASS_KEY        "1234" /* パスキー    hrp2/target/ev3.h BLUETOOTH_PIN_CODEで設定 */
 #define CMD_START         '1'    /* リモートスタートコマンド */
+#define CLOCK_PER_SEC      1000  /* Clock::now()の1秒あたりの値 */
+#define BALANCE_DT_MAX   0.020F  /* 倒立振子制御の周期として扱う最大の経過時間[秒] */
 
 /* LCDフォントサイズ */
 #define CALIB_FONT (EV3_FONT_SMALL)
@@ -65,6 +67,11 @@ Motor*          rightMotor;
 Motor*          tailMotor;
 Clock*          clock;
 
+/* 倒立振子制御の状態量とパラメーター */
+static balancer_state_t balancer;
+static balancer_param_t balancer_param;
+static uint32_t         prev_time;
+
 /* メインタスク */
 void main_task(intptr_t unused)
 {
@@ -122,7 +129,8 @@ void main_task(intptr_t unused)
     
     /* ジャイロセンサーリセット */
     gyroSensor->reset();
-    balance_init(); /* 倒立振子API初期化 */
+    balance_init_r(&balancer); /* 倒立振子API初期化 */
+    prev_time = clock->now();
 
     ev3_led_set_color(LED_GREEN); /* スタート通知 */
 
@@ -133,6 +141,8 @@ void main_task(intptr_t unused)
     {
         int32_t motor_ang_l, motor_ang_r;
         int32_t gyro, volt;
+        uint32_t now;
+        float dt;
 
         if (ev3_button_is_pressed(BACK_BUTTON)) break;
 
@@ -163,10 +173,25 @@ void main_task(intptr_t unused)
 
         /* バックラッシュキャンセル */
         backlash_cancel(pwm_L, pwm_R, &motor_ang_l, &motor_ang_r);
+
+        /* 前回の呼び出しからの経過時間[秒] */
+        now = clock->now();
+        dt = (now - prev_time) / (float)CLOCK_PER_SEC;
+        prev_time = now;
+        if (dt <= 0.0F || dt > BALANCE_DT_MAX)
+        {
+            dt = EXEC_PERIOD; /* 計測できない場合は既定の周期とする */
+        }
         
+        /* balancer_param.cのK_F等を実行中に書き換えても効くように毎回読み込む */
+        balance_param_default(&balancer_param);
+
         /* 倒立振子制御APIを呼び出し、倒立走行するための */
         /* 左右モータ出力値を得る */
-        balance_control(
+        balance_control_dt(
+            &balancer,
+            &balancer_param,
+            dt,
             (float)forward,
             (float)turn,
             (float)gyro,
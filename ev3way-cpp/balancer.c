@@ -53,6 +53,7 @@
  ** All rights reserved.
  ******************************************************************************
  **/
+#include <math.h>
 #include "balancer.h"
 #include "balancer_private.h"
 
@@ -64,11 +65,7 @@
 /*============================================================================
  * Data definitions
  *===========================================================================*/
-static float ud_err_theta;          /* 左右車輪の平均回転角度(θ)目標誤差状態値 */
-static float ud_psi;                /* 車体ピッチ角度(ψ)状態値 */
-static float ud_theta_lpf;          /* 左右車輪の平均回転角度(θ)状態値 */
-static float ud_theta_ref;          /* 左右車輪の目標平均回転角度(θ)状態値 */
-static float ud_thetadot_cmd_lpf;   /* 左右車輪の目標平均回転角速度(dθ/dt)状態値 */
+static balancer_state_t ud;         /* balance_init()/balance_control()用状態量 */
 
 /*============================================================================
  * Functions
@@ -175,6 +172,44 @@ void balance_control(float args_cmd_forward, float args_cmd_turn, float
                      args_theta_m_l, float args_theta_m_r, float
                      args_battery, signed char *ret_pwm_l, signed char *ret_pwm_r)
 {
+  /* the parameters are read every step as they may be changed at run time */
+  balancer_param_t param;
+
+  balance_param_default(&param);
+  balance_control_r(&ud, &param, args_cmd_forward, args_cmd_turn, args_gyro,
+                    args_gyro_offset, args_theta_m_l, args_theta_m_r,
+                    args_battery, ret_pwm_l, ret_pwm_r);
+}
+
+/* Reentrant model step function */
+void balance_control_r(balancer_state_t *state, const balancer_param_t *param,
+                       float args_cmd_forward, float args_cmd_turn, float
+                       args_gyro, float args_gyro_offset, float
+                       args_theta_m_l, float args_theta_m_r, float
+                       args_battery, signed char *ret_pwm_l, signed char *ret_pwm_r)
+{
+  balance_control_dt(state, param, EXEC_PERIOD, args_cmd_forward, args_cmd_turn,
+                     args_gyro, args_gyro_offset, args_theta_m_l, args_theta_m_r,
+                     args_battery, ret_pwm_l, ret_pwm_r);
+}
+
+/* Reentrant model step function with the elapsed time since the last step
+   the integrators and the derivative take args_dt, and the coefficients of the low-pass filters,
+   given for EXEC_PERIOD, are converted to keep the same time constants */
+void balance_control_dt(balancer_state_t *state, const balancer_param_t *param,
+                        float args_dt, float args_cmd_forward, float args_cmd_turn, float
+                        args_gyro, float args_gyro_offset, float
+                        args_theta_m_l, float args_theta_m_r, float
+                        args_battery, signed char *ret_pwm_l, signed char *ret_pwm_r)
+{
+  float a_d = param->a_d;
+  float a_r = param->a_r;
+
+  if (args_dt != EXEC_PERIOD) {
+    a_d = powf(a_d, args_dt / EXEC_PERIOD);
+    a_r = powf(a_r, args_dt / EXEC_PERIOD);
+  }
+
   {
     float tmp_theta;
     float tmp_theta_lpf;
@@ -199,8 +234,8 @@ void balance_control(float args_cmd_forward, float args_cmd_turn, float
      *  Sum: '<S8>/Sum1'
      *  UnitDelay: '<S8>/Unit Delay'
      */
-    tmp_thetadot_cmd_lpf = (((args_cmd_forward / CMD_MAX) * K_THETADOT) * (1.0F
-      - A_R)) + (A_R * ud_thetadot_cmd_lpf);
+    tmp_thetadot_cmd_lpf = (((args_cmd_forward / CMD_MAX) * param->k_thetadot) * (1.0F
+      - a_r)) + (a_r * state->thetadot_cmd_lpf);
 
     /* Gain: '<S4>/Gain' incorporates:
      *  Gain: '<S4>/deg2rad'
@@ -212,8 +247,8 @@ void balance_control(float args_cmd_forward, float args_cmd_turn, float
      *  Sum: '<S4>/Sum6'
      *  UnitDelay: '<S10>/Unit Delay'
      */
-    tmp_theta = (((DEG2RAD * args_theta_m_l) + ud_psi) + ((DEG2RAD *
-      args_theta_m_r) + ud_psi)) * 0.5F;
+    tmp_theta = (((DEG2RAD * args_theta_m_l) + state->psi) + ((DEG2RAD *
+      args_theta_m_r) + state->psi)) * 0.5F;
 
     /* Sum: '<S11>/Sum' incorporates:
      *  Constant: '<S11>/Constant'
@@ -223,7 +258,7 @@ void balance_control(float args_cmd_forward, float args_cmd_turn, float
      *  Sum: '<S11>/Sum1'
      *  UnitDelay: '<S11>/Unit Delay'
      */
-    tmp_theta_lpf = ((1.0F - A_D) * tmp_theta) + (A_D * ud_theta_lpf);
+    tmp_theta_lpf = ((1.0F - a_d) * tmp_theta) + (a_d * state->theta_lpf);
 
     /* Gain: '<S4>/deg2rad2' incorporates:
      *  Inport: '<Root>/gyro'
@@ -252,20 +287,20 @@ void balance_control(float args_cmd_forward, float args_cmd_turn, float
      *  UnitDelay: '<S5>/Unit Delay'
      *  UnitDelay: '<S7>/Unit Delay'
      */
-    tmp[0] = ud_theta_ref;
+    tmp[0] = state->theta_ref;
     tmp[1] = 0.0F;
     tmp[2] = tmp_thetadot_cmd_lpf;
     tmp[3] = 0.0F;
     tmp_theta_0[0] = tmp_theta;
-    tmp_theta_0[1] = ud_psi;
-    tmp_theta_0[2] = (tmp_theta_lpf - ud_theta_lpf) / EXEC_PERIOD;
+    tmp_theta_0[1] = state->psi;
+    tmp_theta_0[2] = (tmp_theta_lpf - state->theta_lpf) / args_dt;
     tmp_theta_0[3] = tmp_psidot;
     tmp_pwm_r_limiter = 0.0F;
     for (tmp_0 = 0; tmp_0 < 4; tmp_0++) {
-      tmp_pwm_r_limiter += (tmp[tmp_0] - tmp_theta_0[tmp_0]) * K_F[(tmp_0)];
+      tmp_pwm_r_limiter += (tmp[tmp_0] - tmp_theta_0[tmp_0]) * param->k_f[(tmp_0)];
     }
 
-    tmp_pwm_r_limiter = (((K_I * ud_err_theta) + tmp_pwm_r_limiter) /
+    tmp_pwm_r_limiter = (((param->k_i * state->err_theta) + tmp_pwm_r_limiter) /
                          ((BATTERY_GAIN * args_battery) - BATTERY_OFFSET)) *
       100.0F;
 
@@ -274,7 +309,7 @@ void balance_control(float args_cmd_forward, float args_cmd_turn, float
      *  Inport: '<Root>/cmd_turn'
      *  Product: '<S3>/Divide1'
      */
-    tmp_pwm_turn = (args_cmd_turn / CMD_MAX) * K_PHIDOT;
+    tmp_pwm_turn = (args_cmd_turn / CMD_MAX) * param->k_phidot;
 
     /* Sum: '<S2>/Sum' */
     tmp_pwm_l_limiter = tmp_pwm_r_limiter + tmp_pwm_turn;
@@ -302,13 +337,13 @@ void balance_control(float args_cmd_forward, float args_cmd_turn, float
      *  Gain: '<S7>/Gain'
      *  UnitDelay: '<S7>/Unit Delay'
      */
-    tmp_pwm_l_limiter = (EXEC_PERIOD * tmp_thetadot_cmd_lpf) + ud_theta_ref;
+    tmp_pwm_l_limiter = (args_dt * tmp_thetadot_cmd_lpf) + state->theta_ref;
 
     /* Sum: '<S10>/Sum' incorporates:
      *  Gain: '<S10>/Gain'
      *  UnitDelay: '<S10>/Unit Delay'
      */
-    tmp_pwm_turn = (EXEC_PERIOD * tmp_psidot) + ud_psi;
+    tmp_pwm_turn = (args_dt * tmp_psidot) + state->psi;
 
     /* Sum: '<S5>/Sum' incorporates:
      *  Gain: '<S5>/Gain'
@@ -316,43 +351,139 @@ void balance_control(float args_cmd_forward, float args_cmd_turn, float
      *  UnitDelay: '<S5>/Unit Delay'
      *  UnitDelay: '<S7>/Unit Delay'
      */
-    tmp_pwm_r_limiter = ((ud_theta_ref - tmp_theta) * EXEC_PERIOD) +
-      ud_err_theta;
+    tmp_pwm_r_limiter = ((state->theta_ref - tmp_theta) * args_dt) +
+      state->err_theta;
 
     /* user code (Update function Body) */
     /* System '<Root>' */
     /* 次回演算用状態量保存処理 */
 
     /* Update for UnitDelay: '<S5>/Unit Delay' */
-    ud_err_theta = tmp_pwm_r_limiter;
+    state->err_theta = tmp_pwm_r_limiter;
 
     /* Update for UnitDelay: '<S7>/Unit Delay' */
-    ud_theta_ref = tmp_pwm_l_limiter;
+    state->theta_ref = tmp_pwm_l_limiter;
 
     /* Update for UnitDelay: '<S8>/Unit Delay' */
-    ud_thetadot_cmd_lpf = tmp_thetadot_cmd_lpf;
+    state->thetadot_cmd_lpf = tmp_thetadot_cmd_lpf;
 
     /* Update for UnitDelay: '<S10>/Unit Delay' */
-    ud_psi = tmp_pwm_turn;
+    state->psi = tmp_pwm_turn;
 
     /* Update for UnitDelay: '<S11>/Unit Delay' */
-    ud_theta_lpf = tmp_theta_lpf;
+    state->theta_lpf = tmp_theta_lpf;
   }
 }
 
 /* Model initialize function */
 void balance_init(void)
+{
+  balance_init_r(&ud);
+}
+
+/* Reentrant model initialize function */
+void balance_init_r(balancer_state_t *state)
 {
   /* Registration code */
 
   /* states (dwork) */
 
   /* custom states */
-  ud_err_theta = 0.0F;
-  ud_theta_ref = 0.0F;
-  ud_thetadot_cmd_lpf = 0.0F;
-  ud_psi = 0.0F;
-  ud_theta_lpf = 0.0F;
+  state->err_theta = 0.0F;
+  state->theta_ref = 0.0F;
+  state->thetadot_cmd_lpf = 0.0F;
+  state->psi = 0.0F;
+  state->theta_lpf = 0.0F;
+}
+
+/* Parameters of balancer_param.c */
+void balance_param_default(balancer_param_t *param)
+{
+  param->a_d = A_D;
+  param->a_r = A_R;
+  param->k_f[0] = K_F[0];
+  param->k_f[1] = K_F[1];
+  param->k_f[2] = K_F[2];
+  param->k_f[3] = K_F[3];
+  param->k_i = K_I;
+  param->k_phidot = K_PHIDOT;
+  param->k_thetadot = K_THETADOT;
+}
+
+/* Batched model initialize function */
+void balance_init_batch(int n, balancer_state_soa_t *state)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    state->err_theta[i] = 0.0F;
+    state->theta_ref[i] = 0.0F;
+    state->thetadot_cmd_lpf[i] = 0.0F;
+    state->psi[i] = 0.0F;
+    state->theta_lpf[i] = 0.0F;
+  }
+}
+
+/* Batched model step function
+   the same computation as balance_control_r() in the same order of operations,
+   with the loop over the feedback gains unrolled */
+void balance_control_batch(int n, balancer_state_soa_t *state,
+  const balancer_param_soa_t *param, const float *args_cmd_forward,
+  const float *args_cmd_turn, const float *args_gyro, const float *args_gyro_offset,
+  const float *args_theta_m_l, const float *args_theta_m_r, const float *args_battery,
+  signed char *ret_pwm_l, signed char *ret_pwm_r)
+{
+  float *ud_err_theta = state->err_theta;
+  float *ud_psi = state->psi;
+  float *ud_theta_lpf = state->theta_lpf;
+  float *ud_theta_ref = state->theta_ref;
+  float *ud_thetadot_cmd_lpf = state->thetadot_cmd_lpf;
+  const float *a_d = param->a_d;
+  const float *a_r = param->a_r;
+  const float *k_f0 = param->k_f0;
+  const float *k_f1 = param->k_f1;
+  const float *k_f2 = param->k_f2;
+  const float *k_f3 = param->k_f3;
+  const float *k_i = param->k_i;
+  const float *k_phidot = param->k_phidot;
+  const float *k_thetadot = param->k_thetadot;
+  int i;
+
+#pragma GCC ivdep
+  for (i = 0; i < n; i++) {
+    float tmp_thetadot_cmd_lpf = (((args_cmd_forward[i] / CMD_MAX) * k_thetadot[i]) *
+      (1.0F - a_r[i])) + (a_r[i] * ud_thetadot_cmd_lpf[i]);
+    float tmp_theta = (((DEG2RAD * args_theta_m_l[i]) + ud_psi[i]) + ((DEG2RAD *
+      args_theta_m_r[i]) + ud_psi[i])) * 0.5F;
+    float tmp_theta_lpf = ((1.0F - a_d[i]) * tmp_theta) + (a_d[i] * ud_theta_lpf[i]);
+    float tmp_psidot = (args_gyro[i] - args_gyro_offset[i]) * DEG2RAD;
+    float tmp_pwm_r_limiter = 0.0F;
+    float tmp_pwm_l_limiter;
+    float tmp_pwm_turn;
+
+    tmp_pwm_r_limiter += (ud_theta_ref[i] - tmp_theta) * k_f0[i];
+    tmp_pwm_r_limiter += (0.0F - ud_psi[i]) * k_f1[i];
+    tmp_pwm_r_limiter += (tmp_thetadot_cmd_lpf - ((tmp_theta_lpf - ud_theta_lpf[i]) /
+      EXEC_PERIOD)) * k_f2[i];
+    tmp_pwm_r_limiter += (0.0F - tmp_psidot) * k_f3[i];
+    tmp_pwm_r_limiter = (((k_i[i] * ud_err_theta[i]) + tmp_pwm_r_limiter) /
+                         ((BATTERY_GAIN * args_battery[i]) - BATTERY_OFFSET)) * 100.0F;
+
+    tmp_pwm_turn = (args_cmd_turn[i] / CMD_MAX) * k_phidot[i];
+    tmp_pwm_l_limiter = tmp_pwm_r_limiter + tmp_pwm_turn;
+    tmp_pwm_l_limiter = rt_SATURATE(tmp_pwm_l_limiter, -100.0F, 100.0F);
+    ret_pwm_l[i] = (signed char)tmp_pwm_l_limiter;
+    tmp_pwm_r_limiter -= tmp_pwm_turn;
+    tmp_pwm_r_limiter = rt_SATURATE(tmp_pwm_r_limiter, -100.0F, 100.0F);
+    ret_pwm_r[i] = (signed char)tmp_pwm_r_limiter;
+
+    /* 次回演算用状態量保存処理 */
+    ud_err_theta[i] = ((ud_theta_ref[i] - tmp_theta) * EXEC_PERIOD) + ud_err_theta[i];
+    ud_theta_ref[i] = (EXEC_PERIOD * tmp_thetadot_cmd_lpf) + ud_theta_ref[i];
+    ud_thetadot_cmd_lpf[i] = tmp_thetadot_cmd_lpf;
+    ud_psi[i] = (EXEC_PERIOD * tmp_psidot) + ud_psi[i];
+    ud_theta_lpf[i] = tmp_theta_lpf;
+  }
 }
 
 /*======================== TOOL VERSION INFORMATION ==========================*
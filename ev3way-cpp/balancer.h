@@ -46,6 +46,72 @@ extern void balance_control(float args_cmd_forward, float args_cmd_turn,
   float args_theta_m_r, float args_battery, signed char *ret_pwm_l, signed char
   *ret_pwm_r);
 
+/* 状態量 (reentrant interface) */
+typedef struct {
+  float err_theta;                     /* 左右車輪の平均回転角度(θ)目標誤差状態値 */
+  float psi;                           /* 車体ピッチ角度(ψ)状態値 */
+  float theta_lpf;                     /* 左右車輪の平均回転角度(θ)状態値 */
+  float theta_ref;                     /* 左右車輪の目標平均回転角度(θ)状態値 */
+  float thetadot_cmd_lpf;              /* 左右車輪の目標平均回転角速度(dθ/dt)状態値 */
+} balancer_state_t;
+
+/* 制御パラメーター (reentrant interface), see balancer_param.c */
+typedef struct {
+  float a_d;
+  float a_r;
+  float k_f[4];
+  float k_i;
+  float k_phidot;
+  float k_thetadot;
+} balancer_param_t;
+
+/* Reentrant versions taking the state and the parameters explicitly;
+   balance_init() and balance_control() work on a single internal state
+   with the parameters of balancer_param.c */
+extern void balance_param_default(balancer_param_t *param);
+extern void balance_init_r(balancer_state_t *state);
+extern void balance_control_r(balancer_state_t *state, const balancer_param_t *param,
+  float args_cmd_forward, float args_cmd_turn, float args_gyro, float args_gyro_offset,
+  float args_theta_m_l, float args_theta_m_r, float args_battery,
+  signed char *ret_pwm_l, signed char *ret_pwm_r);
+/* the same as balance_control_r() but for args_dt seconds since the last step
+   instead of EXEC_PERIOD, e.g., measured by Clock */
+extern void balance_control_dt(balancer_state_t *state, const balancer_param_t *param,
+  float args_dt, float args_cmd_forward, float args_cmd_turn, float args_gyro,
+  float args_gyro_offset, float args_theta_m_l, float args_theta_m_r, float args_battery,
+  signed char *ret_pwm_l, signed char *ret_pwm_r);
+
+/* Structure of arrays of n instances for the batched interface */
+typedef struct {
+  float *err_theta;
+  float *psi;
+  float *theta_lpf;
+  float *theta_ref;
+  float *thetadot_cmd_lpf;
+} balancer_state_soa_t;
+
+typedef struct {
+  float *a_d;
+  float *a_r;
+  float *k_f0;
+  float *k_f1;
+  float *k_f2;
+  float *k_f3;
+  float *k_i;
+  float *k_phidot;
+  float *k_thetadot;
+} balancer_param_soa_t;
+
+/* Batched versions advancing n instances per call, each input and output
+   being an array of n; the arrays must not overlap each other so that
+   the loop is vectorized. The results are identical to balance_control_r(). */
+extern void balance_init_batch(int n, balancer_state_soa_t *state);
+extern void balance_control_batch(int n, balancer_state_soa_t *state,
+  const balancer_param_soa_t *param, const float *args_cmd_forward,
+  const float *args_cmd_turn, const float *args_gyro, const float *args_gyro_offset,
+  const float *args_theta_m_l, const float *args_theta_m_r, const float *args_battery,
+  signed char *ret_pwm_l, signed char *ret_pwm_r);
+
 /*-
  * The generated code includes comments that allow you to trace directly
  * back to the appropriate location in the model.  The basic format
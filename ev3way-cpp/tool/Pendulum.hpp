@@ -0,0 +1,40 @@
+// nonlinear model of NXTway-GS (Yorihisa Yamamoto, 2008) driven straight without turning,
+// with the body parameters noted in balancer_param.c, for the host tools in this directory
+#ifndef Pendulum_hpp
+#define Pendulum_hpp
+
+#include <cmath>
+
+struct Pendulum {
+    double th = 0.0, ps = 0.0, dth = 0.0, dps = 0.0;   // mean wheel angle and body pitch in radian
+
+    // advance period seconds with the pwm given to both motors at battery mV
+    void step(double pwm, double battery, double period) {
+        const double g = 9.81, m = 0.05, R = 0.05, M = 0.79, H = 0.140, L = H / 2.0;
+        const double Jw = m * R * R / 2.0, Jpsi = M * L * L / 3.0;
+        const double Jm = 1.0e-5, Rm = 6.69, Kb = 0.468, Kt = 0.317, fm = 0.0022, fw = 0.0;
+        const double alpha = Kt / Rm, beta = Kt * Kb / Rm + fm;
+        // PWM to voltage as balancer.c assumes with BATTERY_GAIN and BATTERY_OFFSET
+        double v = pwm / 100.0 * (0.001089 * battery - 0.625);
+        int substeps = (int)ceil(period / 0.0005);
+        double dt = period / substeps;
+        for (int s = 0; s < substeps; s++) {
+            double c = cos(ps), sn = sin(ps);
+            double e11 = (2 * m + M) * R * R + 2 * Jw + 2 * Jm, e12 = M * L * R * c - 2 * Jm;
+            double e22 = M * L * L + Jpsi + 2 * Jm;
+            double f1 = 2 * alpha * v - 2 * (beta + fw) * dth + 2 * beta * dps + M * L * R * dps * dps * sn;
+            double f2 = -2 * alpha * v + 2 * beta * dth - 2 * beta * dps + M * g * L * sn;
+            double det = e11 * e22 - e12 * e12;
+            dth += (e22 * f1 - e12 * f2) / det * dt;
+            dps += (e11 * f2 - e12 * f1) / det * dt;
+            th += dth * dt;
+            ps += dps * dt;
+        }
+    }
+    // readings of the gyro sensor in deg/sec and the motor encoder in degree
+    double gyro() const { return (double)lrint(dps * 180.0 / M_PI); }
+    double encoder() const { return (double)lrint((th - ps) * 180.0 / M_PI); }
+    double pitch() const { return ps * 180.0 / M_PI; }
+};
+
+#endif /* Pendulum_hpp */
@@ -0,0 +1,86 @@
+// this tool injects jitter into the period of the balance control on a simulated EV3way
+// and compares balance_control_r(), which assumes EXEC_PERIOD,
+// with balance_control_dt() given the measured period
+//
+// gcc -O2 -c ../balancer.c ../balancer_param.c
+// g++ -std=gnu++11 -O2 balancer_jitter.cpp balancer.o balancer_param.o && ./a.out
+//
+// the robot starts leaning 3 degrees, is commanded forward 30 from 2 to 6 seconds
+// and pushed at 7 seconds, for 10 seconds. the period is measured either exactly
+// or by a Clock of 1 msec resolution as in app.cpp.
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <cmath>
+using namespace std;
+#include "../balancer.h"
+#include "Pendulum.hpp"
+
+#define BATTERY     8000.0  // mV
+#define DURATION    10.0    // seconds
+
+enum Mode { LEGACY, MEASURED, MEASURED_MSEC };
+
+// period generator from lo to hi msec, fixed if lo == hi
+static void run(const char* name, double lo, double hi, Mode mode) {
+    mt19937 rng(1);
+    uniform_real_distribution<double> period(lo, hi);
+    Pendulum body;
+    body.ps = 3.0 * M_PI / 180.0;
+    balancer_state_t st;
+    balancer_param_t pa;
+    balance_param_default(&pa);
+    balance_init_r(&st);
+
+    double t = 0.0, last = 0.0, sum = 0.0, peak = 0.0;
+    int n = 0;
+    bool fallen = false, pushed = false;
+    signed char pwmL, pwmR;
+    while (t < DURATION) {
+        float forward = (t >= 2.0 && t < 6.0) ? 30.0F : 0.0F;
+        if (mode == LEGACY) {
+            balance_control_r(&st, &pa, forward, 0.0F, body.gyro(), 0.0F, body.encoder(), body.encoder(),
+                              BATTERY, &pwmL, &pwmR);
+        } else {
+            /* the first step has no previous one to measure from */
+            double dt = (mode == MEASURED) ? t - last : floor(t * 1000.0) / 1000.0 - floor(last * 1000.0) / 1000.0;
+            if (n == 0) dt = EXEC_PERIOD;
+            balance_control_dt(&st, &pa, (float)dt, forward, 0.0F, body.gyro(), 0.0F, body.encoder(), body.encoder(),
+                               BATTERY, &pwmL, &pwmR);
+        }
+        last = t;
+        double p = (lo == hi) ? lo / 1000.0 : period(rng) / 1000.0;
+        body.step(pwmL, BATTERY, p);
+        t += p;
+        if (!pushed && t >= 7.0) {
+            body.dps += 1.0;    // rad/sec
+            pushed = true;
+        }
+        double psi = body.pitch();
+        if (fabs(psi) > 45.0) {
+            fallen = true;
+            break;
+        }
+        sum += psi * psi;
+        peak = fmax(peak, fabs(psi));
+        n++;
+    }
+    cout << " " << name << ": ";
+    if (fallen) cout << "fell at " << t << " s" << endl;
+    else cout << "rms pitch = " << sqrt(sum / n) << ", peak pitch = " << peak << " deg" << endl;
+}
+
+int main() {
+    struct { const char* name; double lo, hi; } periods[] = {
+        { "3 msec     ", 3.0, 3.0 }, { "4 msec     ", 4.0, 4.0 }, { "5 msec     ", 5.0, 5.0 },
+        { "6 msec     ", 6.0, 6.0 }, { "3 to 6 msec", 3.0, 6.0 },
+    };
+    cout << fixed << setprecision(3);
+    for (auto& p : periods) {
+        cout << "period " << p.name << endl;
+        run("balance_control_r, EXEC_PERIOD         ", p.lo, p.hi, LEGACY);
+        run("balance_control_dt, exact period       ", p.lo, p.hi, MEASURED);
+        run("balance_control_dt, 1 msec Clock       ", p.lo, p.hi, MEASURED_MSEC);
+    }
+    return 0;
+}
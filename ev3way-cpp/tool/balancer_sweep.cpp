@@ -0,0 +1,216 @@
+// this tool sweeps the gains of balancer.c on a simulated EV3way
+// by the batched balancer, advancing BATCH candidates at once on every core
+//
+// gcc -O3 -c ../balancer.c ../balancer_param.c
+// g++ -std=gnu++11 -O3 -pthread balancer_sweep.cpp balancer.o balancer_param.o && ./a.out
+//
+// the plant is Pendulum.hpp.
+// a candidate scales K_F[0], K_F[1], K_F[3] and K_I of balancer_param.c.
+// it starts leaning 3 degrees, is commanded forward 30 from 1 to 3 seconds,
+// and is scored by rms pitch in degree plus 0.01 * rms pwm; falling over 45 degrees disqualifies.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+using namespace std;
+#include "../balancer.h"
+extern "C" {
+#include "../balancer_private.h"
+}
+#include "Pendulum.hpp"
+
+#define BATCH       256
+#define STEPS       1250    // 5 seconds
+#define PERIOD      0.004   // the main loop of app.cpp sleeps 4 msec
+#define BATTERY     8000.0F // mV
+#define GRID        8       // per scaled gain, GRID^4 candidates
+
+// plant states and the scores of a batch in structure of arrays
+struct Batch {
+    vector<float> err_theta, psi, theta_lpf, theta_ref, thetadot_cmd_lpf;
+    vector<float> a_d, a_r, k_f0, k_f1, k_f2, k_f3, k_i, k_phidot, k_thetadot;
+    vector<float> forward, turn, gyro, offset, angL, angR, battery;
+    vector<signed char> pwmL, pwmR;
+    vector<Pendulum> body;
+    vector<double> sumPsi, sumPwm;
+    vector<char> fallen;
+    Batch() {
+        for (auto v : { &err_theta, &psi, &theta_lpf, &theta_ref, &thetadot_cmd_lpf, &a_d, &a_r, &k_f0, &k_f1,
+                        &k_f2, &k_f3, &k_i, &k_phidot, &k_thetadot, &forward, &turn, &gyro, &offset, &angL, &angR, &battery })
+            v->resize(BATCH);
+        for (auto v : { &sumPsi, &sumPwm }) v->resize(BATCH);
+        body.resize(BATCH);
+        pwmL.resize(BATCH);
+        pwmR.resize(BATCH);
+        fallen.resize(BATCH);
+    }
+};
+
+static void candidate(int c, float& k0, float& k1, float& k3, float& ki) {
+    // scales from 0.4 to 1.8 of balancer_param.c for each gain
+    int i0 = c % GRID, i1 = c / GRID % GRID, i3 = c / GRID / GRID % GRID, ii = c / GRID / GRID / GRID;
+    k0 = K_F[0] * (0.4F + 0.2F * i0);
+    k1 = K_F[1] * (0.4F + 0.2F * i1);
+    k3 = K_F[3] * (0.4F + 0.2F * i3);
+    ki = K_I * (0.4F + 0.2F * ii);
+}
+
+static void sense(Batch& b, int i, int k) {
+    b.forward[i] = (k >= 250 && k < 750) ? 30.0F : 0.0F;
+    b.turn[i] = 0.0F;
+    b.gyro[i] = (float)b.body[i].gyro();
+    b.offset[i] = 0.0F;
+    b.angL[i] = b.angR[i] = (float)b.body[i].encoder();
+    b.battery[i] = BATTERY;
+}
+
+static void score(Batch& b, int i) {
+    double psi = b.body[i].pitch();
+    if (fabs(psi) > 45.0) b.fallen[i] = 1;
+    b.sumPsi[i] += psi * psi;
+    b.sumPwm[i] += (double)b.pwmL[i] * b.pwmL[i];
+}
+
+static void reset(Batch& b, int first, int n) {
+    for (int i = 0; i < n; i++) {
+        candidate(first + i, b.k_f0[i], b.k_f1[i], b.k_f3[i], b.k_i[i]);
+        b.a_d[i] = A_D; b.a_r[i] = A_R; b.k_f2[i] = K_F[2];
+        b.k_phidot[i] = K_PHIDOT; b.k_thetadot[i] = K_THETADOT;
+        b.body[i] = Pendulum();
+        b.body[i].ps = 3.0 * M_PI / 180.0;
+        b.sumPsi[i] = b.sumPwm[i] = 0.0;
+        b.fallen[i] = 0;
+    }
+}
+
+// simulate candidates [first, first + n) at once by balance_control_batch()
+static void runBatch(Batch& b, int first, int n, vector<double>& result) {
+    balancer_state_soa_t st = { b.err_theta.data(), b.psi.data(), b.theta_lpf.data(), b.theta_ref.data(), b.thetadot_cmd_lpf.data() };
+    balancer_param_soa_t pa = { b.a_d.data(), b.a_r.data(), b.k_f0.data(), b.k_f1.data(), b.k_f2.data(), b.k_f3.data(),
+                                b.k_i.data(), b.k_phidot.data(), b.k_thetadot.data() };
+    reset(b, first, n);
+    balance_init_batch(n, &st);
+    for (int k = 0; k < STEPS; k++) {
+        for (int i = 0; i < n; i++) sense(b, i, k);
+        balance_control_batch(n, &st, &pa, b.forward.data(), b.turn.data(), b.gyro.data(), b.offset.data(),
+                              b.angL.data(), b.angR.data(), b.battery.data(), b.pwmL.data(), b.pwmR.data());
+        for (int i = 0; i < n; i++) {
+            b.body[i].step(b.pwmL[i], BATTERY, PERIOD);
+            score(b, i);
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        result[first + i] = b.fallen[i] ? HUGE_VAL : sqrt(b.sumPsi[i] / STEPS) + 0.01 * sqrt(b.sumPwm[i] / STEPS);
+    }
+}
+
+// the same as runBatch() one candidate at a time by balance_control_r()
+static void runScalar(Batch& b, int first, int n, vector<double>& result) {
+    reset(b, first, n);
+    for (int i = 0; i < n; i++) {
+        balancer_state_t st;
+        balancer_param_t pa;
+        balance_param_default(&pa);
+        pa.k_f[0] = b.k_f0[i]; pa.k_f[1] = b.k_f1[i]; pa.k_f[3] = b.k_f3[i]; pa.k_i = b.k_i[i];
+        balance_init_r(&st);
+        for (int k = 0; k < STEPS; k++) {
+            sense(b, i, k);
+            balance_control_r(&st, &pa, b.forward[i], b.turn[i], b.gyro[i], b.offset[i],
+                              b.angL[i], b.angR[i], b.battery[i], &b.pwmL[i], &b.pwmR[i]);
+            b.body[i].step(b.pwmL[i], BATTERY, PERIOD);
+            score(b, i);
+        }
+        result[first + i] = b.fallen[i] ? HUGE_VAL : sqrt(b.sumPsi[i] / STEPS) + 0.01 * sqrt(b.sumPwm[i] / STEPS);
+    }
+}
+
+template<class F> static double sweep(int total, int threads, vector<double>& result, F run) {
+    atomic<int> next(0);
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&]() {
+            Batch b;
+            int first;
+            while ((first = next.fetch_add(BATCH)) < total) {
+                run(b, first, min(BATCH, total - first), result);
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+// time of the balancer alone stepping BATCH instances, without the plant
+static void benchmark() {
+    const int reps = 20000;
+    Batch b;
+    reset(b, 0, BATCH);
+    for (int i = 0; i < BATCH; i++) sense(b, i, 500);
+    balancer_state_soa_t st = { b.err_theta.data(), b.psi.data(), b.theta_lpf.data(), b.theta_ref.data(), b.thetadot_cmd_lpf.data() };
+    balancer_param_soa_t pa = { b.a_d.data(), b.a_r.data(), b.k_f0.data(), b.k_f1.data(), b.k_f2.data(), b.k_f3.data(),
+                                b.k_i.data(), b.k_phidot.data(), b.k_thetadot.data() };
+    vector<balancer_state_t> sts(BATCH);
+    vector<balancer_param_t> pas(BATCH);
+    for (int i = 0; i < BATCH; i++) {
+        balance_init_r(&sts[i]);
+        balance_param_default(&pas[i]);
+    }
+    balance_init_batch(BATCH, &st);
+
+    auto t0 = chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) {
+        for (int i = 0; i < BATCH; i++) {
+            balance_control_r(&sts[i], &pas[i], b.forward[i], b.turn[i], b.gyro[i], b.offset[i],
+                              b.angL[i], b.angR[i], b.battery[i], &b.pwmL[i], &b.pwmR[i]);
+        }
+    }
+    auto t1 = chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) {
+        balance_control_batch(BATCH, &st, &pa, b.forward.data(), b.turn.data(), b.gyro.data(), b.offset.data(),
+                              b.angL.data(), b.angR.data(), b.battery.data(), b.pwmL.data(), b.pwmR.data());
+    }
+    auto t2 = chrono::steady_clock::now();
+    double ns = 1.0e9 / ((double)reps * BATCH);
+    cout << "balancer step alone: balance_control_r " << chrono::duration<double>(t1 - t0).count() * ns
+         << " ns, balance_control_batch " << chrono::duration<double>(t2 - t1).count() * ns << " ns per instance" << endl;
+}
+
+int main() {
+    const int total = GRID * GRID * GRID * GRID;
+    benchmark();
+    int threads = max(1u, thread::hardware_concurrency());
+    vector<double> batched(total), scalar(total);
+
+    double tb1 = sweep(total, 1, batched, runBatch);
+    double ts1 = sweep(total, 1, scalar, runScalar);
+    double tbn = sweep(total, threads, batched, runBatch);
+    if (!equal(batched.begin(), batched.end(), scalar.begin())) {
+        cout << "batched and scalar balancers disagree" << endl;
+        return 1;
+    }
+    cout << total << " candidates of " << STEPS * PERIOD << " seconds each" << endl;
+    cout << " scalar,  1 thread : " << ts1 << " s" << endl;
+    cout << " batched, 1 thread : " << tb1 << " s" << endl;
+    cout << " batched, " << threads << " threads: " << tbn << " s, " << total / tbn << " candidates/s" << endl;
+
+    vector<int> order(total);
+    for (int c = 0; c < total; c++) order[c] = c;
+    sort(order.begin(), order.end(), [&](int a, int b) { return batched[a] < batched[b]; });
+    int survived = count_if(batched.begin(), batched.end(), [](double s) { return s != HUGE_VAL; });
+    cout << survived << " candidates kept balance; the best are" << endl;
+    cout << fixed << setprecision(5);
+    for (int r = 0; r < 5 && r < survived; r++) {
+        float k0, k1, k3, ki;
+        candidate(order[r], k0, k1, k3, ki);
+        cout << " K_F[0] = " << k0 << ", K_F[1] = " << k1 << ", K_F[3] = " << k3 << ", K_I = " << ki
+             << ", score = " << batched[order[r]] << endl;
+    }
+    int nominal = 3 + 3 * GRID + 3 * GRID * GRID + 3 * GRID * GRID * GRID;   // all scales 1.0
+    cout << " balancer_param.c as is: score = " << batched[nominal] << endl;
+    return 0;
+}
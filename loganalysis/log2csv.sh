@@ -1,13 +1,8 @@
 #!/bin/sh
-sed -nE '/Observer.*distance.*azimuth/{s/^.*x = ([0-9-]+), y = ([0-9-]+).*$/\1,\2/;p};/Captain default constructor/s/.*/cut/p' | (
-    for num in `seq -w 000 999` ; do
-	while read line ; do
-	    if [ $line = 'cut' ] ; then
-		file=file$num.csv
-		echo "x,y" > $file
-		break
-	    fi
-	    echo $line >> $file
-	done
-    done
-)
+# splits the log from the standard input into file000.csv, file001.csv, ... of the Observer x,y per run,
+# by logparse.cpp built next to this script; see it for the options passed through
+DIR=`dirname $0`
+if [ ! $DIR/logparse -nt $DIR/logparse.cpp ] ; then
+    g++ -std=gnu++11 -O2 -pthread $DIR/logparse.cpp -o $DIR/logparse || exit 1
+fi
+exec $DIR/logparse "$@"
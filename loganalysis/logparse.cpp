@@ -0,0 +1,379 @@
+// this tool parses the logs of the robots and the results of the simulator for hundreds of runs at once,
+// replacing log2csv.sh, which split a log by sed and a loop of read and echo, and lpprt.awk of ms2021
+//
+// g++ -std=gnu++11 -O2 -pthread logparse.cpp -o logparse
+// ./logparse < btlog.txt                                      as log2csv.sh, into file000.csv, file001.csv, ...
+// ./logparse -f Logger::outputLog -c "" -k all -t -o work work/btlog_*.txt
+// ./logparse -j work/lp_*.csv > results.csv                   as awk -f lpprt.awk, -r for lpprtr.awk
+//
+// the logs are mapped into memory and scanned by hand, line by line, for those of _log and _debug,
+//  "%08u, function: name = value; name = value ..." or with ", " between the pairs as Observer::operate().
+// a line containing the marker of -c (default "Captain default constructor" of aflac2019) starts a run,
+// and the lines before the first marker are dropped as log2csv.sh does; with -c "" a file is a run.
+// of the lines whose function contains -f (default Observer::operate), the values of the names of -k
+// (default x,y) make a row of the table of the run, the stamp first with -t, and a line lacking any of
+// them is skipped; -k all takes the names of the first such line of each run.
+// the values are copied as they are, without converting them to numbers and back.
+// a table is written as <prefix><run>.csv into the directory of -o (default .), the prefix of -p being
+// "file" for the standard input and <file>_ for a file.
+// with -j, the files are the results of sim ctl end instead, a row per file of the left course,
+// or the right with -r, the four characters before ".csv" in the name of the file first.
+// the files are dealt to -n threads (default all the cores) and the throughput is reported.
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+#define FLUSH_SIZE  (1 << 20)   // bytes of a table buffered before writing
+
+struct Options {
+    string function, marker, outDir, prefix;
+    vector<string> keys;        // empty for all
+    bool stamp, json, right;
+};
+
+struct Span {
+    const char* p;
+    size_t n;
+    bool operator==(const string& s) const { return n == s.size() && memcmp(p, s.data(), n) == 0; }
+};
+
+// ---- a file mapped into memory, or the standard input read into it ----
+class Input {
+public:
+    Input(const string& path) : data(nullptr), size(0), mapped(false) {
+        if (path == "-") {
+            char buf[65536];
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), stdin)) > 0) copy.append(buf, n);
+            data = copy.data();
+            size = copy.size();
+            return;
+        }
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "cannot read " + path;
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m == MAP_FAILED) {
+                error = "cannot map " + path;
+            } else {
+                madvise(m, st.st_size, MADV_SEQUENTIAL);
+                data = (const char*)m;
+                size = st.st_size;
+                mapped = true;
+            }
+        }
+        close(fd);
+    }
+    ~Input() {
+        if (mapped) munmap((void*)data, size);
+    }
+    const char* data;
+    size_t size;
+    string error;
+protected:
+    bool mapped;
+    string copy;
+};
+
+// ---- the table of a run, written as it grows ----
+class Table {
+public:
+    Table(const string& path) : path(path), fp(nullptr), rows(0) {}
+    ~Table() { close(); }
+    bool open(const string& header) {
+        fp = fopen(path.c_str(), "w");
+        if (fp == nullptr) return false;
+        buf = header;
+        return true;
+    }
+    void append(const char* p, size_t n) { buf.append(p, n); }
+    void endRow() {
+        buf += '\n';
+        rows++;
+        if (buf.size() >= FLUSH_SIZE) flush();
+    }
+    void close() {
+        if (fp == nullptr) return;
+        flush();
+        fclose(fp);
+        fp = nullptr;
+    }
+    unsigned long getRows() const { return rows; }
+protected:
+    string path, buf;
+    FILE* fp;
+    unsigned long rows;
+    void flush() {
+        fwrite(buf.data(), 1, buf.size(), fp);
+        buf.clear();
+    }
+};
+
+// ---- scanning a line of _log ----
+// the stamp and the function, up to ": " or the end of the line; false unless the line starts by a stamp
+static bool scanHead(const char* p, const char* e, Span& stamp, Span& func, const char*& rest) {
+    const char* q = p;
+    while (q < e && *q >= '0' && *q <= '9') q++;
+    if (q == p || q + 2 > e || q[0] != ',' || q[1] != ' ') return false;
+    stamp = { p, (size_t)(q - p) };
+    q += 2;
+    const char* c = q;
+    while ((c = (const char*)memchr(c, ':', e - c)) != nullptr && c + 1 < e && c[1] != ' ') c++;
+    if (c == nullptr || c + 1 >= e) c = e;
+    func = { q, (size_t)(c - q) };
+    rest = (c == e) ? e : c + 2;
+    return true;
+}
+
+// the pairs of "name = value" separated by ';' or ','
+static void scanPairs(const char* p, const char* e, vector<pair<Span, Span>>& pairs) {
+    pairs.clear();
+    while (p < e) {
+        while (p < e && (*p == ' ' || *p == ';' || *p == ',')) p++;
+        const char* name = p;
+        while (p < e && *p != ' ' && *p != '=' && *p != ';' && *p != ',') p++;
+        const char* nameEnd = p;
+        while (p < e && *p == ' ') p++;
+        if (p == e || *p != '=') {
+            /* not a pair, e.g., a word of a message */
+            while (p < e && *p != ';' && *p != ',') p++;
+            continue;
+        }
+        p++;
+        while (p < e && *p == ' ') p++;
+        const char* value = p;
+        while (p < e && *p != ';' && *p != ',' && *p != ' ') p++;
+        if (nameEnd > name && p > value) pairs.push_back({ { name, (size_t)(nameEnd - name) }, { value, (size_t)(p - value) } });
+    }
+}
+
+static bool contains(const Span& s, const string& pattern) {
+    return pattern.empty() || memmem(s.p, s.n, pattern.data(), pattern.size()) != nullptr;
+}
+
+static string stem(const string& path) {
+    size_t slash = path.find_last_of('/');
+    string s = (slash == string::npos) ? path : path.substr(slash + 1);
+    size_t dot = s.find_last_of('.');
+    return (dot == string::npos || dot == 0) ? s : s.substr(0, dot);
+}
+
+struct Result {
+    unsigned long runs, rows;
+    string text;                // the row of -j, or the error
+};
+
+static Result parseLog(const string& path, const Input& in, const Options& opt) {
+    Result r = { 0, 0, "" };
+    string prefix = !opt.prefix.empty() ? opt.prefix : (path == "-") ? "file" : stem(path) + "_";
+    Table* table = nullptr;
+    vector<string> keys;
+    vector<pair<Span, Span>> pairs;
+    vector<const Span*> values;
+    const char* p = in.data;
+    const char* end = in.data + in.size;
+    bool inRun = opt.marker.empty();
+    auto openTable = [&]() {
+        string header = opt.stamp ? "time" : "";
+        for (auto& k : keys) header += (header.empty() ? "" : ",") + k;
+        if (table->open(header + "\n")) return true;
+        r.text = "cannot write into " + opt.outDir;
+        return false;
+    };
+    auto startRun = [&]() {
+        if (table) {
+            r.rows += table->getRows();
+            delete table;
+        }
+        char name[16];
+        snprintf(name, sizeof(name), "%03lu.csv", r.runs++);
+        table = new Table(opt.outDir + "/" + prefix + name);
+        keys = opt.keys;
+        inRun = true;
+        /* with -k all, the header waits for the first line */
+        return keys.empty() || openTable();
+    };
+    if (inRun && !startRun()) p = end;
+    while (p < end) {
+        const char* e = (const char*)memchr(p, '\n', end - p);
+        if (e == nullptr) e = end;
+        const char* next = e + 1;
+        if (e > p && e[-1] == '\r') e--;
+        Span stamp, func;
+        const char* rest;
+        if (scanHead(p, e, stamp, func, rest)) {
+            if (!opt.marker.empty() && contains(func, opt.marker)) {
+                if (!startRun()) break;
+            } else if (inRun && contains(func, opt.function)) {
+                scanPairs(rest, e, pairs);
+                if (keys.empty() && !pairs.empty()) {
+                    for (auto& kv : pairs) keys.push_back(string(kv.first.p, kv.first.n));
+                    if (!openTable()) break;
+                }
+                values.clear();
+                for (auto& k : keys) {
+                    const Span* v = nullptr;
+                    for (auto& kv : pairs) {
+                        if (kv.first == k) {
+                            v = &kv.second;
+                            break;
+                        }
+                    }
+                    if (v == nullptr) break;
+                    values.push_back(v);
+                }
+                if (!keys.empty() && values.size() == keys.size()) {
+                    if (opt.stamp) table->append(stamp.p, stamp.n);
+                    for (size_t i = 0; i < values.size(); i++) {
+                        if (i > 0 || opt.stamp) table->append(",", 1);
+                        table->append(values[i]->p, values[i]->n);
+                    }
+                    table->endRow();
+                }
+            }
+        }
+        p = next;
+    }
+    if (table) {
+        r.rows += table->getRows();
+        delete table;
+    }
+    return r;
+}
+
+// ---- the result of sim ctl end ----
+// the value of "key" in the measurement of the course, or empty
+static string jsonValue(const char* p, const char* e, const string& key) {
+    string quoted = "\"" + key + "\"";
+    const char* k = (const char*)memmem(p, e - p, quoted.data(), quoted.size());
+    if (k == nullptr) return "";
+    k += quoted.size();
+    while (k < e && (*k == ' ' || *k == ':' || *k == '"')) k++;
+    const char* v = k;
+    while (k < e && ((*k >= '0' && *k <= '9') || *k == '-' || *k == '.')) k++;
+    return string(v, k - v);
+}
+
+// milliseconds in seconds as lpprt.awk prints, 0 for none
+static string seconds(const string& ms) {
+    long v = atol(ms.c_str());
+    if (v == 0) return "0";
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%ld.%03ld", v / 1000, v % 1000);
+    return buf;
+}
+
+static Result parseResult(const string& path, const Input& in, const Options& opt) {
+    Result r = { 1, 1, "" };
+    const char* p = in.data;
+    const char* e = in.data + in.size;
+    static const string right = "\"rightMeasurement\"";
+    const char* split = (const char*)memmem(p, e - p, right.data(), right.size());
+    if (split == nullptr) split = e;
+    if (opt.right) p = split;
+    else e = split;
+    size_t csv = path.find(".csv");
+    string name = (csv != string::npos && csv >= 4) ? path.substr(csv - 4, 4) : "";
+    r.text = name + "," + seconds(jsonValue(p, e, "MEASUREMENT_TIME")) + "," + seconds(jsonValue(p, e, "RUN_TIME"));
+    for (const char* key : { "GATE1", "GATE2", "GOAL", "SLALOM", "PETBOTTLE", "GARAGE_STOP" }) r.text += "," + jsonValue(p, e, key);
+    r.text += "," + seconds(jsonValue(p, e, "GARAGE_TIME")) + "," + jsonValue(p, e, "BLOCK_IN_GARAGE");
+    return r;
+}
+
+// ---- command line ----
+static void usage_exit(const char* cmd) {
+    cerr << "Usage: " << cmd << " [-f function] [-k keys|all] [-t] [-c marker] [-o dir] [-p prefix] [-n threads] [file...]" << endl
+         << "       " << cmd << " -j [-r] [-n threads] file..." << endl;
+    exit(1);
+}
+
+int main(int argc, char* argv[]) {
+    Options opt = { "Observer::operate", "Captain default constructor", ".", "", { "x", "y" }, false, false, false };
+    int threads = max(1u, thread::hardware_concurrency());
+    int c;
+    while ((c = getopt(argc, argv, "f:k:tc:o:p:jrn:h")) != -1) {
+        switch (c) {
+        case 'f': opt.function = optarg; break;
+        case 'k': {
+            opt.keys.clear();
+            if (strcmp(optarg, "all") == 0) break;
+            stringstream ss(optarg);
+            string item;
+            while (getline(ss, item, ',')) if (!item.empty()) opt.keys.push_back(item);
+            if (opt.keys.empty()) usage_exit(argv[0]);
+            break;
+        }
+        case 't': opt.stamp = true; break;
+        case 'c': opt.marker = optarg; break;
+        case 'o': opt.outDir = optarg; break;
+        case 'p': opt.prefix = optarg; break;
+        case 'j': opt.json = true; break;
+        case 'r': opt.right = true; break;
+        case 'n': threads = atoi(optarg); break;
+        default: usage_exit(argv[0]);
+        }
+    }
+    if (threads < 1 || (opt.json && optind == argc)) usage_exit(argv[0]);
+    vector<string> files(argv + optind, argv + argc);
+    if (files.empty()) files.push_back("-");
+
+    vector<Result> results(files.size());
+    atomic<int> next(0);
+    atomic<unsigned long> bytes(0);
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> pool;
+    threads = min(threads, (int)files.size());
+    for (int w = 0; w < threads; w++) {
+        pool.emplace_back([&]() {
+            for (int i = next.fetch_add(1); i < (int)files.size(); i = next.fetch_add(1)) {
+                Input in(files[i]);
+                if (!in.error.empty()) {
+                    results[i] = { 0, 0, in.error };
+                    continue;
+                }
+                results[i] = opt.json ? parseResult(files[i], in, opt) : parseLog(files[i], in, opt);
+                bytes += in.size;
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    int status = 0;
+    unsigned long runs = 0, rows = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        const Result& r = results[i];
+        if (opt.json && r.runs > 0) {
+            cout << r.text << endl;
+        } else if (!r.text.empty()) {
+            cerr << files[i] << ": " << r.text << endl;
+            status = 1;
+        }
+        runs += r.runs;
+        rows += r.rows;
+    }
+    if (!opt.json) {
+        cerr << files.size() << " file(s), " << bytes / 1e6 << " MB in " << elapsed << " s ("
+             << bytes / 1e6 / max(elapsed, 1e-9) << " MB/s) by " << threads << " thread(s): "
+             << runs << " run(s), " << rows << " row(s)" << endl;
+    }
+    return status;
+}
@@ -11,32 +11,37 @@ fi
 
 DSTDIR=${ETROBO_HRP3_WORKSPACE}/ms2021/work
 TMPL=${ETROBO_HRP3_WORKSPACE}/ms2021/template
-SRC=${ETROBO_HRP3_WORKSPACE}/ms2021/fourier.c
-OBJ=${ETROBO_HRP3_WORKSPACE}/ms2021/work/fourier.o
+SRC=${ETROBO_HRP3_WORKSPACE}/ms2021/tool/spectrum.cpp
+OBJ=${ETROBO_HRP3_WORKSPACE}/ms2021/work/spectrum
+COLUMNS="pwdL deltaAngDiff"
 BTLOG="btlog"
 COND="cond"
 CMD="cmd"
-DATA="fdata"
 GRAPH="graph"
 EXT="txt"
 SEQ=1
 
+g++ -std=gnu++11 -O2 -pthread ${SRC} -o ${OBJ} || exit 1
 BASE=${BTLOG}_${SEQ}
 while ls $DSTDIR | grep -w $BASE >/dev/null; do
   LOGFILE=${DSTDIR}/${BASE}.${EXT}
   echo processing ${LOGFILE}...
   CONDFILE=${DSTDIR}/${COND}_${SEQ}.${EXT}
-  DATAFILE=${DSTDIR}/${DATA}_${SEQ}.${EXT}
-  gcc ${SRC} -o ${OBJ} -lfftw3
-  # Use data for ten seconds as if it were for one second - do NOT forget to divide output frequency by ten!!!
-  # $6:pwdL $45:deltaAngDiff
-  cat $LOGFILE | grep "Logger::outputLog" | grep -v "^000000" | awk '{print $6}' | head -n 1000 | sed s:\;::g | ${OBJ} > $DATAFILE
-  for TYPE in fourier; do
-    PNGFILE=${DSTDIR}/${GRAPH}_${SEQ}_${TYPE}.png
-    CMDFILE=${DSTDIR}/${CMD}_${SEQ}_${TYPE}.gp
-    cat ${TMPL}_${TYPE}.gp | sed "s:@TITLE:`cat ${CONDFILE}`:g" | sed "s:@PNGFILE:${PNGFILE}:g" | sed "s:@DATAFILE:${DATAFILE}:g" > $CMDFILE
-    $GNUPLOT $CMDFILE
-    rm $CMDFILE
+  # the whole run in segments of 256 samples with the Hamming window, frequency in Hz as it is
+  ${OBJ} -k `echo ${COLUMNS} | tr ' ' ,` -o ${DSTDIR} ${LOGFILE}
+  for COLUMN in ${COLUMNS}; do
+    for TYPE in fourier spectrogram; do
+      if [ ${TYPE} == "fourier" ]; then
+        DATAFILE=${DSTDIR}/${BASE}_${COLUMN}_psd.${EXT}
+      else
+        DATAFILE=${DSTDIR}/${BASE}_${COLUMN}_stft.${EXT}
+      fi
+      PNGFILE=${DSTDIR}/${GRAPH}_${SEQ}_${TYPE}_${COLUMN}.png
+      CMDFILE=${DSTDIR}/${CMD}_${SEQ}_${TYPE}.gp
+      cat ${TMPL}_${TYPE}.gp | sed "s:@TITLE:`cat ${CONDFILE}` ${COLUMN}:g" | sed "s:@PNGFILE:${PNGFILE}:g" | sed "s:@DATAFILE:${DATAFILE}:g" > $CMDFILE
+      $GNUPLOT $CMDFILE
+      rm $CMDFILE
+    done
   done
   SEQ=`expr $SEQ + 1`
   BASE=${BTLOG}_${SEQ}
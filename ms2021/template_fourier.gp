@@ -3,5 +3,6 @@ set nokey
 set output "@PNGFILE"
 set title "@TITLE"
 set xlabel "f (Hz)"
-set ylabel "|F(w)|"
-plot [:][:5000] "@DATAFILE" using ($1/10):4 with impulses linewidth 1
\ No newline at end of file
+set ylabel "PSD (dB/Hz)"
+set grid xtics mxtics ytics mytics
+plot "@DATAFILE" using 1:3 with lines linewidth 1
\ No newline at end of file
@@ -0,0 +1,10 @@
+set terminal png
+set nokey
+set output "@PNGFILE"
+set title "@TITLE"
+set xlabel "Time (sec)"
+set ylabel "f (Hz)"
+set cblabel "PSD (dB/Hz)"
+set view map
+set pm3d map
+splot "@DATAFILE" using 1:2:3 with pm3d
\ No newline at end of file
@@ -0,0 +1,117 @@
+// host stand-in of the robot tracing the line of the left course under the lighting
+// of the ET robocon simulator, with WHEEL_TREAD of Plotter.hpp, for the tools in this directory
+//
+// the robot is integrated in the frame of the line, i.e., distance s along the line,
+// lateral offset e of the axle center (positive to the left) and heading psi against the line.
+// the lighting parameters are those of the simulator, 0 to 3 each, mapped as
+//  EnvLightIntensityLevel: the gain of the reflected light, brighter for a larger level,
+//  EnvLightRotation: the phase of the ambient light varying along the course,
+//  LSpotLight: the strength of a spot light over the second straight.
+// the mapping is a plausible model, not a fit to the simulator; it reproduces
+// the target brightness GS_TARGET landing on a different place of the edge by lighting.
+// the red is raw, which the FIR of main_task() passes by 0.74 at DC, so that GS_TARGET 47
+// stands for about 63 between the black of 6 to 8 and the white of 88 to 125.
+#ifndef LineCourse_hpp
+#define LineCourse_hpp
+
+#include <cmath>
+#include <cstdint>
+
+#define LC_WHEEL_TREAD      140.0   // mm
+#define LC_TIRE_DIAMETER    90.0    // mm
+#define LC_MMPS_PER_PWM     8.0     // wheel speed by pwm of the large motor at 8 V
+#define LC_MOTOR_TAU        0.1     // time constant of the wheel speed in second
+#define LC_SENSOR_AHEAD     60.0    // mm from the axle to the color sensor
+#define LC_LINE_HALFWIDTH   10.0    // the line is 20 mm wide
+#define LC_SPOT_SIZE        12.0    // mm over which the sensor blends black and white
+#define LC_LOST_OFFSET      60.0    // mm from the line center where the line is lost
+#define LC_SUBSTEPS         10      // per PERIOD_UPD_TSK
+
+// sections of the left course from the start to the goal, by length in mm and curvature in 1/mm,
+// positive to the left
+struct LineSection {
+    double length, curvature;
+};
+static const LineSection lcSections[] = {
+    { 2200.0,  0.0         }, { 1413.7, -1.0 / 450.0 }, { 1000.0, 0.0 },        { 942.5, 1.0 / 600.0 },
+    { 628.3,  -1.0 / 400.0 }, { 1800.0,  0.0 },        { 1256.6, -1.0 / 400.0 }, { 700.0, 0.0 },
+    { 785.4,   1.0 / 500.0 }, { 1100.0,  0.0 },
+};
+#define LC_NUM_SECTIONS     (int)(sizeof(lcSections) / sizeof(lcSections[0]))
+
+struct Lighting {
+    int level, rotation, spot;
+};
+
+class LineCourse {
+public:
+    LineCourse(const Lighting& l, uint32_t seed) : light(l), rng(seed ? seed : 1U) {
+        length = 0.0;
+        for (int i = 0; i < LC_NUM_SECTIONS; i++) length += lcSections[i].length;
+    }
+    // place the robot on the line at distance s0, e.g., by JUMP
+    void place(double s0) {
+        s = s0; e = 0.0; psi = 0.0; vL = vR = 0.0; angL = angR = 0.0; section = 0; sectionStart = 0.0;
+        seek();
+    }
+    // red of the raw color as ColorSensor::getRawColor() would read
+    int16_t readRed() {
+        double es = e + LC_SENSOR_AHEAD * sin(psi);
+        double gain = 0.7 + 0.1 * light.level;
+        double ambient = 8.0 * sin(2.0 * M_PI * s / length + light.rotation * M_PI / 2.0);
+        double spotCenter = lcSections[0].length + lcSections[1].length + lcSections[2].length / 2.0;
+        double spot = 7.0 * light.spot * exp(-pow((s - spotCenter) / 400.0, 2));
+        double white = 125.0 * gain + ambient + spot, black = 8.0 * gain + 0.3 * (ambient + spot);
+        // fraction of the sensor spot over the black line, smooth across both edges
+        double inside = LC_LINE_HALFWIDTH - fabs(es);
+        double cover = fmin(fmax(inside / LC_SPOT_SIZE + 0.5, 0.0), 1.0);
+        return (int16_t)lround(white + (black - white) * cover + noise());
+    }
+    // advance period seconds with the pwm given to the motors
+    void step(double pwmL, double pwmR, double period) {
+        double dt = period / LC_SUBSTEPS;
+        for (int k = 0; k < LC_SUBSTEPS; k++) {
+            vL += (pwmL * LC_MMPS_PER_PWM - vL) * dt / LC_MOTOR_TAU;
+            vR += (pwmR * LC_MMPS_PER_PWM - vR) * dt / LC_MOTOR_TAU;
+            angL += vL * dt * 360.0 / (M_PI * LC_TIRE_DIAMETER);
+            angR += vR * dt * 360.0 / (M_PI * LC_TIRE_DIAMETER);
+            double v = (vL + vR) / 2.0, w = (vR - vL) / LC_WHEEL_TREAD;
+            double kappa = lcSections[section].curvature;
+            double ds = v * cos(psi) / (1.0 - kappa * e) * dt;
+            e += v * sin(psi) * dt;
+            psi += w * dt - kappa * ds;     // curvature positive to the left
+            s += ds;
+            seek();
+        }
+    }
+    double getDistance() const { return s; }
+    double getLength() const { return length; }
+    double getOffset() const { return e; }
+    // wheel travel in degree as the encoders read it
+    double getAngleL() const { return angL; }
+    double getAngleR() const { return angR; }
+    bool isLost() const { return fabs(e + LC_SENSOR_AHEAD * sin(psi)) > LC_LOST_OFFSET; }
+    bool isGoal() const { return s >= length; }
+protected:
+    Lighting light;
+    uint32_t rng;
+    double length, s, e, psi, vL, vR, angL, angR, sectionStart;
+    int section;
+    void seek() {
+        while (section < LC_NUM_SECTIONS - 1 && s >= sectionStart + lcSections[section].length) {
+            sectionStart += lcSections[section].length;
+            section++;
+        }
+    }
+    // about 1.5 in standard deviation, deterministic by the seed
+    double noise() {
+        double sum = 0.0;
+        for (int i = 0; i < 4; i++) {
+            rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+            sum += (rng & 0xffff) / 65536.0;
+        }
+        return (sum - 2.0) * 2.6;
+    }
+};
+
+#endif
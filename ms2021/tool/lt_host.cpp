@@ -0,0 +1,136 @@
+// the host backend of lt_sweep: TraceLine of ../app.cpp, compiled as it is with PIDcalculator,
+// FilteredColorSensor, FilteredMotor and SRLF of ms2021, against the declarations of ev3api
+// in msad2022_pri/hostsim, whose devices are stood in here over LineCourse.hpp
+//
+// built along with lt_sweep.cpp, see there
+#include <iostream>
+#include <list>
+#include <numeric>
+#include <time.h>
+// the global Clock* clock of app.cpp and Logger.cpp, renamed after the C library has declared clock()
+#define clock ev3clock
+#include "../app.cpp"
+#include "../Logger.cpp"
+#include "lt_sweep.hpp"
+#include "LineCourse.hpp"
+
+// ---- stand-ins of the devices and the kernel services declared by the headers of hostsim ----
+static LineCourse* world;
+static uint64_t simTime;                // micro second
+static int pwms[TNUM_MOTOR_PORT];
+static int32_t countZero[TNUM_MOTOR_PORT];
+
+// the encoder of each motor port as wired in main_task()
+static int32_t encoder(int port) {
+    if (port == PORT_C) return (int32_t)floor(world->getAngleL());
+    if (port == PORT_B) return (int32_t)floor(world->getAngleR());
+    return 0;
+}
+
+ER act_tsk(ID) { return E_OK; }
+ER slp_tsk(void) { return E_OK; }
+ER wup_tsk(ID) { return E_OK; }
+ER ext_tsk(void) { return E_OK; }
+ER sta_cyc(ID) { return E_OK; }
+ER stp_cyc(ID) { return E_OK; }
+void syslog(uint_t, const char*, ...) {}
+ER ev3_led_set_color(ledcolor_t) { return E_OK; }
+bool_t ev3_button_is_pressed(button_t) { return false; }
+FILE* ev3_serial_open_file(serial_port_t) { return fopen("/dev/null", "w"); }
+int ev3_battery_voltage_mV(void) { return 8000; }
+void ETRoboc_notifyCompletedToSimulator(void) {}
+
+namespace ev3api {
+Clock::Clock() : mStartTime(simTime) {}
+void Clock::reset() { mStartTime = simTime; }
+uint32_t Clock::now() const { return (uint32_t)(simTime - mStartTime); }
+void Clock::wait(uint32_t) {}
+void Clock::sleep(uint32_t) {}
+Motor::Motor(ePortM port, bool brake, motor_type_t) : mPort(port),mBrake(brake) { reset(); }
+Motor::~Motor() {}
+void Motor::reset() { pwms[mPort] = 0; countZero[mPort] = encoder(mPort); }
+int32_t Motor::getCount() const { return encoder(mPort) - countZero[mPort]; }
+void Motor::setCount(int32_t count) { countZero[mPort] = encoder(mPort) - count; }
+int Motor::getPWM() const { return pwms[mPort]; }
+void Motor::setPWM(int pwm) { pwms[mPort] = (pwm > 100) ? 100 : ((pwm < -100) ? -100 : pwm); }
+void Motor::setBrake(bool brake) { mBrake = brake; }
+void Motor::stop() { pwms[mPort] = 0; }
+ColorSensor::ColorSensor(ePortS port) : mPort(port) {}
+ColorSensor::~ColorSensor() {}
+// LineCourse models the red only; the line and the floor are gray as far as this goes
+void ColorSensor::getRawColor(rgb_raw_t& rgb) const {
+    int16_t red = world->readRed();
+    rgb.r = rgb.g = rgb.b = (uint16_t)((red < 0) ? 0 : red);
+}
+int8_t ColorSensor::getBrightness() const { return 0; }
+GyroSensor::GyroSensor(ePortS port) : mPort(port),mOffset(0) {}
+GyroSensor::~GyroSensor() {}
+int16_t GyroSensor::getAngle() const { return 0; }
+int16_t GyroSensor::getAnglerVelocity() const { return 0; }
+void GyroSensor::reset() {}
+void GyroSensor::setOffset(int16_t offset) { mOffset = offset; }
+TouchSensor::TouchSensor(ePortS port) : mPort(port) {}
+TouchSensor::~TouchSensor() {}
+bool TouchSensor::isPressed() const { return false; }
+SonarSensor::SonarSensor(ePortS port) : mPort(port) {}
+SonarSensor::~SonarSensor() {}
+int16_t SonarSensor::getDistance() const { return 255; }
+bool SonarSensor::listen() const { return false; }
+}
+
+// sets up the devices as main_task() does, then runs update_task() with TraceLine for the tree
+Run runApp(const Point& pt, unsigned seed, double maxTime) {
+    LineCourse course({ pt.level, pt.rotation, pt.spot }, seed);
+    course.place(0.0);
+    world = &course;
+
+    bt          = ev3_serial_open_file(EV3_SERIAL_BT);
+    clock       = new Clock();
+    colorSensor = new FilteredColorSensor(PORT_3);
+    gyroSensor  = new GyroSensor(PORT_4);
+    leftMotor   = new FilteredMotor(PORT_C);
+    rightMotor  = new FilteredMotor(PORT_B);
+    plotter     = new Plotter(leftMotor, rightMotor, gyroSensor);
+    const int FIR_ORDER = 4;
+    const double hn[FIR_ORDER+1] = { 7.483914270309116e-03, 1.634745733863819e-01, 4.000000000000000e-01, 1.634745733863819e-01, 7.483914270309116e-03 };
+    colorSensor->setRawColorFilters(new FIR_Transposed(hn, FIR_ORDER), new FIR_Transposed(hn, FIR_ORDER),
+                                    new FIR_Transposed(hn, FIR_ORDER));
+    srlf_l = new SRLF(0.0);
+    leftMotor->setPWMFilter(srlf_l);
+    srlf_r = new SRLF(0.0);
+    rightMotor->setPWMFilter(srlf_r);
+    BrainTree::BehaviorTree* tree = (BrainTree::BehaviorTree*) BrainTree::Builder()
+        .leaf<TraceLine>(pt.speed, GS_TARGET, pt.p, pt.i, pt.d, 0.0)
+        .build();
+
+    double period = PERIOD_UPD_TSK / 1000000.0, sumSq = 0.0;
+    Run r = { false, false, maxTime, 0.0, 0.0 };
+    int ticks = 0;
+    for (double t = 0.0; t < maxTime; t += period) {
+        /* update_task() in ST_running */
+        colorSensor->sense();
+        plotter->plot();
+        rgb_raw_t cur_rgb;
+        colorSensor->getRawColor(cur_rgb);
+        tree->update();
+        rightMotor->drive();
+        leftMotor->drive();
+
+        course.step(pwms[PORT_C], pwms[PORT_B], period);
+        simTime += PERIOD_UPD_TSK;
+        sumSq += (double)(cur_rgb.r - GS_TARGET) * (cur_rgb.r - GS_TARGET);
+        ticks++;
+        r.maxOffset = fmax(r.maxOffset, fabs(course.getOffset()));
+        if (course.isLost()) {
+            r.lost = true;
+            break;
+        }
+        if (course.isGoal()) {
+            r.goal = true;
+            r.time = t + period;
+            break;
+        }
+    }
+    r.rms = sqrt(sumSq / (ticks > 0 ? ticks : 1));
+    return r;
+}
@@ -0,0 +1,297 @@
+// this tool sweeps the lighting, SPEED_NORM, P_CONST, I_CONST, D_CONST and JUMP of ms2021
+// over a grid in parallel, replacing the serial loops of ltloop.sh, ltloopmt.sh and ltloop30.sh
+//
+// g++ -std=gnu++11 -O2 -pthread -I../../msad2022_pri/hostsim -o lt_sweep lt_sweep.cpp lt_host.cpp ../SRLF.cpp ../FIR.cpp ../FilteredMotor.cpp ../FilteredColorSensor.cpp ../Plotter.cpp ../PIDcalculator.cpp
+// ./lt_sweep -L 0:3 -R 0:3 -S 0:3 -s 45,55,65 -p 0.5:1.0:0.25 -c 4
+//
+// options are those of run.sh with lists "a,b,c" or ranges "from:to[:step]":
+//  -L EnvLightIntensityLevel, -R EnvLightRotation, -S LSpotLight (0 to 3),
+//  -s speed, -p P, -i I, -d D, -j JUMP, -c count of runs per grid point,
+//  -t maxtime in second per run, -n threads (default all the cores),
+//  -o the results table (default sweep_yymmddHHMMSS.csv), -b backend.
+// backend "host" (default) runs the code of ms2021 in simulated time, a full run taking a few milliseconds:
+// TraceLine of app.cpp, built as it is by lt_host.cpp, with PIDcalculator, FilteredColorSensor with the FIR
+// of main_task() and FilteredMotor with SRLF, against the ev3api stand-ins over LineCourse.hpp,
+// which models the left course and the lighting; the speed, P, I and D go to TraceLine as it takes them.
+// TraceLine traces the whole course as update_task() would in ST_running; the timed sequences of tr_run,
+// the slalom and the garage, i.e., JUMP 1 and 2, are for the simulator only.
+// each run is a process of its own, as app.cpp keeps the devices in globals;
+// the count runs differ in the sensor noise only, with the same seeds at every grid point.
+// backend "sim" drives the ET robocon simulator as ltloop.sh does, one run at a time,
+// building the app with USER_COPTS as run.sh whenever speed, P, I, D or JUMP changes,
+// and reads the result of the left course as lpprt.awk does; run it in $ETROBO_ROOT.
+// grid points are dealt to the workers, which steal from each other once idle.
+// the table has a row per grid point with the runs aggregated.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <map>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <sys/wait.h>
+using namespace std;
+#include "lt_sweep.hpp"
+
+// ---- backend "host" ----
+// runs runApp() of lt_host.cpp in a child process, which hands the result back through a pipe
+static Run runHost(const Point& pt, int rep, double maxTime) {
+    Run r = { false, false, maxTime, NAN, NAN };
+    int fds[2];
+    if (pipe(fds) != 0) return r;
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        Run c = runApp(pt, 2463534242U ^ (rep * 7919U + 1U), maxTime);
+        _exit(write(fds[1], &c, sizeof(c)) == (ssize_t)sizeof(c) ? 0 : 1);
+    }
+    close(fds[1]);
+    if (pid > 0) {
+        Run c;
+        if (read(fds[0], &c, sizeof(c)) == (ssize_t)sizeof(c)) r = c;
+        waitpid(pid, nullptr, 0);
+    }
+    close(fds[0]);
+    return r;
+}
+
+// ---- backend "sim" ----
+static string lastBuild;
+
+static int shell(const string& cmd) {
+    cout << "+ " << cmd << endl;
+    return system(cmd.c_str());
+}
+
+// the value of "key" in the result of sim ctl end before "rightMeasurement", or -1
+static long field(const string& json, const string& key) {
+    size_t end = json.find("\"rightMeasurement\"");
+    size_t pos = json.find("\"" + key + "\"");
+    if (pos == string::npos || (end != string::npos && pos > end)) return -1;
+    pos = json.find(':', pos);
+    if (pos == string::npos) return -1;
+    while (++pos < json.size() && (json[pos] == ' ' || json[pos] == '"')) {}
+    return strtol(json.c_str() + pos, nullptr, 10);
+}
+
+// every run of a grid point is the same build under the same lighting, hence no use of the run number
+static Run runSim(const Point& pt, int, double maxTime) {
+    ostringstream copts;
+    copts << fixed << setprecision(4) << "-DP_CONST=" << pt.p << "D -DI_CONST=" << pt.i << "D -DD_CONST=" << pt.d
+          << "D -DSPEED_NORM=" << pt.speed << " -DJUMP=" << pt.jump << " -DLOG_INTERVAL=0";
+    if (copts.str() != lastBuild) {
+        shell("USER_COPTS=\"" + copts.str() + "\" make app=ms2021 sim");
+        lastBuild = copts.str();
+    }
+    ostringstream light;
+    light << "{\\\"EnvLightIntensityLevel\\\":" << pt.level << ",\\\"EnvLightRotation\\\":" << pt.rotation
+          << ",\\\"LSpotLight\\\":" << pt.spot << ",\\\"RSpotLight\\\":0}";
+    shell("curl -s -X POST -H \"Content-Type: application/json\" -d @${ETROBO_HRP3_WORKSPACE}/ms2021/init_JUMP_"
+          + to_string(pt.jump) + ".json http://localhost:54000");
+    shell("sim ctl pos 3 0 -16.35 90 && sleep 5");
+    shell("curl -s -X POST -H \"Content-Type: application/json\" -d \"" + light.str() + "\" http://localhost:54000 && sleep 3");
+    shell("asp ms2021 & sleep 1; sim ctl prepare && sleep 3; sim ctl go & sleep " + to_string((int)maxTime)
+          + "; kill `asp check l` > /dev/null 2>&1; sleep 2");
+    string json;
+    FILE* fp = popen("sim ctl end 2>&1", "r");
+    if (fp != nullptr) {
+        char buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) json.append(buf, n);
+        pclose(fp);
+    }
+    shell("asp stop");
+    Run r = { field(json, "GOAL") > 0, field(json, "GATE1") <= 0, maxTime, NAN, NAN };
+    long runTime = field(json, "RUN_TIME");
+    if (r.goal && runTime > 0) r.time = runTime / 1000.0;
+    return r;
+}
+
+// ---- work-stealing queue of grid points ----
+class WorkStealingQueue {
+public:
+    WorkStealingQueue(int workers) : queues(workers), locks(workers) {}
+    // deal in contiguous blocks, so that the neighbors in the grid share a worker
+    void deal(int jobs) {
+        int n = (int)queues.size();
+        for (int j = 0; j < jobs; j++) queues[(long)j * n / jobs].push_back(j);
+    }
+    // from the back of its own, or from the front of another worker
+    bool take(int self, int& job) {
+        int n = (int)queues.size();
+        for (int k = 0; k < n; k++) {
+            int w = (self + k) % n;
+            lock_guard<mutex> lock(locks[w]);
+            if (queues[w].empty()) continue;
+            if (k == 0) {
+                job = queues[w].back();
+                queues[w].pop_back();
+            } else {
+                job = queues[w].front();
+                queues[w].pop_front();
+                steals++;
+            }
+            return true;
+        }
+        return false;
+    }
+    int getSteals() const { return steals; }
+protected:
+    vector<deque<int>> queues;
+    vector<mutex> locks;
+    atomic<int> steals{0};
+};
+
+// ---- command line ----
+static vector<double> values(const char* arg) {
+    vector<double> v;
+    string s(arg);
+    size_t colon = s.find(':');
+    if (colon == string::npos) {
+        stringstream ss(s);
+        string item;
+        while (getline(ss, item, ',')) v.push_back(atof(item.c_str()));
+    } else {
+        double from = atof(s.c_str()), to = atof(s.c_str() + colon + 1), step = 1.0;
+        size_t colon2 = s.find(':', colon + 1);
+        if (colon2 != string::npos) step = atof(s.c_str() + colon2 + 1);
+        if (step <= 0.0) step = 1.0;
+        for (double x = from; x <= to + step * 1e-9; x += step) v.push_back(x);
+    }
+    return v;
+}
+
+static void usage_exit(const char* cmd) {
+    cerr << "Usage: " << cmd << " [-L levels] [-R rotations] [-S spots] [-s speeds] [-p ps] [-i is] [-d ds]"
+         << " [-j jumps] [-c count] [-t maxtime] [-n threads] [-o table] [-b host|sim]" << endl;
+    exit(1);
+}
+
+int main(int argc, char* argv[]) {
+    vector<double> L = { 0, 1, 2, 3 }, R = { 0, 1, 2, 3 }, S = { 0, 1, 2, 3 };
+    vector<double> speeds = { 55 }, ps = { 0.75 }, is = { 0.39 }, ds = { 0.08 }, jumps = { 0 };
+    int count = 1, threads = max(1u, thread::hardware_concurrency());
+    double maxTime = 50.0;
+    string table, backend = "host";
+    int opt;
+    while ((opt = getopt(argc, argv, "L:R:S:s:p:i:d:j:c:t:n:o:b:h")) != -1) {
+        switch (opt) {
+        case 'L': L = values(optarg); break;
+        case 'R': R = values(optarg); break;
+        case 'S': S = values(optarg); break;
+        case 's': speeds = values(optarg); break;
+        case 'p': ps = values(optarg); break;
+        case 'i': is = values(optarg); break;
+        case 'd': ds = values(optarg); break;
+        case 'j': jumps = values(optarg); break;
+        case 'c': count = atoi(optarg); break;
+        case 't': maxTime = atof(optarg); break;
+        case 'n': threads = atoi(optarg); break;
+        case 'o': table = optarg; break;
+        case 'b': backend = optarg; break;
+        default: usage_exit(argv[0]);
+        }
+    }
+    if (count < 1 || threads < 1 || maxTime <= 0.0 || (backend != "host" && backend != "sim")) usage_exit(argv[0]);
+    Run (*run)(const Point&, int, double) = runHost;
+    if (backend == "host" && any_of(jumps.begin(), jumps.end(), [](double j) { return j != 0.0; })) {
+        cerr << "JUMP 1 and 2 start the slalom and the garage, which run on the simulator only." << endl;
+        return 1;
+    }
+    if (backend == "sim") {
+        if (getenv("ETROBO_ROOT") == nullptr) {
+            cerr << "etrobo environment is not available." << endl;
+            return 1;
+        }
+        /* there is only one simulator */
+        run = runSim;
+        threads = 1;
+    }
+    if (table.empty()) {
+        char dt[32];
+        time_t now = time(nullptr);
+        strftime(dt, sizeof(dt), "%y%m%d%H%M%S", localtime(&now));
+        table = string("sweep_") + dt + ".csv";
+    }
+
+    /* the build parameters outermost, so that the sim backend rebuilds least */
+    vector<Point> grid;
+    for (double sp : speeds) for (double p : ps) for (double i : is) for (double d : ds) for (double j : jumps)
+        for (double l : L) for (double r : R) for (double s : S)
+            grid.push_back({ (int)l, (int)r, (int)s, (int)sp, (int)j, p, i, d });
+    int jobs = (int)grid.size() * count;
+    vector<Run> runs(jobs);
+    WorkStealingQueue queue(threads);
+    queue.deal(jobs);
+
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int w = 0; w < threads; w++) {
+        pool.emplace_back([&, w]() {
+            int job;
+            while (queue.take(w, job)) runs[job] = run(grid[job / count], job % count, maxTime);
+        });
+    }
+    for (auto& t : pool) t.join();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    ofstream out(table);
+    out << "level,rotation,spot,speed,p,i,d,jump,runs,goals,lost,mean_time,best_time,rms,max_offset" << endl;
+    /* ranked by the worst over the lighting per set of the others */
+    map<vector<double>, pair<int, double>> worst;
+    for (size_t g = 0; g < grid.size(); g++) {
+        const Point& pt = grid[g];
+        int goals = 0, lost = 0;
+        double sumTime = 0.0, best = HUGE_VAL, rms = 0.0, maxOffset = 0.0;
+        for (int k = 0; k < count; k++) {
+            const Run& r = runs[g * count + k];
+            if (r.goal) {
+                goals++;
+                sumTime += r.time;
+                best = min(best, r.time);
+            }
+            if (r.lost) lost++;
+            rms += r.rms / count;
+            maxOffset = max(maxOffset, r.maxOffset);
+        }
+        out << pt.level << "," << pt.rotation << "," << pt.spot << "," << pt.speed << "," << pt.p << "," << pt.i << ","
+            << pt.d << "," << pt.jump << "," << count << "," << goals << "," << lost << ",";
+        if (goals > 0) out << sumTime / goals << "," << best;
+        else out << ",";
+        if (!std::isnan(rms)) out << "," << rms << "," << maxOffset << endl;
+        else out << ",," << endl;
+        vector<double> key = { (double)pt.speed, pt.p, pt.i, pt.d, (double)pt.jump };
+        auto& w = worst.insert({ key, { count, 0.0 } }).first->second;
+        w.first = min(w.first, goals);
+        w.second = max(w.second, goals > 0 ? sumTime / goals : maxTime);
+    }
+    out.close();
+
+    cout << jobs << " runs of " << grid.size() << " grid points by " << threads << " thread(s) in " << elapsed
+         << " s, " << queue.getSteals() << " steals; results in " << table << endl;
+    vector<pair<vector<double>, pair<int, double>>> ranked(worst.begin(), worst.end());
+    sort(ranked.begin(), ranked.end(), [](const pair<vector<double>, pair<int, double>>& a,
+                                          const pair<vector<double>, pair<int, double>>& b) {
+        return (a.second.first != b.second.first) ? a.second.first > b.second.first : a.second.second < b.second.second;
+    });
+    cout << "best under the worst lighting:" << endl << " speed      P      I      D  JUMP  goals   time" << endl;
+    for (size_t k = 0; k < ranked.size() && k < 10; k++) {
+        const vector<double>& v = ranked[k].first;
+        cout << setw(6) << v[0] << setw(7) << v[1] << setw(7) << v[2] << setw(7) << v[3] << setw(6) << v[4]
+             << setw(5) << ranked[k].second.first << "/" << count << setw(7) << fixed << setprecision(2)
+             << ranked[k].second.second << defaultfloat << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,18 @@
+// the grid point and the result of a run shared by lt_sweep.cpp and its host backend lt_host.cpp
+#ifndef lt_sweep_hpp
+#define lt_sweep_hpp
+
+struct Point {
+    int level, rotation, spot, speed, jump;
+    double p, i, d;
+};
+
+struct Run {
+    bool goal, lost;
+    double time, rms, maxOffset;
+};
+
+// runs TraceLine of ms2021 on LineCourse.hpp; to be called once per process, as app.cpp keeps globals
+Run runApp(const Point& pt, unsigned seed, double maxTime);
+
+#endif
@@ -0,0 +1,346 @@
+// this tool analyzes the spectra of columns of the logs of ms2021, e.g., the oscillation of pwdL
+// while tracing the line, replacing fourier.c, which read a whole column into 1 GB of memory
+// and transformed it at once
+//
+// g++ -std=gnu++11 -O2 -pthread spectrum.cpp -o spectrum
+// ./spectrum -k pwdL,deltaAngDiff -N 256 -w hamming -o work work/btlog_*.txt
+//
+// the logs are read line by line, keeping only the current segment per column in memory,
+// so that a run of any length is analyzed in bounded memory.
+// the lines containing the pattern of -g (default Logger::outputLog) are taken and those stamped
+// earlier than -s (default 100, as grep -v "^000000" of fourier.sh) are skipped.
+// a column of -k is either a field number as awk counts, e.g., 6 for pwdL, or the name of a value
+// of Logger::outputLog, e.g., pwdL, taking the field after "pwdL ="; ';' trailing a field is ignored.
+// the samples are cut into segments of -N (a power of 2, default 256) overlapping by -v
+// (default half of them), detrended by the mean unless -D, and windowed by -w,
+// hamming (default, the window of the FIR of app.cpp), hann or rect.
+// the sampling period is -T in ms, or the mean interval of the stamps over the first segment,
+// taken as usec as graph.sh does, since it depends on LOG_INTERVAL.
+// for each file and column, it writes into the directory of -o (default .)
+//  <file>_<column>_psd.txt: the Welch estimate of the one-sided power spectral density,
+//   "f(Hz) psd(unit^2/Hz) psd(dB)" per line, for template_fourier.gp,
+//  <file>_<column>_stft.txt: the spectrogram, "t(sec) f(Hz) psd(dB)" per line, a block per segment
+//   separated by a blank line as splot with pm3d reads it, for template_spectrogram.gp.
+// the pairs of file and column are dealt to -n threads (default all the cores); each pair reads
+// its file by itself. the standard input, "-" or no file, is read once for all the columns.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <complex>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+using namespace std;
+
+// ---- iterative radix-2 FFT of a fixed size ----
+class FFT {
+public:
+    FFT(int n) : n(n), twiddle(n / 2), rev(n) {
+        int bits = 0;
+        while ((1 << bits) < n) bits++;
+        for (int k = 0; k < n / 2; k++) twiddle[k] = polar(1.0, -2.0 * M_PI * k / n);
+        for (int i = 0; i < n; i++) {
+            int r = 0;
+            for (int b = 0; b < bits; b++) if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+            rev[i] = r;
+        }
+    }
+    void transform(vector<complex<double>>& x) const {
+        for (int i = 0; i < n; i++) if (i < rev[i]) swap(x[i], x[rev[i]]);
+        for (int len = 2; len <= n; len <<= 1) {
+            int half = len / 2, stride = n / len;
+            for (int i = 0; i < n; i += len) {
+                for (int k = 0; k < half; k++) {
+                    complex<double> t = twiddle[k * stride] * x[i + k + half];
+                    x[i + k + half] = x[i + k] - t;
+                    x[i + k] += t;
+                }
+            }
+        }
+    }
+protected:
+    int n;
+    vector<complex<double>> twiddle;
+    vector<int> rev;
+};
+
+struct Options {
+    int n, overlap;
+    string window, pattern, outDir;
+    double period;      // ms, 0 to estimate from the stamps
+    unsigned long skip;
+    bool detrend;
+};
+
+// ---- streaming Welch PSD and spectrogram of a column ----
+class Spectrum {
+public:
+    Spectrum(const Options& o, FFT* fft, const vector<double>* window, FILE* stft) :
+        opt(o), fft(fft), window(window), stft(stft), ring(o.n), buf(o.n), psd(o.n / 2 + 1, 0.0),
+        samples(0), segments(0), sinceLast(0), firstStamp(0), period(o.period / 1000.0) {
+        winPower = 0.0;
+        for (double w : *window) winPower += w * w;
+    }
+    void push(unsigned long stamp, double x) {
+        if (samples == 0) firstStamp = stamp;
+        ring[samples % opt.n] = x;
+        samples++;
+        if (samples == (unsigned long)opt.n && period <= 0.0) {
+            period = (stamp - firstStamp) / 1e6 / (opt.n - 1);
+            if (period <= 0.0) period = 0.01;   // PERIOD_UPD_TSK
+        }
+        if (samples < (unsigned long)opt.n) return;
+        if (samples > (unsigned long)opt.n && ++sinceLast < opt.n - opt.overlap) return;
+        sinceLast = 0;
+        segment();
+    }
+    // writes the averaged PSD; returns the frequency of its peak except DC
+    double finish(FILE* out, double& peak) {
+        int bins = opt.n / 2 + 1;
+        peak = 0.0;
+        double fpeak = 0.0;
+        for (int k = 0; k < bins && segments > 0; k++) {
+            double p = psd[k] / segments, f = k / (period * opt.n);
+            fprintf(out, "%.6f %.6e %.3f\n", f, p, 10.0 * log10(p + 1e-30));
+            if (k > 0 && p > peak) {
+                peak = p;
+                fpeak = f;
+            }
+        }
+        return fpeak;
+    }
+    unsigned long getSamples() const { return samples; }
+    unsigned long getSegments() const { return segments; }
+    double getPeriod() const { return period; }
+protected:
+    const Options& opt;
+    FFT* fft;
+    const vector<double>* window;
+    FILE* stft;
+    vector<double> ring;
+    vector<complex<double>> buf;
+    vector<double> psd;
+    unsigned long samples, segments;
+    int sinceLast;
+    unsigned long firstStamp;
+    double period, winPower;
+    void segment() {
+        int n = opt.n, start = (int)(samples % n);  // the oldest sample in the ring
+        double mean = 0.0;
+        if (opt.detrend) {
+            for (double x : ring) mean += x;
+            mean /= n;
+        }
+        for (int i = 0; i < n; i++) buf[i] = complex<double>((ring[(start + i) % n] - mean) * (*window)[i], 0.0);
+        fft->transform(buf);
+        /* one-sided density; the bins but DC and Nyquist stand for their negative frequencies as well */
+        double scale = period / winPower, t = ((samples - n) + n / 2.0) * period;
+        for (int k = 0; k <= n / 2; k++) {
+            double p = norm(buf[k]) * scale * ((k == 0 || k == n / 2) ? 1.0 : 2.0);
+            psd[k] += p;
+            if (stft) fprintf(stft, "%.4f %.6f %.3f\n", t, k / (period * n), 10.0 * log10(p + 1e-30));
+        }
+        if (stft) fputc('\n', stft);
+        segments++;
+    }
+};
+
+// a column is an awk field number or the name of a value of Logger::outputLog
+struct Column {
+    string spec;
+    int field;
+};
+
+struct Job {
+    string input;
+    vector<Column> columns;
+};
+
+// ---- parsing a log line ----
+static bool fieldValue(const vector<const char*>& fields, const Column& c, double& v) {
+    const char* s = nullptr;
+    if (c.field > 0) {
+        if (c.field <= (int)fields.size()) s = fields[c.field - 1];
+    } else {
+        for (size_t i = 0; i + 2 < fields.size(); i++) {
+            if (c.spec == fields[i] && strcmp(fields[i + 1], "=") == 0) {
+                s = fields[i + 2];
+                break;
+            }
+        }
+    }
+    if (s == nullptr) return false;
+    char* end;
+    v = strtod(s, &end);
+    return end != s && (*end == '\0' || *end == ';' || *end == ',');
+}
+
+static void split(char* line, vector<const char*>& fields) {
+    fields.clear();
+    for (char* p = line; *p; ) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (!*p) break;
+        fields.push_back(p);
+        while (*p && *p != ' ' && *p != '\t') p++;
+        if (*p) *p++ = '\0';
+    }
+}
+
+static string stem(const string& path) {
+    if (path == "-") return "stdin";
+    size_t slash = path.find_last_of('/');
+    string s = (slash == string::npos) ? path : path.substr(slash + 1);
+    size_t dot = s.find_last_of('.');
+    return (dot == string::npos || dot == 0) ? s : s.substr(0, dot);
+}
+
+static mutex reportLock;
+
+static void analyze(const Job& job, const Options& opt, const FFT& proto, const vector<double>& window) {
+    ifstream file;
+    istream* in = &cin;
+    if (job.input != "-") {
+        file.open(job.input);
+        if (!file) {
+            lock_guard<mutex> lock(reportLock);
+            cerr << "cannot read " << job.input << endl;
+            return;
+        }
+        in = &file;
+    }
+    FFT fft(proto);
+    vector<FILE*> psdFiles, stftFiles;
+    vector<Spectrum*> spectra;
+    string base = opt.outDir + "/" + stem(job.input) + "_";
+    for (const Column& c : job.columns) {
+        FILE* p = fopen((base + c.spec + "_psd.txt").c_str(), "w");
+        FILE* s = fopen((base + c.spec + "_stft.txt").c_str(), "w");
+        if (p == nullptr || s == nullptr) {
+            lock_guard<mutex> lock(reportLock);
+            cerr << "cannot write " << base << c.spec << "_*.txt" << endl;
+            if (p) fclose(p);
+            if (s) fclose(s);
+            for (size_t i = 0; i < spectra.size(); i++) {
+                delete spectra[i];
+                fclose(psdFiles[i]);
+                fclose(stftFiles[i]);
+            }
+            return;
+        }
+        psdFiles.push_back(p);
+        stftFiles.push_back(s);
+        spectra.push_back(new Spectrum(opt, &fft, &window, s));
+    }
+
+    string line;
+    vector<const char*> fields;
+    unsigned long bad = 0;
+    while (getline(*in, line)) {
+        if (line.find(opt.pattern) == string::npos) continue;
+        char* end;
+        unsigned long stamp = strtoul(line.c_str(), &end, 10);
+        if (end == line.c_str() || stamp < opt.skip) continue;
+        split(&line[0], fields);
+        for (size_t i = 0; i < job.columns.size(); i++) {
+            double v;
+            if (fieldValue(fields, job.columns[i], v)) spectra[i]->push(stamp, v);
+            else bad++;
+        }
+    }
+
+    for (size_t i = 0; i < spectra.size(); i++) {
+        double peak, f = spectra[i]->finish(psdFiles[i], peak);
+        fclose(psdFiles[i]);
+        fclose(stftFiles[i]);
+        lock_guard<mutex> lock(reportLock);
+        cout << job.input << " " << job.columns[i].spec << ": " << spectra[i]->getSamples() << " samples, ";
+        if (spectra[i]->getSegments() == 0) {
+            cout << "fewer than " << opt.n << " for a segment" << endl;
+        } else {
+            cout << spectra[i]->getSegments() << " segments at " << spectra[i]->getPeriod() * 1000.0
+                 << " ms, peak " << f << " Hz" << endl;
+        }
+        delete spectra[i];
+    }
+    if (bad > 0) {
+        lock_guard<mutex> lock(reportLock);
+        cerr << job.input << ": " << bad << " values missing or not a number" << endl;
+    }
+}
+
+// ---- command line ----
+static void usage_exit(const char* cmd) {
+    cerr << "Usage: " << cmd << " [-k columns] [-g pattern] [-s skip] [-N size] [-v overlap]"
+         << " [-w hamming|hann|rect] [-T period] [-D] [-n threads] [-o dir] [file...]" << endl;
+    exit(1);
+}
+
+int main(int argc, char* argv[]) {
+    Options opt = { 256, -1, "hamming", "Logger::outputLog", ".", 0.0, 100, true };
+    string columns = "6";
+    int threads = max(1u, thread::hardware_concurrency());
+    int c;
+    while ((c = getopt(argc, argv, "k:g:s:N:v:w:T:Dn:o:h")) != -1) {
+        switch (c) {
+        case 'k': columns = optarg; break;
+        case 'g': opt.pattern = optarg; break;
+        case 's': opt.skip = strtoul(optarg, nullptr, 10); break;
+        case 'N': opt.n = atoi(optarg); break;
+        case 'v': opt.overlap = atoi(optarg); break;
+        case 'w': opt.window = optarg; break;
+        case 'T': opt.period = atof(optarg); break;
+        case 'D': opt.detrend = false; break;
+        case 'n': threads = atoi(optarg); break;
+        case 'o': opt.outDir = optarg; break;
+        default: usage_exit(argv[0]);
+        }
+    }
+    if (opt.overlap < 0) opt.overlap = opt.n / 2;
+    if (opt.n < 4 || (opt.n & (opt.n - 1)) != 0 || opt.overlap >= opt.n || threads < 1 || opt.period < 0.0 ||
+        (opt.window != "hamming" && opt.window != "hann" && opt.window != "rect")) usage_exit(argv[0]);
+
+    /* symmetric windows as the FIR of app.cpp is designed with */
+    vector<double> window(opt.n, 1.0);
+    for (int i = 0; i < opt.n; i++) {
+        double c = cos(2.0 * M_PI * i / (opt.n - 1));
+        if (opt.window == "hamming") window[i] = 0.54 - 0.46 * c;
+        else if (opt.window == "hann") window[i] = 0.5 - 0.5 * c;
+    }
+
+    vector<Column> cols;
+    stringstream ss(columns);
+    string item;
+    while (getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        bool number = item.find_first_not_of("0123456789") == string::npos;
+        cols.push_back({ item, number ? atoi(item.c_str()) : 0 });
+    }
+    if (cols.empty()) usage_exit(argv[0]);
+
+    vector<Job> jobs;
+    if (optind == argc) jobs.push_back({ "-", cols });
+    for (int i = optind; i < argc; i++) {
+        if (strcmp(argv[i], "-") == 0) jobs.push_back({ "-", cols });
+        else for (const Column& col : cols) jobs.push_back({ argv[i], { col } });
+    }
+
+    FFT fft(opt.n);
+    atomic<int> next(0);
+    vector<thread> pool;
+    threads = min(threads, (int)jobs.size());
+    for (int w = 0; w < threads; w++) {
+        pool.emplace_back([&]() {
+            for (int j = next.fetch_add(1); j < (int)jobs.size(); j = next.fetch_add(1)) analyze(jobs[j], opt, fft, window);
+        });
+    }
+    for (auto& t : pool) t.join();
+    return 0;
+}
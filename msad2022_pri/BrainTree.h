@@ -7,6 +7,10 @@
 //           being executable on TOPPERS/EV3RT (HRP3) with Athrill
 // 3/30/2021 Modified by Wataru Taniguchi to make use of Blackboard
 // 4/28/2021 Modified by Wataru Taniguchi to correct the behavior of UntilSuccess and UntilFailure
+// 7/21/2022 Modified by MSAD Mode2P to let Leaf use the Blackboard set by the builders,
+//           so that every BehaviorTree has its own, cf. ParallelExecutor.hpp
+// 7/22/2022 Modified by MSAD Mode2P to carry a context of the robot from Builder through Blackboard,
+//           and to let nodes override setBlackboard() to cache it, cf. RobotContext.hpp
 
 #pragma once
 
@@ -71,7 +75,11 @@ public:
     }
     bool hasString(std::string key) const  { return strings.find(key) != strings.end(); }
 
+    void setContext(void* value) { context = value; }
+    void* getContext() const { return context; }
+
 protected:
+    void* context = nullptr;
     std::unordered_map<std::string, bool> bools;
     std::unordered_map<std::string, int> ints;
     std::unordered_map<std::string, float> floats;
@@ -91,7 +99,7 @@ public:
     };
 
     virtual ~Node() {}
-    void setBlackboard(Blackboard* board) {
+    virtual void setBlackboard(Blackboard* board) {
         blackboard = board;
     }
     Blackboard* getBlackboard() const { return blackboard; }
@@ -163,12 +171,9 @@ class Leaf : public Node
 public:
     Leaf() {}
     virtual ~Leaf() {}
-    Leaf(Blackboard* blackboard) : blackboard(blackboard) {}
+    Leaf(Blackboard* board) { blackboard = board; }
     
     virtual Status update() = 0;
-
-protected:
-    Blackboard* blackboard;
 };
 
 class BehaviorTree : public Node
@@ -283,8 +288,9 @@ private:
 class Builder
 {
 public:
-    Builder() {
+    Builder(void* context = nullptr) {
         tree = new BehaviorTree();
+        tree->getBlackboard()->setContext(context);
     }
 
     template <class NodeType, typename... Args>
@@ -0,0 +1,91 @@
+/*
+    CourseMap.cpp
+    course model as a table of sections and landmarks along the path
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "CourseMap.hpp"
+#include "Plotter.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+CourseMap::CourseMap() : numSections(0),numLandmarks(0) {}
+
+bool CourseMap::load(const char* filename) {
+    FILE* fp = fopen(filename, "r");
+    if (fp == NULL) {
+        return false;
+    }
+    numSections = numLandmarks = 0;
+    char buf[128];
+    while (fgets(buf, sizeof(buf), fp) != NULL) {
+        char* comma1 = strchr(buf, ',');
+        if (comma1 == NULL) continue;
+        *comma1 = '\0';
+        char* end;
+        long dist = strtol(comma1 + 1, &end, 10);
+        if (end == comma1 + 1) continue; /* not a number, e.g., header */
+        double curvature = (*end == ',') ? atof(end + 1) : 0.0;
+
+        if (strncmp(buf, "jb", 2) == 0) {
+            if (numLandmarks < COURSE_MAX_LANDMARKS) {
+                landmarks[numLandmarks++] = (int32_t)dist;
+            }
+        } else if (numSections < COURSE_MAX_SECTIONS) {
+            Section& sec = sections[numSections++];
+            size_t len = strlen(buf);
+            if (len >= sizeof(sec.id)) len = sizeof(sec.id) - 1;
+            memcpy(sec.id, buf, len);
+            sec.id[len] = '\0';
+            sec.sectionEnd = (int32_t)dist;
+            /* pwmL = forward * (1 - c/2), pwmR = forward * (1 + c/2) makes
+               the azimuth change by -c / WHEEL_TREAD per milimater */
+            sec.curvature = -curvature / WHEEL_TREAD;
+        }
+    }
+    fclose(fp);
+    return (numSections > 0);
+}
+
+int CourseMap::find(double dist) const {
+    if (numSections == 0) return -1;
+    /* find the first section whose end is beyond dist */
+    int lo = 0, hi = numSections - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (dist < sections[mid].sectionEnd) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+int CourseMap::seek(double dist, int& cursor) const {
+    if (cursor >= 0 && cursor < numSections) {
+        int32_t start = (cursor == 0) ? INT32_MIN : sections[cursor - 1].sectionEnd;
+        if (dist >= start) {
+            if (dist < sections[cursor].sectionEnd || cursor == numSections - 1) {
+                return cursor;
+            }
+            if (cursor + 1 < numSections && dist < sections[cursor + 1].sectionEnd) {
+                return ++cursor;
+            }
+        }
+    }
+    cursor = find(dist);
+    return cursor;
+}
+
+double CourseMap::getNearestLandmark(double dist) const {
+    if (numLandmarks == 0) return -1.0;
+    int32_t nearest = landmarks[0];
+    for (int i = 1; i < numLandmarks; i++) {
+        if (fabs(dist - landmarks[i]) < fabs(dist - nearest)) {
+            nearest = landmarks[i];
+        }
+    }
+    return nearest;
+}
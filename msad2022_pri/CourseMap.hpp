@@ -0,0 +1,88 @@
+/*
+    CourseMap.hpp
+    course model as a table of sections and landmarks along the path
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef CourseMap_hpp
+#define CourseMap_hpp
+
+#include <stdint.h>
+
+#define COURSE_MAX_SECTIONS     64
+#define COURSE_MAX_LANDMARKS    16
+#define COURSE_ID_LEN           8
+
+/*
+    The course file takes the same format as aflac2020/BlindRunner_prop.txt:
+
+        lable,distanceTo,curvature
+        st00,00868,0
+        cv01,01970,-0.4
+        jb01,02100,0
+
+    - each line gives the end of a section as the distance from the start in milimater
+      and the curvature in the BlindRunner sense, i.e., (pwmR - pwmL) / forward,
+      which is converted into radian per milimater assuming no slip
+    - lines labeled starting with "jb" are NOT sections but landmarks where a CL_JETBLACK line
+      crosses the course, given by the distance from the start
+    - lines not starting with a section label followed by a number, e.g., the header, are ignored
+*/
+class CourseMap {
+public:
+    CourseMap();
+    bool load(const char* filename);
+    inline int getNumSections() const;
+    inline int getNumLandmarks() const;
+    inline int32_t getLandmark(int i) const;
+    inline int32_t getLength() const;
+    inline int32_t getSectionEnd(int section) const;
+    inline double getCurvature(int section) const; /* in radian per milimater, clockwise positive */
+    inline const char* getId(int section) const;
+    /* index of the section containing dist by binary search */
+    int find(double dist) const;
+    /* same as find() but starting from cursor, which is updated;
+       effectively O(1) when dist moves forward little by little */
+    int seek(double dist, int& cursor) const;
+    /* distance of the landmark nearest to dist, or a negative value if no landmark */
+    double getNearestLandmark(double dist) const;
+protected:
+    struct Section {
+        char    id[COURSE_ID_LEN];
+        int32_t sectionEnd;
+        double  curvature;
+    };
+    Section sections[COURSE_MAX_SECTIONS];
+    int32_t landmarks[COURSE_MAX_LANDMARKS];
+    int numSections, numLandmarks;
+};
+
+inline int CourseMap::getNumSections() const {
+    return numSections;
+}
+
+inline int CourseMap::getNumLandmarks() const {
+    return numLandmarks;
+}
+
+inline int32_t CourseMap::getLandmark(int i) const {
+    return landmarks[i];
+}
+
+inline int32_t CourseMap::getLength() const {
+    return (numSections == 0) ? 0 : sections[numSections - 1].sectionEnd;
+}
+
+inline int32_t CourseMap::getSectionEnd(int section) const {
+    return sections[section].sectionEnd;
+}
+
+inline double CourseMap::getCurvature(int section) const {
+    return sections[section].curvature;
+}
+
+inline const char* CourseMap::getId(int section) const {
+    return sections[section].id;
+}
+
+#endif /* CourseMap_hpp */
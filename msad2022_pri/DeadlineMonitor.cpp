@@ -0,0 +1,52 @@
+/*
+    DeadlineMonitor.cpp
+    overrun detection of a periodic task and the policy against it
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "DeadlineMonitor.hpp"
+
+DeadlineMonitor::DeadlineMonitor(uint32_t p, OverrunPolicy op) : period(p),policy(op),aligned(false),
+pending(OVR_NONE),current(OVR_NONE),degraded(OVR_NONE),overruns(0),consecutive(0),activations(0),
+releaseTime(0),startTime(0),lastExecTime(0),maxExecTime(0) {}
+
+OverrunAction DeadlineMonitor::begin(uint32_t now) {
+    int32_t sinceRelease = (int32_t)(now - releaseTime);
+    if (!aligned || sinceRelease < 0) {
+        releaseTime = now;
+        aligned = true;
+    } else {
+        /* a queued activation starts late, after the release of the period it belongs to */
+        releaseTime += (uint32_t)sinceRelease / period * period;
+    }
+    startTime = now;
+    current = pending;
+    pending = OVR_NONE;
+    activations = activations + 1;
+    return current;
+}
+
+void DeadlineMonitor::end(uint32_t now) {
+    int32_t elapsed = (int32_t)(now - startTime);
+    if (elapsed < 0) {
+        /* the clock went backwards; neither measured nor counted */
+        aligned = false;
+        return;
+    }
+    lastExecTime = (uint32_t)elapsed;
+    if (lastExecTime > maxExecTime) maxExecTime = lastExecTime;
+    uint32_t missed = (now - releaseTime) / period;
+    if (missed == 0) {
+        if (current == OVR_NONE) {
+            /* ran as usual and ended in time */
+            consecutive = 0;
+            degraded = OVR_NONE;
+        }
+        return;
+    }
+    overruns = overruns + missed;
+    consecutive = consecutive + missed;
+    OverrunAction action = (policy == nullptr) ? OVR_NONE : policy(consecutive);
+    if (action > pending) pending = action;
+    if (action > degraded) degraded = action;
+}
@@ -0,0 +1,84 @@
+/*
+    DeadlineMonitor.hpp
+    overrun detection of a periodic task and the policy against it
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef DeadlineMonitor_hpp
+#define DeadlineMonitor_hpp
+
+#include <stdint.h>
+
+/* what the task does in the activation after overruns, in the escalating order */
+enum OverrunAction {
+    OVR_NONE,       /* as usual                                             */
+    OVR_SKIP_TICK,  /* skip the behavior tree but still drive the motors     */
+    OVR_SHED_LOG,   /* skip the tick and suppress logging                    */
+    OVR_SAFE_STOP,  /* stop the motors and end the run                       */
+};
+
+/* policy hook to decide the action by the number of overruns since the last activation
+   that ran as usual, i.e., with OVR_NONE, and ended in time */
+typedef OverrunAction (*OverrunPolicy)(uint32_t consecutive);
+
+/*
+    The task is activated by TNFY_ACTTSK of its cyclic handler as usual, and
+    begin() and end() are to be called at the top and the bottom of the task.
+    The kernel queues one activation that finds the task still running and drops the rest with E_QOVR,
+    so the overruns are told from the timestamps: an activation that ends past
+    the period after its release has missed as many deadlines as the periods elapsed.
+    The release is the latest point of the period grid, aligned to the first activation, at or before begin().
+    begin() returns the action the policy decided for this activation by the overruns of the previous ones,
+    e.g., to skip the work of the activation queued while the previous one overran, so as to catch up.
+    getDegraded() returns the most severe action decided since the overruns began,
+    latched until an activation runs as usual and ends in time, i.e., consecutive drops back to 0.
+    The timestamps are to be taken from a clock never reset while the task runs;
+    should it go backwards, the activation is not measured and the grid is aligned again.
+*/
+class DeadlineMonitor {
+public:
+    /* period of the cyclic handler in microsecond */
+    DeadlineMonitor(uint32_t period, OverrunPolicy p);
+    OverrunAction begin(uint32_t now);
+    void end(uint32_t now);
+    inline uint32_t getOverruns() const;
+    inline uint32_t getConsecutive() const;
+    inline OverrunAction getDegraded() const;
+    inline uint32_t getActivations() const;
+    /* execution time of the task in microsecond */
+    inline uint32_t getMaxExecTime() const;
+    inline uint32_t getLastExecTime() const;
+protected:
+    uint32_t period;
+    OverrunPolicy policy;
+    bool aligned;
+    OverrunAction pending, current, degraded;
+    uint32_t overruns, consecutive, activations;
+    uint32_t releaseTime, startTime, lastExecTime, maxExecTime;
+};
+
+inline uint32_t DeadlineMonitor::getOverruns() const {
+    return overruns;
+}
+
+inline uint32_t DeadlineMonitor::getConsecutive() const {
+    return consecutive;
+}
+
+inline OverrunAction DeadlineMonitor::getDegraded() const {
+    return degraded;
+}
+
+inline uint32_t DeadlineMonitor::getActivations() const {
+    return activations;
+}
+
+inline uint32_t DeadlineMonitor::getMaxExecTime() const {
+    return maxExecTime;
+}
+
+inline uint32_t DeadlineMonitor::getLastExecTime() const {
+    return lastExecTime;
+}
+
+#endif /* DeadlineMonitor_hpp */
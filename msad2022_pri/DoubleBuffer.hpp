@@ -0,0 +1,70 @@
+/*
+    DoubleBuffer.hpp
+    lock-free single-writer double buffer to exchange data between tasks
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef DoubleBuffer_hpp
+#define DoubleBuffer_hpp
+
+#include <stdint.h>
+
+#ifndef _compiler_barrier
+#define _compiler_barrier() __asm__ __volatile__("" ::: "memory")
+#endif
+
+/*
+    write() fills the slot NOT being published and then publishes it, so that
+    a reader copying the published slot is disturbed only when two writes
+    complete during its copy, in which case read() retries.
+    seq is odd while write() is filling a slot, and (seq >> 1) & 1 is the published slot.
+    Neither side ever blocks the other, whichever task has the higher priority:
+    - a writer in the higher priority task, e.g., the sensing snapshot from CTL_TSK,
+      makes a reader retry at most once per two writes;
+    - a reader in the higher priority task, e.g., the motor commands read by CTL_TSK,
+      never retries as the preempted writer is filling the other slot.
+    Only one task may write. T has to be copyable by assignment.
+*/
+template<typename T> class DoubleBuffer {
+public:
+    DoubleBuffer(const T& initial);
+    void write(const T& val);
+    void read(T& val) const;
+    /* number of write() so far */
+    inline uint32_t getWrites() const;
+protected:
+    T slot[2];
+    volatile uint32_t seq;
+};
+
+template<typename T>
+DoubleBuffer<T>::DoubleBuffer(const T& initial) : slot{initial, initial},seq(0) {}
+
+template<typename T>
+void DoubleBuffer<T>::write(const T& val) {
+    uint32_t s = seq;
+    seq = s + 1;
+    _compiler_barrier();
+    slot[((s >> 1) + 1) & 1] = val;
+    _compiler_barrier();
+    seq = s + 2;
+}
+
+template<typename T>
+void DoubleBuffer<T>::read(T& val) const {
+    uint32_t s;
+    do {
+        s = seq;
+        _compiler_barrier();
+        val = slot[(s >> 1) & 1];
+        _compiler_barrier();
+        /* the slot copied gets written again from seq = (s & ~1) + 3 */
+    } while (seq - (s & ~1U) > 2);
+}
+
+template<typename T>
+inline uint32_t DoubleBuffer<T>::getWrites() const {
+    return seq >> 1;
+}
+
+#endif /* DoubleBuffer_hpp */
@@ -0,0 +1,23 @@
+/*
+    FastMath.cpp
+    table-driven trigonometry for the soft-float target
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "FastMath.hpp"
+
+float   fm_sin_table[FM_TABLE_SIZE + 1];
+int16_t fm_sin_table_q14[FM_TABLE_SIZE + 1];
+
+void fm_init() {
+    for (int i = 0; i <= FM_TABLE_SIZE; i++) {
+        double s = sin(2.0 * M_PI * i / FM_TABLE_SIZE);
+        fm_sin_table[i] = (float)s;
+        fm_sin_table_q14[i] = (int16_t)lround(s * FM_Q14_ONE);
+    }
+}
+
+/* fill the tables before any task runs */
+static struct FastMathInitializer {
+    FastMathInitializer() { fm_init(); }
+} fastMathInitializer;
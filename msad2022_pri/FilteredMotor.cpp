@@ -4,19 +4,53 @@
     Copyright © 2021 MS Mode 2. All rights reserved.
 */
 #include "FilteredMotor.hpp"
+#include <assert.h>
 
-FilteredMotor::FilteredMotor(ePortM port) : Motor(port, true, MEDIUM_MOTOR),fil(nullptr) {}
+FilteredMotor::FilteredMotor(ePortM port) : Motor(port, true, MEDIUM_MOTOR),fil(nullptr),mdl(nullptr),spd(nullptr),
+cmd({0, 0.0, 0.0, false}),commands(cmd),velocityMode(false),filtered_pwm(0) {}
 
-void FilteredMotor::setPWMFilter(Filter *filter) {
+void FilteredMotor::setPWMFilter(SRLF *filter) {
     fil = filter;
 }
 
+void FilteredMotor::setMotorModel(MotorModel *model) {
+    mdl = model;
+}
+
+void FilteredMotor::setSpeedController(SpeedController *controller) {
+    spd = controller;
+}
+
+void FilteredMotor::setSpeed(double mmps) {
+    assert(spd != nullptr);
+    cmd.mmps = mmps;
+    cmd.velocity = true;
+    commands.write(cmd);
+}
+
 void FilteredMotor::drive() {
-    /* process pwm by the Filter */
-    if (fil == nullptr) {
-        filtered_pwm = original_pwm;
+    drive((mdl == nullptr && !cmd.velocity) ? 0 : getCount());
+}
+
+void FilteredMotor::drive(int32_t count) {
+    MotorCommand c;
+    commands.read(c);
+    /* process pwm by the Filter, or obtain pwm from the speed controller */
+    if (c.velocity) {
+        if (!velocityMode) spd->reset();
+        spd->setTarget(c.mmps);
+        filtered_pwm = (int)spd->update(count);
+    } else if (fil == nullptr) {
+        filtered_pwm = c.pwm;
+    } else {
+        fil->setRate(c.srewRate);
+        filtered_pwm = fil->apply(c.pwm);
+    }
+    velocityMode = c.velocity;
+    /* then compensate the motor */
+    if (mdl == nullptr) {
+        ev3api::Motor::setPWM(filtered_pwm);
     } else {
-        filtered_pwm = fil->apply(original_pwm);
+        ev3api::Motor::setPWM((int)mdl->apply(filtered_pwm, count));
     }
-    ev3api::Motor::setPWM(filtered_pwm);
 }
\ No newline at end of file
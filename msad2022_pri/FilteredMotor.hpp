@@ -7,18 +7,50 @@
 #define FilteredMotor_hpp
 
 #include "Motor.h"
-#include "Filter.hpp"
+#include "SRLF.hpp"
+#include "MotorModel.hpp"
+#include "SpeedController.hpp"
+#include "DoubleBuffer.hpp"
+
+/* what the behavior tree instructs the motor to do */
+struct MotorCommand {
+    int pwm;
+    double srewRate;
+    double mmps;
+    bool velocity;
+};
 
 class FilteredMotor : public ev3api::Motor {
 public:
     FilteredMotor(ePortM port);
     inline int getPWM() const;
     inline void setPWM(int pwm);
-    void setPWMFilter(Filter *filter);
+    /* the srew rate goes to the SRLF along with the pwm of the next setPWM() */
+    inline void setSrewRate(double rate);
+    void setPWMFilter(SRLF *filter);
+    /* velocity mode: setSpeed() requests mm/s tracked by the controller every drive(),
+       bypassing the Filter, until setPWM() returns to pwm mode;
+       getPWM() returns the pwm output by the controller meanwhile */
+    void setSpeedController(SpeedController *controller);
+    void setSpeed(double mmps);
+    inline bool isVelocityMode() const;
+    /* the model applies after the Filter; getPWM() still returns the pwm before the model */
+    void setMotorModel(MotorModel *model);
+    /* the setters above and drive() may run in different tasks, e.g., UPD_TSK and CTL_TSK
+       under MULTI_RATE, as the setters pass MotorCommand to drive() through DoubleBuffer;
+       the SRLF, the model and the controller are touched by drive() only once set up,
+       the srew rate included, so that no other task is to call SRLF::setRate() */
     void drive();
+    /* count is the encoder reading of this tick, e.g., by SensorSnapshot */
+    void drive(int32_t count);
 protected:
-    Filter *fil;
-    int original_pwm, filtered_pwm;
+    SRLF *fil;
+    MotorModel *mdl;
+    SpeedController *spd;
+    MotorCommand cmd;
+    DoubleBuffer<MotorCommand> commands;
+    bool velocityMode; /* as of the latest drive() */
+    int filtered_pwm;
 };
 
 inline int FilteredMotor::getPWM() const {
@@ -26,7 +58,17 @@ inline int FilteredMotor::getPWM() const {
 }
 
 inline void FilteredMotor::setPWM(int pwm) {
-    original_pwm = pwm;
+    cmd.pwm = pwm;
+    cmd.velocity = false;
+    commands.write(cmd);
+}
+
+inline void FilteredMotor::setSrewRate(double rate) {
+    cmd.srewRate = rate;
+}
+
+inline bool FilteredMotor::isVelocityMode() const {
+    return cmd.velocity;
 }
 
 #endif /* FilteredMotor_hpp */
\ No newline at end of file
@@ -0,0 +1,50 @@
+/*
+    FixedPoint.hpp
+    Q16.16 fixed-point number for the soft-float target
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef FixedPoint_hpp
+#define FixedPoint_hpp
+
+#include <stdint.h>
+
+/*
+    A drop-in replacement of float in arithmetic templates such as PIDcontroller.
+    The range is [-32768, 32768) with the resolution of 1/65536.
+    Multiplication and division go through int64_t and never overflow in between,
+    but the result saturates silently only in the sense of two's complement wrap-around,
+    so keep gains and signals within the range.
+*/
+class Q16 {
+public:
+    Q16() : raw(0) {}
+    Q16(int v) : raw((int32_t)v << 16) {}
+    Q16(double v) : raw((int32_t)(v * 65536.0 + (v >= 0.0 ? 0.5 : -0.5))) {}
+    static inline Q16 fromRaw(int32_t r) { Q16 q; q.raw = r; return q; }
+    inline int32_t getRaw() const { return raw; }
+    inline int toInt() const { return (raw >= 0) ? (raw >> 16) : -((-raw) >> 16); } /* toward zero like a cast */
+    inline float toFloat() const { return raw / 65536.0F; }
+    explicit operator int() const { return toInt(); }
+    explicit operator float() const { return toFloat(); }
+    explicit operator double() const { return raw / 65536.0; }
+
+    inline Q16 operator-() const { return fromRaw(-raw); }
+    inline Q16 operator+(Q16 b) const { return fromRaw(raw + b.raw); }
+    inline Q16 operator-(Q16 b) const { return fromRaw(raw - b.raw); }
+    inline Q16 operator*(Q16 b) const { return fromRaw((int32_t)(((int64_t)raw * b.raw) >> 16)); }
+    inline Q16 operator/(Q16 b) const { return fromRaw((int32_t)(((int64_t)raw << 16) / b.raw)); }
+    inline Q16& operator+=(Q16 b) { raw += b.raw; return *this; }
+    inline Q16& operator-=(Q16 b) { raw -= b.raw; return *this; }
+    inline Q16& operator*=(Q16 b) { return *this = *this * b; }
+    inline bool operator< (Q16 b) const { return raw <  b.raw; }
+    inline bool operator> (Q16 b) const { return raw >  b.raw; }
+    inline bool operator<=(Q16 b) const { return raw <= b.raw; }
+    inline bool operator>=(Q16 b) const { return raw >= b.raw; }
+    inline bool operator==(Q16 b) const { return raw == b.raw; }
+    inline bool operator!=(Q16 b) const { return raw != b.raw; }
+protected:
+    int32_t raw;
+};
+
+#endif /* FixedPoint_hpp */
@@ -0,0 +1,116 @@
+/*
+    GainSchedule.cpp
+    PID gains interpolated by speed and curvature
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "GainSchedule.hpp"
+#include <stdio.h>
+#include <ctype.h>
+
+GainSchedule::GainSchedule(double p, double i, double d) : numSpeeds(1),numCurvatures(1) {
+    speeds[0] = curvatures[0] = 0.0;
+    gains[0][0][0] = p;
+    gains[0][0][1] = i;
+    gains[0][0][2] = d;
+}
+
+/* index of x in the sorted axis, inserting it if absent; -1 when the axis is full */
+int GainSchedule::insert(double axis[], int& n, int max, double x) {
+    int k = 0;
+    while (k < n && axis[k] < x) k++;
+    if (k < n && axis[k] == x) return k;
+    if (n == max) return -1;
+    for (int j = n; j > k; j--) axis[j] = axis[j-1];
+    axis[k] = x;
+    n++;
+    return k;
+}
+
+/* a row of speed,curvature,p,i,d; false for the header, comments and broken lines */
+static bool parseRow(const char* buf, double v[5]) {
+    if (!isdigit((unsigned char)buf[0]) && buf[0] != '.') return false;
+    return sscanf(buf, "%lf,%lf,%lf,%lf,%lf", &v[0], &v[1], &v[2], &v[3], &v[4]) == 5;
+}
+
+/* the grid being loaded; static rather than on the stack of main_task, which is only STACK_SIZE,
+   as load() is called once at start and is not reentrant */
+static double scratch[SCH_MAX_SPEEDS][SCH_MAX_CURVATURES][3];
+static bool filled[SCH_MAX_SPEEDS][SCH_MAX_CURVATURES];
+
+bool GainSchedule::load(const char* filename) {
+    FILE* fp = fopen(filename, "r");
+    if (fp == NULL) {
+        return false;
+    }
+    /* build the axes in the first pass, then fill the grid in the second */
+    double s[SCH_MAX_SPEEDS], c[SCH_MAX_CURVATURES], v[5];
+    int ns = 0, nc = 0, numRows = 0;
+    char buf[128];
+    bool valid = true;
+    while (valid && fgets(buf, sizeof(buf), fp) != NULL) {
+        if (!parseRow(buf, v)) continue;
+        valid = insert(s, ns, SCH_MAX_SPEEDS, v[0]) >= 0 && insert(c, nc, SCH_MAX_CURVATURES, v[1]) >= 0;
+        numRows++;
+    }
+    valid = valid && numRows == ns * nc && numRows > 0; /* incomplete grid or duplicates */
+    for (int is = 0; is < ns; is++) {
+        for (int ic = 0; ic < nc; ic++) filled[is][ic] = false;
+    }
+    rewind(fp);
+    while (valid && fgets(buf, sizeof(buf), fp) != NULL) {
+        if (!parseRow(buf, v)) continue;
+        int is = insert(s, ns, SCH_MAX_SPEEDS, v[0]);
+        int ic = insert(c, nc, SCH_MAX_CURVATURES, v[1]);
+        valid = !filled[is][ic];
+        filled[is][ic] = true;
+        for (int k = 0; k < 3; k++) scratch[is][ic][k] = v[2 + k];
+    }
+    fclose(fp);
+    if (!valid) return false;
+
+    /* commit only a valid schedule */
+    numSpeeds = ns;
+    numCurvatures = nc;
+    for (int is = 0; is < ns; is++) {
+        speeds[is] = s[is];
+        for (int ic = 0; ic < nc; ic++) {
+            for (int k = 0; k < 3; k++) gains[is][ic][k] = scratch[is][ic][k];
+        }
+    }
+    for (int ic = 0; ic < nc; ic++) curvatures[ic] = c[ic];
+    return true;
+}
+
+/* index of the lower grid point and the ratio toward the upper one, clamped at the edges */
+int GainSchedule::locate(const double axis[], int n, double x, double& r) {
+    if (n == 1 || x <= axis[0]) {
+        r = 0.0;
+        return 0;
+    }
+    if (x >= axis[n-1]) {
+        r = 1.0;
+        return n - 2;
+    }
+    int k = 0;
+    while (x >= axis[k+1]) k++;
+    r = (x - axis[k]) / (axis[k+1] - axis[k]);
+    return k;
+}
+
+void GainSchedule::lookup(double speed, double curvature, double& p, double& i, double& d) const {
+    double rs, rc;
+    int is = locate(speeds, numSpeeds, speed, rs);
+    int ic = locate(curvatures, numCurvatures, curvature, rc);
+    int is1 = (numSpeeds == 1) ? is : is + 1;
+    int ic1 = (numCurvatures == 1) ? ic : ic + 1;
+    double out[3];
+    for (int k = 0; k < 3; k++) {
+        double lo = gains[is][ic][k]  + rc * (gains[is][ic1][k]  - gains[is][ic][k]);
+        double hi = gains[is1][ic][k] + rc * (gains[is1][ic1][k] - gains[is1][ic][k]);
+        out[k] = lo + rs * (hi - lo);
+    }
+    p = out[0];
+    i = out[1];
+    d = out[2];
+}
@@ -0,0 +1,42 @@
+/*
+    GainSchedule.hpp
+    PID gains interpolated by speed and curvature
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef GainSchedule_hpp
+#define GainSchedule_hpp
+
+#define SCH_MAX_SPEEDS      8
+#define SCH_MAX_CURVATURES  8
+
+/*
+    The schedule file lists PID gains at grid points of speed and curvature:
+
+        speed,curvature,p,i,d
+        45,0.0,0.75,0.39,0.08
+        45,2.5,0.90,0.39,0.10
+        60,0.0,0.60,0.30,0.08
+        60,2.5,0.80,0.30,0.12
+
+    - speed is the commanded forward pwm as given to TraceLine
+    - curvature is the absolute curvature in 1/m, i.e., 1000 / radius in milimater
+    - every combination of the speeds and the curvatures listed has to be given
+    - lines starting with a non-numeric character, e.g., the header, are ignored
+    lookup() interpolates bilinearly and clamps at the edges of the grid.
+*/
+class GainSchedule {
+public:
+    /* a flat schedule giving the same gains anywhere */
+    GainSchedule(double p, double i, double d);
+    bool load(const char* filename);
+    void lookup(double speed, double curvature, double& p, double& i, double& d) const;
+protected:
+    double speeds[SCH_MAX_SPEEDS], curvatures[SCH_MAX_CURVATURES];
+    double gains[SCH_MAX_SPEEDS][SCH_MAX_CURVATURES][3];
+    int numSpeeds, numCurvatures;
+    static int locate(const double axis[], int n, double x, double& r);
+    static int insert(double axis[], int& n, int max, double x);
+};
+
+#endif /* GainSchedule_hpp */
@@ -0,0 +1,131 @@
+/*
+    LineMPC.cpp
+    model predictive line tracing over a fixed horizon
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "LineMPC.hpp"
+
+LineMPC::LineMPC(double v_, double b_, double a, int32_t t, double u, double y, double psi, double r_, double rd_) :
+b(b_),ahead(a),dt(t / 1000000.0),umax(u),qy(y),qpsi(psi),r(r_),rd(rd_) {
+    setSpeed(v_);
+    reset();
+}
+
+void LineMPC::reset() {
+    estY = estPsi = uPrev = 0.0;
+    for (int i = 0; i < MPC_HORIZON; i++) U[i] = 0.0;
+    for (int i = 0; i <= MPC_SENSOR_DELAY; i++) pastU[i] = pastW[i] = 0.0;
+    iterations = 0;
+    first = true;
+}
+
+void LineMPC::setSpeed(double v_) {
+    v = v_;
+    /* the effect of u_i on the state j steps later is A^(j-1-i) * B,
+       where A^k = [[1, k * dt * v], [0, 1]] and B = [ahead * dt * b, dt * b] */
+    double gy[MPC_HORIZON], gpsi = dt * b;
+    for (int k = 0; k < MPC_HORIZON; k++) {
+        gy[k] = dt * b * (ahead + k * dt * v);
+    }
+    for (int i = 0; i < MPC_HORIZON; i++) {
+        for (int k = i; k < MPC_HORIZON; k++) {
+            double h = 0.0;
+            for (int j = k + 1; j <= MPC_HORIZON; j++) {
+                h += qy * gy[j-1-i] * gy[j-1-k] + qpsi * gpsi * gpsi;
+            }
+            H[i][k] = H[k][i] = h;
+        }
+        /* input and input-rate penalties */
+        H[i][i] += r + rd * ((i == MPC_HORIZON - 1) ? 1.0 : 2.0);
+        if (i > 0) {
+            H[i][i-1] -= rd;
+            H[i-1][i] -= rd;
+        }
+        /* the gradient is linear in y, psi and v * curvature of the initial state */
+        gx[i][0] = gx[i][1] = gx[i][2] = 0.0;
+        for (int j = i + 1; j <= MPC_HORIZON; j++) {
+            double wy = -dt * (j * ahead + dt * v * j * (j - 1) / 2.0), wpsi = -j * dt;
+            gx[i][0] += qy * gy[j-1-i];
+            gx[i][1] += qy * gy[j-1-i] * j * dt * v + qpsi * gpsi;
+            gx[i][2] += qy * gy[j-1-i] * wy + qpsi * gpsi * wpsi;
+        }
+    }
+    /* observer gains placing both poles of the estimation error at MPC_OBSERVER_POLE */
+    double l1 = 2.0 - 2.0 * MPC_OBSERVER_POLE;
+    double l2 = (v > 0.0) ? (MPC_OBSERVER_POLE * MPC_OBSERVER_POLE - 1.0 + l1) / (dt * v) : 0.0;
+    lY = l1 - dt * v * l2;
+    lPsi = l2;
+}
+
+double LineMPC::compute(double y, double curvature) {
+    double w = v * curvature;
+    if (first) {
+        estY = y;
+        estPsi = 0.0;
+        first = false;
+    } else {
+        double innovation = y - estY;
+        estY += lY * innovation;
+        estPsi += lPsi * innovation;
+    }
+    /* the current state from the delayed one and the inputs since */
+    double y0 = estY, psi0 = estPsi;
+    for (int i = 0; i < MPC_SENSOR_DELAY; i++) {
+        double yawRate = b * pastU[i] - pastW[i];
+        y0 += dt * v * psi0 + ahead * dt * yawRate;
+        psi0 += dt * yawRate;
+    }
+
+    /* warm start by the previous solution shifted by one step */
+    for (int i = 0; i < MPC_HORIZON - 1; i++) U[i] = U[i+1];
+
+    double grad[MPC_HORIZON];
+    for (int i = 0; i < MPC_HORIZON; i++) {
+        grad[i] = gx[i][0] * y0 + gx[i][1] * psi0 + gx[i][2] * w;
+    }
+    grad[0] -= rd * uPrev;
+    for (int i = 0; i < MPC_HORIZON; i++) {
+        for (int k = 0; k < MPC_HORIZON; k++) grad[i] += H[i][k] * U[k];
+    }
+
+    /* projected coordinate descent on the box-constrained QP */
+    for (iterations = 1; iterations <= MPC_MAX_SWEEPS; iterations++) {
+        double maxStep = 0.0;
+        for (int i = 0; i < MPC_HORIZON; i++) {
+            double u = U[i] - grad[i] / H[i][i];
+            if (u > umax) u = umax;
+            if (u < -umax) u = -umax;
+            double step = u - U[i];
+            if (step != 0.0) {
+                U[i] = u;
+                for (int k = 0; k < MPC_HORIZON; k++) grad[k] += H[k][i] * step;
+                if (step > maxStep) maxStep = step;
+                if (-step > maxStep) maxStep = -step;
+            }
+        }
+        if (maxStep < MPC_TOLERANCE) break;
+    }
+    if (iterations > MPC_MAX_SWEEPS) iterations = MPC_MAX_SWEEPS;
+
+    uPrev = U[0];
+    /* predict the delayed state at the next compute() by the oldest input */
+    pastU[MPC_SENSOR_DELAY] = uPrev;
+    pastW[MPC_SENSOR_DELAY] = w;
+    double yawRate = b * pastU[0] - pastW[0];
+    estY += dt * v * estPsi + ahead * dt * yawRate;
+    estPsi += dt * yawRate;
+    for (int i = 0; i < MPC_SENSOR_DELAY; i++) {
+        pastU[i] = pastU[i+1];
+        pastW[i] = pastW[i+1];
+    }
+    return uPrev;
+}
+
+int LineMPC::getIterations() {
+    return iterations;
+}
+
+double LineMPC::getHeading() {
+    return estPsi;
+}
@@ -0,0 +1,62 @@
+/*
+    LineMPC.hpp
+    model predictive line tracing over a fixed horizon
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef LineMPC_hpp
+#define LineMPC_hpp
+
+#include <stdint.h>
+
+#ifndef MPC_HORIZON
+#define MPC_HORIZON         15
+#endif
+#define MPC_MAX_SWEEPS      30      /* cap of the solver iterations per compute() */
+#define MPC_TOLERANCE       1.0e-3  /* pwm; the solver stops when no input moves more */
+#define MPC_OBSERVER_POLE   0.6     /* double pole of the heading observer */
+#ifndef MPC_SENSOR_DELAY
+#define MPC_SENSOR_DELAY    2       /* samples, i.e., the group delay of FIR_ORDER 4 in FilteredColorSensor */
+#endif
+
+/*
+    The state is x = (y, psi), where y is the lateral offset in milimeter of the color sensor
+    to the left of the edge and psi is the heading in radian relative to the line.
+    The sensor sits ahead milimeter in front of the axle, and the input u is the turn pwm
+    as in TraceLine, i.e., the yaw rate is b * u. With the line curvature k in 1/mm,
+        psi' = b * u - v * k
+        y'   = v * psi + ahead * psi'
+    discretized by Euler at the control period.
+    Every compute() minimizes over the horizon
+        sum qy * y^2 + qpsi * psi^2 + r * u^2 + rd * (u - u_prev)^2,  |u| <= umax
+    as a dense box-constrained QP in u, by projected coordinate descent warm-started
+    with the previous solution shifted by one step. Only y is measured; psi is estimated
+    by an observer with MPC_OBSERVER_POLE. As the measurement lags MPC_SENSOR_DELAY samples,
+    the observer estimates the delayed state, which is then propagated by the inputs since. The QP Hessian depends only on the speed,
+    so it is rebuilt by setSpeed() and not every tick.
+*/
+class LineMPC {
+public:
+    LineMPC(double v, double b, double ahead, int32_t t_us, double umax, double qy, double qpsi, double r, double rd);
+    /* v in mm/s */
+    void setSpeed(double v);
+    /* y is the measured offset in milimeter; curvature in 1/mm is the known curvature ahead if any */
+    double compute(double y, double curvature = 0.0);
+    /* solver iterations spent by the last compute() */
+    int getIterations();
+    /* estimated heading in radian relative to the line, MPC_SENSOR_DELAY samples old */
+    double getHeading();
+    void reset();
+protected:
+    double v, b, ahead, dt, umax, qy, qpsi, r, rd;
+    double lY, lPsi;                /* observer gains */
+    double estY, estPsi, uPrev;     /* estY and estPsi are MPC_SENSOR_DELAY samples old */
+    double pastU[MPC_SENSOR_DELAY+1], pastW[MPC_SENSOR_DELAY+1];
+    double gx[MPC_HORIZON][3];      /* terms for y, psi and curvature * v of the gradient */
+    double H[MPC_HORIZON][MPC_HORIZON];
+    double U[MPC_HORIZON];
+    int iterations;
+    bool first;
+};
+
+#endif /* LineMPC_hpp */
@@ -0,0 +1,123 @@
+/*
+    Localizer.cpp
+    map-matching localization along the course by a particle filter
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "Localizer.hpp"
+
+Localizer::Localizer(Plotter* p, const CourseMap* map) : plotter(p),courseMap(map),seed(2463534242U) {
+    reset();
+}
+
+void Localizer::reset() {
+    Pose pose;
+    plotter->getPoseAt(plotter->getTime(), pose);
+    prevDist = measDist = estimate = pose.distance;
+    measTheta = pose.theta;
+    prevLandmark = false;
+    for (int i = 0; i < LOC_NUM_PARTICLES; i++) {
+        particles[i] = pose.distance;
+        scales[i] = 1.0F + LOC_SLIP_RATIO * noise();
+        weights[i] = 1.0F / LOC_NUM_PARTICLES;
+    }
+    plotter->setDistanceOffset(0);
+}
+
+/* approximately normal distribution by the sum of three uniform ones in [-1, 1) */
+float Localizer::noise() {
+    float sum = 0.0F;
+    for (int i = 0; i < 3; i++) {
+        /* xorshift32 */
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        sum += (float)(seed >> 8) / (1 << 23) - 1.0F;
+    }
+    return sum;
+}
+
+void Localizer::normalize() {
+    float sum = 0.0F;
+    for (int i = 0; i < LOC_NUM_PARTICLES; i++) sum += weights[i];
+    if (sum <= 0.0F) { /* all hypotheses rejected, start over uniformly */
+        for (int i = 0; i < LOC_NUM_PARTICLES; i++) weights[i] = 1.0F / LOC_NUM_PARTICLES;
+        return;
+    }
+    float sumSq = 0.0F;
+    for (int i = 0; i < LOC_NUM_PARTICLES; i++) {
+        weights[i] /= sum;
+        sumSq += weights[i] * weights[i];
+    }
+    /* resample when the effective number of particles falls below the half */
+    if (sumSq * LOC_NUM_PARTICLES > 2.0F) {
+        resample();
+    }
+}
+
+/* systematic resampling */
+void Localizer::resample() {
+    float step = 1.0F / LOC_NUM_PARTICLES;
+    float u = (noise() / 6.0F + 0.5F) * step;
+    float cum = weights[0];
+    int j = 0;
+    for (int i = 0; i < LOC_NUM_PARTICLES; i++) {
+        while (u > cum && j < LOC_NUM_PARTICLES - 1) {
+            cum += weights[++j];
+        }
+        resampled[i] = particles[j];
+        resampledScales[i] = scales[j];
+        u += step;
+    }
+    for (int i = 0; i < LOC_NUM_PARTICLES; i++) {
+        particles[i] = resampled[i];
+        /* keep the scale diverse, otherwise it freezes after a few resamplings */
+        scales[i] = resampledScales[i] + LOC_WALK_RATIO * noise();
+        weights[i] = step;
+    }
+}
+
+void Localizer::update(bool onLandmark) {
+    Pose pose;
+    plotter->getPoseAt(plotter->getTime(), pose);
+
+    /* motion update */
+    float delta = pose.distance - prevDist;
+    prevDist = pose.distance;
+    if (delta != 0.0F) {
+        float sigma = LOC_WALK_RATIO * fabs(delta);
+        for (int i = 0; i < LOC_NUM_PARTICLES; i++) {
+            particles[i] += delta * scales[i] + sigma * noise();
+        }
+    }
+
+    /* match the curvature measured over the last interval */
+    double interval = pose.distance - measDist;
+    if (fabs(interval) >= LOC_MEAS_INTERVAL) {
+        double measured = (pose.theta - measTheta) / interval;
+        for (int i = 0; i < LOC_NUM_PARTICLES; i++) {
+            int section = courseMap->find(particles[i] - interval / 2.0);
+            double err = (measured - courseMap->getCurvature(section)) / LOC_CURV_SIGMA;
+            weights[i] *= exp(-0.5 * err * err);
+        }
+        normalize();
+        measDist = pose.distance;
+        measTheta = pose.theta;
+    }
+
+    /* match the landmark on its rising edge */
+    if (onLandmark && !prevLandmark && courseMap->getNumLandmarks() > 0) {
+        for (int i = 0; i < LOC_NUM_PARTICLES; i++) {
+            double err = (particles[i] - courseMap->getNearestLandmark(particles[i])) / LOC_LANDMARK_SIGMA;
+            weights[i] *= LOC_LANDMARK_FLOOR + exp(-0.5 * err * err);
+        }
+        normalize();
+    }
+    prevLandmark = onLandmark;
+
+    /* hand the estimate to Plotter */
+    double sum = 0.0;
+    for (int i = 0; i < LOC_NUM_PARTICLES; i++) sum += weights[i] * particles[i];
+    estimate = sum;
+    plotter->setDistanceOffset((int32_t)(estimate - pose.distance));
+}
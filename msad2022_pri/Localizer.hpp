@@ -0,0 +1,60 @@
+/*
+    Localizer.hpp
+    map-matching localization along the course by a particle filter
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef Localizer_hpp
+#define Localizer_hpp
+
+#include "Plotter.hpp"
+#include "CourseMap.hpp"
+
+#define LOC_NUM_PARTICLES   64      /* size of the fixed particle pool                     */
+#define LOC_SLIP_RATIO      0.05    /* 1-sigma of odometry scale error, e.g., due to slip   */
+#define LOC_WALK_RATIO      0.01    /* 1-sigma of random walk relative to distance         */
+#define LOC_MEAS_INTERVAL   50.0    /* distance in milimater between curvature matchings   */
+#define LOC_CURV_SIGMA      0.002   /* 1-sigma of measured curvature in radian/milimater   */
+#define LOC_LANDMARK_SIGMA  30.0    /* 1-sigma of landmark detection in milimater          */
+#define LOC_LANDMARK_FLOOR  0.05    /* likelihood of a detection far from any landmark     */
+
+/*
+    Each particle is a hypothesis of the distance along the course
+    together with the scale between odometry and the actual travel, e.g., 0.95 for 5% slip.
+    - motion:      every particle moves by the odometry delta times its scale plus random walk
+    - curvature:   every LOC_MEAS_INTERVAL, the curvature measured by Plotter is compared
+                   with that of the course section at each particle
+    - landmark:    on the rising edge of a landmark detection, e.g., CL_JETBLACK,
+                   particles near a landmark in the course map are favored
+    The estimate is handed to Plotter as the offset to its accumulated distance.
+    The cost per update() is O(LOC_NUM_PARTICLES), with O(LOC_NUM_PARTICLES log n) on matchings.
+*/
+class Localizer {
+public:
+    Localizer(Plotter* p, const CourseMap* map);
+    void reset();
+    void update(bool onLandmark);
+    inline int32_t getDistance() const;
+    inline int32_t getCorrection() const;
+protected:
+    Plotter* plotter;
+    const CourseMap* courseMap;
+    float particles[LOC_NUM_PARTICLES], scales[LOC_NUM_PARTICLES], weights[LOC_NUM_PARTICLES];
+    float resampled[LOC_NUM_PARTICLES], resampledScales[LOC_NUM_PARTICLES];
+    double prevDist, measDist, measTheta, estimate;
+    bool prevLandmark;
+    uint32_t seed;
+    float noise();
+    void normalize();
+    void resample();
+};
+
+inline int32_t Localizer::getDistance() const {
+    return (int32_t)estimate;
+}
+
+inline int32_t Localizer::getCorrection() const {
+    return (int32_t)(estimate - prevDist);
+}
+
+#endif /* Localizer_hpp */
@@ -0,0 +1,45 @@
+/*
+    MotorModel.cpp
+    compensation of motor nonlinearity between FilteredMotor and the motor
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "MotorModel.hpp"
+
+MotorModel::MotorModel(double d, int32_t b, double bp, int n) :
+deadband(d),backlashPWM(bp),backlash(b),reversalCount(0),nominal(n),battery(n),direction(0),inSlack(false) {}
+
+double MotorModel::apply(double pwm, int32_t count) {
+    if (pwm == 0.0) {
+        return 0.0;
+    }
+    int dir = (pwm > 0.0) ? 1 : -1;
+    double mag = (pwm > 0.0) ? pwm : -pwm;
+
+    /* deadband inversion at the nominal voltage */
+    mag = deadband + mag * (100.0 - deadband) / 100.0;
+    /* backlash compensation */
+    if (dir != direction) {
+        if (direction != 0) {
+            inSlack = true;
+            reversalCount = count;
+        }
+        direction = dir;
+    }
+    if (inSlack) {
+        int32_t moved = count - reversalCount;
+        if (moved < 0) moved = -moved;
+        if (moved >= backlash) {
+            inSlack = false;
+        } else if (mag < backlashPWM) {
+            mag = backlashPWM;
+        }
+    }
+
+    /* battery normalization */
+    if (battery > 0) {
+        mag = mag * nominal / battery;
+    }
+    if (mag > 100.0) mag = 100.0;
+    return dir * mag;
+}
@@ -0,0 +1,40 @@
+/*
+    MotorModel.hpp
+    compensation of motor nonlinearity between FilteredMotor and the motor
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef MotorModel_hpp
+#define MotorModel_hpp
+
+#include <stdint.h>
+
+/*
+    apply() converts the pwm intended for a linear motor at the nominal battery voltage
+    into the pwm to give to the actual motor, in the following order:
+    - deadband inversion maps |pwm| in (0, 100] onto (deadband, 100],
+      so that a small pwm still overcomes the static friction
+    - backlash compensation, on reversal of the commanded direction, keeps |pwm| at least
+      backlash_pwm until the encoder has moved backlash degrees, i.e., across the gear slack
+    - battery normalization scales pwm by nominal_mV / battery voltage given by setBattery(),
+      as deadband and backlash_pwm are given at the nominal voltage
+    The result is limited to [-100, 100]; pwm 0 stays 0 so that the motor stops.
+*/
+class MotorModel {
+public:
+    MotorModel(double deadband, int32_t backlash, double backlash_pwm, int nominal_mV);
+    inline void setBattery(int mV);
+    double apply(double pwm, int32_t count);
+protected:
+    double deadband, backlashPWM;
+    int32_t backlash, reversalCount;
+    int nominal, battery;
+    int direction;
+    bool inSlack;
+};
+
+inline void MotorModel::setBattery(int mV) {
+    battery = mV;
+}
+
+#endif /* MotorModel_hpp */
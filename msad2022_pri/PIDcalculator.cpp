@@ -14,6 +14,7 @@ PIDcalculator::PIDcalculator(double p, double i, double d, int16_t t, int16_t mi
     minimum = min;
     maximum = max;
     traceCnt = 0;
+    integral = 0.0;
 }
 
 PIDcalculator::~PIDcalculator() {}
@@ -0,0 +1,115 @@
+/*
+    PIDcontroller.hpp
+    PID controller with anti-windup, filtered derivative and feed-forward
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef PIDcontroller_hpp
+#define PIDcontroller_hpp
+
+#include <stdint.h>
+#include "FixedPoint.hpp"
+
+enum AntiWindup {
+    AW_NONE,            /* integrate always, as PIDcalculator does                          */
+    AW_CONDITIONAL,     /* stop integrating while the output saturates in the error's way   */
+    AW_BACK_CALCULATION,/* bleed the integral by the saturated excess through gain kt       */
+};
+
+/*
+    The error is taken as (sensor - target) the same as PIDcalculator,
+    so that PIDcontroller<float> can replace PIDcalculator with the same gains and signs:
+    - the integral is trapezoidal over deltaT given in microsecond
+    - the derivative is taken on the sensor instead of the error, which is identical
+      while the target stays constant but is free from the kick when the target changes
+    - the derivative passes through a first-order low-pass filter with time constant tf,
+      where tf = 0 means no filtering
+    - ki is applied inside the integral, so gains may change on the fly without bumps
+    With AW_NONE and tf = 0, the output equals that of PIDcalculator before truncation.
+    T is float, or Q16 to avoid floating point operations.
+*/
+template<typename T> class PIDcontroller {
+public:
+    PIDcontroller(T p, T i, T d, int32_t t, T min, T max, AntiWindup aw = AW_CONDITIONAL, T tf = T(0), T kt = T(0));
+    void setGains(T p, T i, T d);
+    void setLimits(T min, T max);
+    void reset();
+    /* ff is added to the output as is, e.g., the steering expected from the course curvature */
+    T compute(T sensor, T target, T ff = T(0));
+    inline T getIntegral() const { return integral; }
+protected:
+    T kp, ki, kd, kt, dt, alpha, minimum, maximum;
+    T integral, derivative, prevSensor, prevError;
+    AntiWindup antiWindup;
+    bool first;
+};
+
+template<typename T>
+PIDcontroller<T>::PIDcontroller(T p, T i, T d, int32_t t, T min, T max, AntiWindup aw, T tf, T kt_) :
+kp(p),ki(i),kd(d),kt(kt_),dt(T(t / 1000000.0)),minimum(min),maximum(max),antiWindup(aw) {
+    /* alpha = tf / (tf + dt) for a backward Euler low-pass filter */
+    alpha = (tf <= T(0)) ? T(0) : tf / (tf + dt);
+    reset();
+}
+
+template<typename T>
+void PIDcontroller<T>::setGains(T p, T i, T d) {
+    kp = p;
+    ki = i;
+    kd = d;
+}
+
+template<typename T>
+void PIDcontroller<T>::setLimits(T min, T max) {
+    minimum = min;
+    maximum = max;
+}
+
+template<typename T>
+void PIDcontroller<T>::reset() {
+    integral = derivative = prevSensor = prevError = T(0);
+    first = true;
+}
+
+template<typename T>
+T PIDcontroller<T>::compute(T sensor, T target, T ff) {
+    T error = sensor - target;
+    if (first) {
+        prevSensor = sensor;
+        prevError = error;
+        first = false;
+    }
+
+    /* derivative on measurement through the low-pass filter */
+    T rawDerivative = kd * (sensor - prevSensor) / dt;
+    derivative = alpha * derivative + (T(1) - alpha) * rawDerivative;
+    prevSensor = sensor;
+
+    /* trapezoidal integral increment */
+    T increment = ki * (error + prevError) / T(2) * dt;
+    prevError = error;
+
+    T unsaturated = kp * error + integral + increment + derivative + ff;
+    T output = unsaturated;
+    if (output > maximum) output = maximum;
+    if (output < minimum) output = minimum;
+
+    switch (antiWindup) {
+    case AW_CONDITIONAL:
+        /* integrate only unless the increment drives the output further into saturation */
+        if (!((unsaturated > maximum && increment > T(0)) || (unsaturated < minimum && increment < T(0)))) {
+            integral += increment;
+        }
+        break;
+    case AW_BACK_CALCULATION:
+        integral += increment + kt * (output - unsaturated) * dt;
+        break;
+    case AW_NONE:
+    default:
+        integral += increment;
+        break;
+    }
+    return output;
+}
+
+#endif /* PIDcontroller_hpp */
@@ -0,0 +1,166 @@
+/*
+    ParallelExecutor.hpp
+    ticks independent BrainTree::BehaviorTree instances across a pool of threads
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef ParallelExecutor_hpp
+#define ParallelExecutor_hpp
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "BrainTree.h"
+
+/*
+    Unlike BrainTree::ParallelSequence, which ticks its children one after
+    another in the calling task, tick() ticks every tree still running once
+    on its own thread of the pool and returns when all of them are done.
+    It is meant for host-side simulation, e.g., Monte-Carlo evaluation of
+    strategies; TOPPERS/EV3RT provides no std::thread.
+    Each tree gets its own Blackboard from BehaviorTree, and the nodes of
+    a tree must not touch any mutable state shared with the other trees,
+    e.g., build each tree by BrainTree::Builder(&context) with its own RobotContext.
+    A tree is ticked by one thread at a time, but not always the same one.
+*/
+class ParallelExecutor {
+public:
+    typedef BrainTree::Node::Status Status;
+    /* numThreads including the caller of tick(); 0 for all the cores */
+    ParallelExecutor(int numThreads = 0);
+    ~ParallelExecutor();
+    /* takes the ownership of tree, e.g., from BrainTree::Builder::build(); returns its index */
+    int add(BrainTree::Node* tree);
+    /* ticks the trees still running once; returns the number of them running afterwards */
+    int tick();
+    /* ticks until every tree terminates or maxTicks; returns the number of ticks */
+    int run(int maxTicks);
+    inline int getSize() const;
+    inline int getNumThreads() const;
+    inline Status getStatus(int i) const;
+    inline int getTicks(int i) const;
+    inline BrainTree::Blackboard* getBlackboard(int i) const;
+protected:
+    struct Entry {
+        BrainTree::Node* tree;
+        Status status;
+        int ticks;
+    };
+    std::vector<Entry> entries;
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable started, finished;
+    std::atomic<int> next;      /* index of the entry to claim next */
+    int busy;                   /* workers yet to finish the current round */
+    unsigned int round;         /* incremented to start a round */
+    bool quit;
+    void work();
+    void claim();
+};
+
+inline ParallelExecutor::ParallelExecutor(int numThreads) : next(0),busy(0),round(0),quit(false) {
+    if (numThreads <= 0) {
+        numThreads = std::thread::hardware_concurrency();
+        if (numThreads <= 0) numThreads = 1;
+    }
+    for (int i = 1; i < numThreads; i++) {
+        workers.push_back(std::thread(&ParallelExecutor::work, this));
+    }
+}
+
+inline ParallelExecutor::~ParallelExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        quit = true;
+    }
+    started.notify_all();
+    for (auto& w : workers) w.join();
+    for (auto& e : entries) delete e.tree;
+}
+
+inline int ParallelExecutor::add(BrainTree::Node* tree) {
+    assert(tree != nullptr);
+    entries.push_back({ tree, Status::Invalid, 0 });
+    return (int)entries.size() - 1;
+}
+
+/* tick the entries one by one as claimed, so that a slow tree does not hold up the others */
+inline void ParallelExecutor::claim() {
+    int n = (int)entries.size();
+    for (int i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+        Entry& e = entries[i];
+        if (e.status == Status::Success || e.status == Status::Failure) continue;
+        e.status = e.tree->tick();
+        e.ticks++;
+    }
+}
+
+inline void ParallelExecutor::work() {
+    unsigned int seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            started.wait(lock, [&] { return quit || round != seen; });
+            if (quit) return;
+            seen = round;
+        }
+        claim();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (--busy == 0) finished.notify_one();
+        }
+    }
+}
+
+inline int ParallelExecutor::tick() {
+    next = 0;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        busy = (int)workers.size();
+        round++;
+    }
+    started.notify_all();
+    claim();
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        finished.wait(lock, [&] { return busy == 0; });
+    }
+    int running = 0;
+    for (auto& e : entries) {
+        if (e.status != Status::Success && e.status != Status::Failure) running++;
+    }
+    return running;
+}
+
+inline int ParallelExecutor::run(int maxTicks) {
+    int t = 0;
+    while (t < maxTicks) {
+        t++;
+        if (tick() == 0) break;
+    }
+    return t;
+}
+
+inline int ParallelExecutor::getSize() const {
+    return (int)entries.size();
+}
+
+inline int ParallelExecutor::getNumThreads() const {
+    return (int)workers.size() + 1;
+}
+
+inline ParallelExecutor::Status ParallelExecutor::getStatus(int i) const {
+    return entries[i].status;
+}
+
+inline int ParallelExecutor::getTicks(int i) const {
+    return entries[i].ticks;
+}
+
+inline BrainTree::Blackboard* ParallelExecutor::getBlackboard(int i) const {
+    return entries[i].tree->getBlackboard();
+}
+
+#endif /* ParallelExecutor_hpp */
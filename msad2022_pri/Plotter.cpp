@@ -5,8 +5,8 @@
 */
 #include "Plotter.hpp"
 
-Plotter::Plotter(ev3api::Motor* lm, ev3api::Motor* rm, ev3api::GyroSensor* gs) :
-distance(0.0),azimuth(0.0),locX(0.0),locY(0.0),leftMotor(lm),rightMotor(rm),gyroSensor(gs) {
+Plotter::Plotter(ev3api::Motor* lm, ev3api::Motor* rm, ev3api::GyroSensor* gs, Integrator i) :
+leftMotor(lm),rightMotor(rm),gyroSensor(gs),integrator(i),distance(0.0),azimuth(0.0),locX(0.0),locY(0.0),heading(0.0),odometer(0.0),distOffset(0),seq(0) {
     /* reset motor encoders */
     leftMotor->reset();
     rightMotor->reset();
@@ -15,57 +15,166 @@ distance(0.0),azimuth(0.0),locX(0.0),locY(0.0),leftMotor(lm),rightMotor(rm),gyro
     /* initialize variables */
     prevAngL = leftMotor->getCount();
     prevAngR = rightMotor->getCount();
+    /* the first pose to look back to */
+    Pose pose = { (uint32_t)clock.now(), 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F };
+    history.push(pose);
 }
 
 int32_t Plotter::getDistance() {
-    return (int32_t)distance;
+    return (int32_t)read(distance) + distOffset;
 }
 
 int16_t Plotter::getAzimuth() {
-    return (int32_t)azimuth;
+    return (int32_t)read(azimuth);
 }
 
 int16_t Plotter::getDegree() {
     // degree = 360.0 * radian / M_TWOPI;
-    int16_t degree = (360.0 * azimuth / M_TWOPI);
+    int16_t degree = (360.0 * read(azimuth) / M_TWOPI);
     return degree;
 }
 
 int32_t Plotter::getLocX() {
-    return (int32_t)locX;
+    return (int32_t)read(locX);
 }
 
 int32_t Plotter::getLocY() {
-    return (int32_t)locY;
+    return (int32_t)read(locY);
 }
 
 int32_t Plotter::getAngL() {
-    return prevAngL;
+    return read(prevAngL);
 }
 
 int32_t Plotter::getAngR() {
-    return prevAngR;
+    return read(prevAngR);
+}
+
+uint32_t Plotter::getTime() {
+    uint32_t s, time;
+    do {
+        s = seq;
+        _compiler_barrier();
+        time = history.latest().time;
+        _compiler_barrier();
+    } while ((s & 1) || (s != seq));
+    return time;
+}
+
+bool Plotter::getPoseAt(uint32_t time, Pose& pose) {
+    uint32_t s;
+    bool found;
+    do {
+        s = seq;
+        _compiler_barrier();
+        found = history.at(time, pose);
+        _compiler_barrier();
+    } while ((s & 1) || (s != seq));
+    return found;
+}
+
+int32_t Plotter::getDistanceSince(uint32_t time) {
+    uint32_t s;
+    Pose pose;
+    float dist;
+    do {
+        s = seq;
+        _compiler_barrier();
+        history.at(time, pose);
+        dist = history.latest().distance - pose.distance;
+        _compiler_barrier();
+    } while ((s & 1) || (s != seq));
+    return (int32_t)dist;
+}
+
+int16_t Plotter::getDegreeChangeOver(int32_t dist) {
+    uint32_t s;
+    Pose pose;
+    float theta;
+    do {
+        s = seq;
+        _compiler_barrier();
+        const Pose& now = history.latest();
+        history.atOdometer(now.odometer - dist, pose);
+        theta = now.theta - pose.theta;
+        _compiler_barrier();
+    } while ((s & 1) || (s != seq));
+    return (int16_t)(360.0 * theta / M_TWOPI);
+}
+
+void Plotter::setDistanceOffset(int32_t offset) {
+    distOffset = offset;
+}
+
+void Plotter::setIntegrator(Integrator i) {
+    integrator = i;
 }
 
 void Plotter::plot() {
+    plot(leftMotor->getCount(), rightMotor->getCount());
+}
+
+void Plotter::plot(int32_t curAngL, int32_t curAngR) {
     /* accumulate distance */
-    int32_t curAngL = leftMotor->getCount();
-    int32_t curAngR = rightMotor->getCount();
-    double deltaDistL = M_PI * TIRE_DIAMETER * (curAngL - prevAngL) / 360.0;
-    double deltaDistR = M_PI * TIRE_DIAMETER * (curAngR - prevAngR) / 360.0;
+    double deltaDistL = DIST_PER_DEGREE * (curAngL - prevAngL);
+    double deltaDistR = DIST_PER_DEGREE * (curAngR - prevAngR);
     double deltaDist = (deltaDistL + deltaDistR) / 2.0;
+    double deltaAzi = (deltaDistL - deltaDistR) / WHEEL_TREAD;
+
+    /* estimate displacement during this step along stepHeading, by the integrator */
+    double stepHeading, chord;
+    switch (integrator) {
+    case INT_ARC:
+        /* the chord of the arc, 2 * radius * sin(deltaAzi / 2), points to the middle heading;
+           sin(x) / x is expanded around zero as deltaAzi in a step is small */
+        stepHeading = azimuth + deltaAzi / 2.0;
+        chord = deltaDist * (1.0 - deltaAzi * deltaAzi / 24.0 + deltaAzi * deltaAzi * deltaAzi * deltaAzi / 1920.0);
+        break;
+    case INT_MIDPOINT:
+        stepHeading = azimuth + deltaAzi / 2.0;
+        chord = deltaDist;
+        break;
+    case INT_EULER:
+    default:
+        stepHeading = azimuth + deltaAzi;
+        chord = deltaDist;
+        break;
+    }
+    float sinH, cosH;
+    fm_sincos(stepHeading, sinH, cosH);
+    double deltaX = chord * sinH;
+    double deltaY = chord * cosH;
+
+    /* prepare the pose to be recorded */
+    Pose pose;
+    pose.time = clock.now();
+    uint32_t deltaT = pose.time - history.latest().time;
+    pose.velocity = (deltaT == 0) ? history.latest().velocity : (float)(deltaDist * 1000000.0 / deltaT);
+
+    /* publish the new state */
+    seq = seq + 1;
+    _compiler_barrier();
     distance += deltaDist;
     prevAngL = curAngL;
     prevAngR = curAngR;
-    /* calculate azimuth */
-    double deltaAzi = (deltaDistL - deltaDistR) / WHEEL_TREAD;
-    azimuth += deltaAzi;
-    if (azimuth > M_TWOPI) {
-        azimuth -= M_TWOPI;
-    } else if (azimuth < 0.0) {
+    /* calculate azimuth, normalized within [0, M_TWOPI) regardless of how far it went */
+    azimuth = fmod(azimuth + deltaAzi, M_TWOPI);
+    if (azimuth < 0.0) {
         azimuth += M_TWOPI;
     }
     /* estimate location */
-    locX += (deltaDist * sin(azimuth));
-    locY += (deltaDist * cos(azimuth));
-}
\ No newline at end of file
+    locX += deltaX;
+    locY += deltaY;
+    /* record the pose for look-back queries with the heading NOT wrapped,
+       so that a change over the history does not jump across north */
+    heading += deltaAzi;
+    odometer += fabs(deltaDist);
+    pose.x = locX;
+    pose.y = locY;
+    pose.theta = heading;
+    pose.distance = distance;
+    pose.odometer = odometer;
+    history.push(pose);
+    _compiler_barrier();
+    seq = seq + 1;
+}
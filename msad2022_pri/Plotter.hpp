@@ -11,6 +11,9 @@
 
 #include "GyroSensor.h"
 #include "Motor.h"
+#include "Clock.h"
+#include "PoseHistory.hpp"
+#include "FastMath.hpp"
 
 /* M_PI and M_TWOPI is NOT available even with math header file under -std=c++11
    because they are not strictly comforming to C++11 standards
@@ -21,9 +24,33 @@
 #define M_TWOPI         (M_PI * 2.0)
 #endif
 
+/* distance in milimater travelled by a wheel per one degree of motor encoder */
+#define DIST_PER_DEGREE  (M_PI * TIRE_DIAMETER / 360.0)
+
+/* number of poses kept for look-back queries, i.e., 2.56 seconds at 10ms */
+#ifndef POSE_HISTORY_SIZE
+#define POSE_HISTORY_SIZE 256
+#endif
+
+/* methods to integrate the wheel displacement of one plot() into location */
+enum Integrator {
+    INT_EULER,      /* new azimuth applied to the whole step (the original method)  */
+    INT_MIDPOINT,   /* azimuth at the middle of the step                             */
+    INT_ARC,        /* circular arc between the previous and new azimuth             */
+};
+
+/*
+    plot() may be invoked either from update_task or from the dedicated high-rate PLT_TSK.
+    In the latter case, readers in lower priority tasks may get preempted by plot() in
+    the middle of reading a double.  All getters therefore take a consistent copy
+    guarded by a sequence counter, which is odd while plot() is writing.
+    The same applies to look-back queries against the pose history.
+    This relies on plot() never being preempted by a reader, i.e.,
+    plot() has to run in the highest priority task among its readers.
+*/
 class Plotter {
 public:
-    Plotter(ev3api::Motor* lm, ev3api::Motor* rm, ev3api::GyroSensor* gs);
+    Plotter(ev3api::Motor* lm, ev3api::Motor* rm, ev3api::GyroSensor* gs, Integrator i = INT_MIDPOINT);
     int32_t getDistance();
     int16_t getAzimuth();
     int16_t getDegree();
@@ -31,12 +58,47 @@ public:
     int32_t getLocY();
     int32_t getAngL();
     int32_t getAngR();
+    /* timestamp of the latest plot() in microsecond, which look-back queries are based on */
+    uint32_t getTime();
+    /* look-back queries answered by interpolation in O(log POSE_HISTORY_SIZE);
+       they return false, or use the oldest pose, when asked beyond the history */
+    bool getPoseAt(uint32_t time, Pose& pose);
+    int32_t getDistanceSince(uint32_t time);
+    int16_t getDegreeChangeOver(int32_t dist);
+    /* offset added to getDistance(), e.g., by Localizer; the pose history is NOT affected */
+    void setDistanceOffset(int32_t offset);
+    void setIntegrator(Integrator i);
+    /* read the encoders and integrate */
     void plot();
+    /* integrate the encoder counts already read, e.g., by SensorSnapshot */
+    void plot(int32_t curAngL, int32_t curAngR);
 protected:
     ev3api::Motor *leftMotor, *rightMotor;
     ev3api::GyroSensor *gyroSensor;
-    double distance, azimuth, locX, locY;
+    ev3api::Clock clock;
+    Integrator integrator;
+    double distance, azimuth, locX, locY, heading, odometer;
     int32_t prevAngL, prevAngR;
+    volatile int32_t distOffset;
+    PoseHistory<POSE_HISTORY_SIZE> history;
+    volatile uint32_t seq;
+    template<typename T> T read(const T& var) const;
 };
 
-#endif /* Plotter_hpp */
\ No newline at end of file
+#ifndef _compiler_barrier
+#define _compiler_barrier() __asm__ __volatile__("" ::: "memory")
+#endif
+
+template<typename T> T Plotter::read(const T& var) const {
+    uint32_t s;
+    T val;
+    do {
+        s = seq;
+        _compiler_barrier();
+        val = var;
+        _compiler_barrier();
+    } while ((s & 1) || (s != seq));
+    return val;
+}
+
+#endif /* Plotter_hpp */
@@ -0,0 +1,130 @@
+/*
+    PoseHistory.hpp
+    fixed-size ring of timestamped poses with look-back queries
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef PoseHistory_hpp
+#define PoseHistory_hpp
+
+#include <stdint.h>
+
+struct Pose {
+    uint32_t time;      /* timestamp in microsecond                             */
+    float x, y;         /* location in milimater                                */
+    float theta;        /* heading in radian, NOT wrapped so as to interpolate  */
+    float distance;     /* accumulated distance in milimater, negative if back  */
+    float odometer;     /* accumulated absolute distance, never decreases       */
+    float velocity;     /* in milimater per second                              */
+};
+
+/*
+    Poses are pushed in chronological order so that both time and odometer
+    are monotonic within the ring, which lets at() and atOdometer() find
+    the enclosing pair by binary search and interpolate between them.
+*/
+template<int CAPACITY> class PoseHistory {
+public:
+    PoseHistory() : head(0), count(0) {}
+    void clear() { head = count = 0; }
+    int size() const { return count; }
+    inline void push(const Pose& pose);
+    inline const Pose& latest() const;
+    inline const Pose& oldest() const;
+    /* return false when t is older than the oldest pose, which is then given */
+    bool at(uint32_t t, Pose& pose) const;
+    /* return false when odo is smaller than the oldest odometer, which is then given */
+    bool atOdometer(float odo, Pose& pose) const;
+protected:
+    Pose ring[CAPACITY];
+    int head, count;
+    /* i-th oldest pose, i.e., 0 for the oldest */
+    inline const Pose& nth(int i) const { return ring[(head - count + i + CAPACITY) % CAPACITY]; }
+    static void interpolate(const Pose& p0, const Pose& p1, float r, Pose& pose);
+};
+
+template<int CAPACITY>
+inline void PoseHistory<CAPACITY>::push(const Pose& pose) {
+    ring[head] = pose;
+    head = (head + 1) % CAPACITY;
+    if (count < CAPACITY) count++;
+}
+
+template<int CAPACITY>
+inline const Pose& PoseHistory<CAPACITY>::latest() const {
+    return nth(count - 1);
+}
+
+template<int CAPACITY>
+inline const Pose& PoseHistory<CAPACITY>::oldest() const {
+    return nth(0);
+}
+
+template<int CAPACITY>
+void PoseHistory<CAPACITY>::interpolate(const Pose& p0, const Pose& p1, float r, Pose& pose) {
+    pose.time     = p0.time + (uint32_t)(r * (p1.time - p0.time));
+    pose.x        = p0.x        + r * (p1.x        - p0.x);
+    pose.y        = p0.y        + r * (p1.y        - p0.y);
+    pose.theta    = p0.theta    + r * (p1.theta    - p0.theta);
+    pose.distance = p0.distance + r * (p1.distance - p0.distance);
+    pose.odometer = p0.odometer + r * (p1.odometer - p0.odometer);
+    pose.velocity = p0.velocity + r * (p1.velocity - p0.velocity);
+}
+
+template<int CAPACITY>
+bool PoseHistory<CAPACITY>::at(uint32_t t, Pose& pose) const {
+    if (count == 0) return false;
+    if ((int32_t)(t - latest().time) >= 0) {
+        pose = latest();
+        return true;
+    }
+    if ((int32_t)(t - oldest().time) < 0) {
+        pose = oldest();
+        return false;
+    }
+    /* find the last pose whose time is not later than t */
+    int lo = 0, hi = count - 1;
+    while (hi - lo > 1) {
+        int mid = (lo + hi) / 2;
+        if ((int32_t)(t - nth(mid).time) >= 0) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    const Pose& p0 = nth(lo);
+    const Pose& p1 = nth(hi);
+    uint32_t span = p1.time - p0.time;
+    interpolate(p0, p1, (span == 0) ? 0.0F : (float)(t - p0.time) / span, pose);
+    return true;
+}
+
+template<int CAPACITY>
+bool PoseHistory<CAPACITY>::atOdometer(float odo, Pose& pose) const {
+    if (count == 0) return false;
+    if (odo >= latest().odometer) {
+        pose = latest();
+        return true;
+    }
+    if (odo < oldest().odometer) {
+        pose = oldest();
+        return false;
+    }
+    /* find the last pose whose odometer is not larger than odo */
+    int lo = 0, hi = count - 1;
+    while (hi - lo > 1) {
+        int mid = (lo + hi) / 2;
+        if (nth(mid).odometer <= odo) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    const Pose& p0 = nth(lo);
+    const Pose& p1 = nth(hi);
+    float span = p1.odometer - p0.odometer;
+    interpolate(p0, p1, (span == 0.0F) ? 0.0F : (odo - p0.odometer) / span, pose);
+    return true;
+}
+
+#endif /* PoseHistory_hpp */
@@ -0,0 +1,82 @@
+/*
+    RelayTuner.cpp
+    relay-feedback auto-tuning of PID gains
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "RelayTuner.hpp"
+#include <math.h>
+
+RelayTuner::RelayTuner(double a, double h, int c, int32_t t) : amplitude(a),hysteresis(h),dt(t / 1000000.0),cycles(c) {
+    reset();
+}
+
+void RelayTuner::reset() {
+    output = amplitude;
+    errMax = -HUGE_VAL;
+    errMin = HUGE_VAL;
+    sumPeakToPeak = sumPeriod = 0.0;
+    ticks = 0;
+    lastRise = -1;
+    numCycles = 0;
+    done = false;
+}
+
+double RelayTuner::update(double error) {
+    if (done) return 0.0;
+    ticks++;
+    if (error > errMax) errMax = error;
+    if (error < errMin) errMin = error;
+
+    if (output < 0.0 && error > hysteresis) {
+        /* a cycle completes at every switch to the positive output */
+        output = amplitude;
+        if (lastRise >= 0) {
+            numCycles++;
+            if (numCycles > RELAY_SETTLE_CYCLES) {
+                sumPeakToPeak += errMax - errMin;
+                sumPeriod += (ticks - lastRise) * dt;
+                if (numCycles - RELAY_SETTLE_CYCLES >= cycles) {
+                    done = true;
+                }
+            }
+        }
+        lastRise = ticks;
+        errMax = -HUGE_VAL;
+        errMin = HUGE_VAL;
+    } else if (output > 0.0 && error < -hysteresis) {
+        output = -amplitude;
+    }
+    return done ? 0.0 : output;
+}
+
+bool RelayTuner::isDone() {
+    return done;
+}
+
+double RelayTuner::getUltimateGain() {
+    if (!done) return 0.0;
+    double a = sumPeakToPeak / cycles / 2.0;
+    double r = a * a - hysteresis * hysteresis;
+    return (r > 0.0) ? 4.0 * amplitude / (M_PI * sqrt(r)) : 0.0;
+}
+
+double RelayTuner::getUltimatePeriod() {
+    return done ? sumPeriod / cycles : 0.0;
+}
+
+void RelayTuner::getGains(TuningRule rule, double& p, double& i, double& d) {
+    double ku = getUltimateGain(), tu = getUltimatePeriod();
+    double ti, td;
+    if (rule == TR_TYREUS_LUYBEN) {
+        p  = ku / 2.2;
+        ti = 2.2 * tu;
+        td = tu / 6.3;
+    } else { /* rule == TR_ZIEGLER_NICHOLS */
+        p  = 0.6 * ku;
+        ti = tu / 2.0;
+        td = tu / 8.0;
+    }
+    i = (ti > 0.0) ? p / ti : 0.0;
+    d = p * td;
+}
@@ -0,0 +1,48 @@
+/*
+    RelayTuner.hpp
+    relay-feedback auto-tuning of PID gains
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef RelayTuner_hpp
+#define RelayTuner_hpp
+
+#include <stdint.h>
+
+enum TuningRule {
+    TR_ZIEGLER_NICHOLS,
+    TR_TYREUS_LUYBEN,   /* less overshoot and more robust than Ziegler-Nichols */
+};
+
+/*
+    update() returns +amplitude or -amplitude by the sign of error = sensor - target,
+    switching only when the error crosses the hysteresis band, which makes the loop
+    oscillate at its ultimate period. After the first RELAY_SETTLE_CYCLES cycles,
+    the peak-to-peak error and the period are averaged over the given number of cycles.
+    The ultimate gain is then 4 * amplitude / (pi * sqrt(a^2 - hysteresis^2)),
+    where a is half the peak-to-peak error.
+    The sign convention of error and output is the same as PIDcontroller with positive gains,
+    so the relay replaces PIDcontroller::compute() in place and the resulting gains are positive.
+*/
+#define RELAY_SETTLE_CYCLES 2
+
+class RelayTuner {
+public:
+    RelayTuner(double amplitude, double hysteresis, int cycles, int32_t t_us);
+    double update(double error);
+    bool isDone();
+    double getUltimateGain();
+    /* in second */
+    double getUltimatePeriod();
+    /* gains in the units of PIDcontroller, i.e., ki per second and kd times second */
+    void getGains(TuningRule rule, double& p, double& i, double& d);
+    void reset();
+protected:
+    double amplitude, hysteresis, dt, output;
+    double errMax, errMin, sumPeakToPeak, sumPeriod;
+    int32_t ticks, lastRise;
+    int cycles, numCycles;
+    bool done;
+};
+
+#endif /* RelayTuner_hpp */
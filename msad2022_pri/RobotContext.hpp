@@ -0,0 +1,48 @@
+/*
+    RobotContext.hpp
+    devices and shared objects of a robot handed to the nodes of its behavior trees
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef RobotContext_hpp
+#define RobotContext_hpp
+
+namespace ev3api {
+    class Clock;
+    class TouchSensor;
+    class SonarSensor;
+    class GyroSensor;
+    class Motor;
+}
+class FilteredColorSensor;
+class FilteredMotor;
+class Plotter;
+class CourseMap;
+class Localizer;
+class SensorSnapshot;
+
+/*
+    A behavior tree gets the context by BrainTree::Builder(&context), which keeps it
+    in the Blackboard of the tree, and every node deriving RobotNode in app.cpp caches
+    the pointer when the builder sets the Blackboard, i.e., the context has to be filled
+    before building the trees.
+    Each robot has its own context, so that robots, e.g., simulated ones on the host,
+    can coexist in a process; the context neither owns nor deletes the objects.
+    A member may be nullptr when the robot lacks it, e.g., sonarSensor and localizer.
+*/
+struct RobotContext {
+    ev3api::Clock*          clock       = nullptr;
+    ev3api::TouchSensor*    touchSensor = nullptr;
+    ev3api::SonarSensor*    sonarSensor = nullptr;
+    FilteredColorSensor*    colorSensor = nullptr;
+    ev3api::GyroSensor*     gyroSensor  = nullptr;
+    FilteredMotor*          leftMotor   = nullptr;
+    FilteredMotor*          rightMotor  = nullptr;
+    ev3api::Motor*          armMotor    = nullptr;
+    Plotter*                plotter     = nullptr;
+    CourseMap*              courseMap   = nullptr;
+    Localizer*              localizer   = nullptr;
+    SensorSnapshot*         snapshot    = nullptr;
+};
+
+#endif /* RobotContext_hpp */
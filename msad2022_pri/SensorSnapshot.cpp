@@ -0,0 +1,71 @@
+/*
+    SensorSnapshot.cpp
+    per-tick copy of sensor and encoder readings
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "SensorSnapshot.hpp"
+
+/* bits of fresh */
+#define SNAP_SONAR      0x01
+#define SNAP_TOUCH      0x02
+#define SNAP_ARM        0x04
+#define SNAP_BATTERY    0x08
+
+SensorSnapshot::SensorSnapshot(ev3api::Clock* c, ev3api::TouchSensor* ts, ev3api::SonarSensor* ss,
+                               FilteredColorSensor* cs, ev3api::GyroSensor* gs,
+                               ev3api::Motor* lm, ev3api::Motor* rm, ev3api::Motor* am) :
+clock(c),touchSensor(ts),sonarSensor(ss),colorSensor(cs),gyroSensor(gs),leftMotor(lm),rightMotor(rm),armMotor(am),
+time(0),gyroAngle(0),angL(0),angR(0),backPressed(false),
+sonarDistance(-1),armCount(0),batteryVoltage(0),touchPressed(false),fresh(0) {
+    rgb.r = rgb.g = rgb.b = 0;
+}
+
+void SensorSnapshot::acquire() {
+    time = clock->now();
+    /* FilteredColorSensor::sense() has already been done for this tick */
+    colorSensor->getRawColor(rgb);
+    gyroAngle = gyroSensor->getAngle();
+    angL = leftMotor->getCount();
+    angR = rightMotor->getCount();
+    backPressed = ev3_button_is_pressed(BACK_BUTTON);
+    fresh = 0;
+}
+
+int32_t SensorSnapshot::getArmCount() const {
+    if (!(fresh & SNAP_ARM)) {
+        armCount = armMotor->getCount();
+        fresh |= SNAP_ARM;
+    }
+    return armCount;
+}
+
+/* in centimeter, or -1 when no sonar sensor is available */
+int16_t SensorSnapshot::getSonarDistance() const {
+    if (!(fresh & SNAP_SONAR)) {
+        if (sonarSensor != nullptr) {
+            sonarDistance = sonarSensor->getDistance();
+        }
+        fresh |= SNAP_SONAR;
+    }
+    return sonarDistance;
+}
+
+/* in millivolt */
+int SensorSnapshot::getBatteryVoltage() const {
+    if (!(fresh & SNAP_BATTERY)) {
+        batteryVoltage = ev3_battery_voltage_mV();
+        fresh |= SNAP_BATTERY;
+    }
+    return batteryVoltage;
+}
+
+bool SensorSnapshot::isTouchPressed() const {
+    if (!(fresh & SNAP_TOUCH)) {
+        if (touchSensor != nullptr) {
+            touchPressed = touchSensor->isPressed();
+        }
+        fresh |= SNAP_TOUCH;
+    }
+    return touchPressed;
+}
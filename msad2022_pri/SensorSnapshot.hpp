@@ -0,0 +1,89 @@
+/*
+    SensorSnapshot.hpp
+    per-tick copy of sensor and encoder readings
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef SensorSnapshot_hpp
+#define SensorSnapshot_hpp
+
+#include "TouchSensor.h"
+#include "SonarSensor.h"
+#include "GyroSensor.h"
+#include "Motor.h"
+#include "Clock.h"
+#include "FilteredColorSensor.hpp"
+
+/*
+    acquire() reads the clock, the color, the gyro and the wheel encoders at the top of update_task,
+    as they are used every tick, and marks the others stale.
+    The sonar, the touch sensor, the arm encoder and the battery are read on the first access
+    in a tick instead, as most ticks use none of them.
+    Nodes and filters then read the copy instead of the device,
+    so that a tick sees one consistent state and no device gets read twice.
+    A copy, e.g., through DoubleBuffer, carries what is already read and reads the rest itself.
+    Devices given as nullptr, e.g., the sonar sensor on RasPike, are skipped.
+    Note that the angular velocity of the gyro sensor is NOT read
+    because switching the sensor mode between angle and rate every tick resets the sensor.
+*/
+class SensorSnapshot {
+public:
+    SensorSnapshot(ev3api::Clock* c, ev3api::TouchSensor* ts, ev3api::SonarSensor* ss,
+                   FilteredColorSensor* cs, ev3api::GyroSensor* gs,
+                   ev3api::Motor* lm, ev3api::Motor* rm, ev3api::Motor* am);
+    void acquire();
+    inline uint32_t getTime() const;
+    inline void getRawColor(rgb_raw_t &rgb) const;
+    inline int16_t getGyroAngle() const;
+    inline int32_t getAngL() const;
+    inline int32_t getAngR() const;
+    int32_t getArmCount() const;
+    int16_t getSonarDistance() const;
+    int getBatteryVoltage() const;
+    bool isTouchPressed() const;
+    inline bool isBackPressed() const;
+protected:
+    ev3api::Clock* clock;
+    ev3api::TouchSensor* touchSensor;
+    ev3api::SonarSensor* sonarSensor;
+    FilteredColorSensor* colorSensor;
+    ev3api::GyroSensor* gyroSensor;
+    ev3api::Motor *leftMotor, *rightMotor, *armMotor;
+    uint32_t time;
+    rgb_raw_t rgb;
+    int16_t gyroAngle;
+    int32_t angL, angR;
+    bool backPressed;
+    /* read on the first access in a tick, see the SNAP_* bits of fresh */
+    mutable int16_t sonarDistance;
+    mutable int32_t armCount;
+    mutable int batteryVoltage;
+    mutable bool touchPressed;
+    mutable uint8_t fresh;
+};
+
+inline uint32_t SensorSnapshot::getTime() const {
+    return time;
+}
+
+inline void SensorSnapshot::getRawColor(rgb_raw_t &c) const {
+    c = rgb;
+}
+
+inline int16_t SensorSnapshot::getGyroAngle() const {
+    return gyroAngle;
+}
+
+inline int32_t SensorSnapshot::getAngL() const {
+    return angL;
+}
+
+inline int32_t SensorSnapshot::getAngR() const {
+    return angR;
+}
+
+inline bool SensorSnapshot::isBackPressed() const {
+    return backPressed;
+}
+
+#endif /* SensorSnapshot_hpp */
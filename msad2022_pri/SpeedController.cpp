@@ -0,0 +1,39 @@
+/*
+    SpeedController.cpp
+    closed-loop wheel speed control from encoder counts
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "SpeedController.hpp"
+
+/* the PI controller only integrates; the proportional term is computed here on the averaged speed */
+SpeedController::SpeedController(double p, double i, double ppm, double mpd, int32_t t) :
+pi(0.0, i, 0.0, t, -100.0, 100.0, AW_CONDITIONAL),target(0.0),speed(0.0),pwmPerMmps(ppm),mmPerDegree(mpd),
+dt(t / 1000000.0),kp(p),prevCount(0),primed(false) {}
+
+void SpeedController::setTarget(double mmps) {
+    target = mmps;
+}
+
+void SpeedController::reset() {
+    pi.reset();
+    deltas.clear();
+    speed = 0.0;
+    primed = false;
+}
+
+double SpeedController::update(int32_t count) {
+    if (!primed) {
+        /* no delta yet to measure the speed from */
+        prevCount = count;
+        primed = true;
+        return pi.compute((float)target, (float)target, (float)(target * pwmPerMmps));
+    }
+    double raw = (count - prevCount) * mmPerDegree / dt;
+    prevCount = count;
+    speed = deltas.push((float)raw);
+    double ff = target * pwmPerMmps + kp * (target - speed);
+    /* error is target - raw so that the pwm increases while the wheel is slower */
+    double pwm = pi.compute((float)target, (float)raw, (float)ff);
+    return pwm;
+}
@@ -0,0 +1,50 @@
+/*
+    SpeedController.hpp
+    closed-loop wheel speed control from encoder counts
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef SpeedController_hpp
+#define SpeedController_hpp
+
+#include <stdint.h>
+#include <assert.h>
+#include "PIDcontroller.hpp"
+#include "MovingAverage.hpp"
+
+#define SPD_WINDOW  4   /* encoder deltas averaged for the measured speed */
+
+/*
+    update() is to be called every t_us with the encoder count and returns the pwm
+    to track the target speed in mm/s, as feed-forward target * pwm_per_mmps plus
+    PI control on the speed error. As one encoder degree in t_us is a coarse speed,
+    the proportional term sees the speed averaged over SPD_WINDOW periods, whereas
+    the integral term sums the raw deltas and thus tracks the distance exactly.
+*/
+class SpeedController {
+public:
+    SpeedController(double p, double i, double pwm_per_mmps, double mm_per_degree, int32_t t_us);
+    void setTarget(double mmps);
+    inline double getTarget() const;
+    /* measured speed in mm/s averaged over SPD_WINDOW periods */
+    inline double getSpeed() const;
+    /* to restart, e.g., when switched from pwm; the next update() gives the feed-forward only */
+    void reset();
+    double update(int32_t count);
+protected:
+    PIDcontroller<float> pi;
+    MovingAverage<float, SPD_WINDOW> deltas;
+    double target, speed, pwmPerMmps, mmPerDegree, dt, kp;
+    int32_t prevCount;
+    bool primed;
+};
+
+inline double SpeedController::getTarget() const {
+    return target;
+}
+
+inline double SpeedController::getSpeed() const {
+    return speed;
+}
+
+#endif /* SpeedController_hpp */
@@ -0,0 +1,111 @@
+/*
+    StateTable.hpp
+    table-driven state machine with entry/exit hooks and a binary transition trace
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef StateTable_hpp
+#define StateTable_hpp
+
+#include <stdint.h>
+#include <assert.h>
+
+/* next state of an internal transition, which neither exits nor enters */
+#define STT_STAY        (-1)
+
+/* number of transitions kept in the trace */
+#ifndef STT_TRACE_SIZE
+#define STT_TRACE_SIZE  64
+#endif
+
+/* an entry of the state x event table; action may be nullptr */
+struct Transition {
+    int8_t next;
+    void (*action)();
+};
+
+/* hooks of a state; either may be nullptr */
+struct StateHooks {
+    void (*entry)();
+    void (*exit)();
+};
+
+/* 8 bytes per transition so that tracing costs nothing like a log line */
+struct TraceRecord {
+    uint32_t time;
+    uint8_t from, to, event, reserved;
+};
+
+/*
+    dispatch() looks up the table by the current state and the event in O(1).
+    For a transition to another state, or to the same state, it calls
+    the exit hook, the action, the entry hook in this order and records the trace;
+    for STT_STAY, only the action.
+    The tables are meant to be constexpr, so that adding a state is adding a row.
+    dispatch() has to be called from one task at a time.
+*/
+template<int NUM_STATES, int NUM_EVENTS> class StateTable {
+public:
+    typedef Transition Transitions[NUM_STATES][NUM_EVENTS];
+    typedef StateHooks Hooks[NUM_STATES];
+    StateTable(const Transitions& t, const Hooks& h, int initial);
+    void dispatch(int event, uint32_t now);
+    inline int getState() const;
+    /* the latest STT_TRACE_SIZE transitions, i = 0 being the oldest */
+    int getTraceCount() const;
+    const TraceRecord& getTrace(int i) const;
+protected:
+    const Transitions& table;
+    const Hooks& hooks;
+    volatile int state;
+    TraceRecord trace[STT_TRACE_SIZE];
+    uint32_t traced;
+};
+
+template<int NUM_STATES, int NUM_EVENTS>
+StateTable<NUM_STATES, NUM_EVENTS>::StateTable(const Transitions& t, const Hooks& h, int initial) :
+table(t),hooks(h),state(initial),traced(0) {
+    assert(initial >= 0 && initial < NUM_STATES);
+}
+
+template<int NUM_STATES, int NUM_EVENTS>
+void StateTable<NUM_STATES, NUM_EVENTS>::dispatch(int event, uint32_t now) {
+    assert(event >= 0 && event < NUM_EVENTS);
+    int from = state;
+    const Transition& t = table[from][event];
+    if (t.next == STT_STAY) {
+        if (t.action != nullptr) t.action();
+        return;
+    }
+    assert(t.next >= 0 && t.next < NUM_STATES);
+    if (hooks[from].exit != nullptr) hooks[from].exit();
+    if (t.action != nullptr) t.action();
+    TraceRecord& r = trace[traced % STT_TRACE_SIZE];
+    r.time = now;
+    r.from = (uint8_t)from;
+    r.to = (uint8_t)t.next;
+    r.event = (uint8_t)event;
+    r.reserved = 0;
+    traced++;
+    state = t.next;
+    if (hooks[state].entry != nullptr) hooks[state].entry();
+}
+
+template<int NUM_STATES, int NUM_EVENTS>
+inline int StateTable<NUM_STATES, NUM_EVENTS>::getState() const {
+    return state;
+}
+
+template<int NUM_STATES, int NUM_EVENTS>
+int StateTable<NUM_STATES, NUM_EVENTS>::getTraceCount() const {
+    return (traced < STT_TRACE_SIZE) ? (int)traced : STT_TRACE_SIZE;
+}
+
+template<int NUM_STATES, int NUM_EVENTS>
+const TraceRecord& StateTable<NUM_STATES, NUM_EVENTS>::getTrace(int i) const {
+    assert(i >= 0 && i < getTraceCount());
+    uint32_t first = (traced < STT_TRACE_SIZE) ? 0 : traced - STT_TRACE_SIZE;
+    return trace[(first + i) % STT_TRACE_SIZE];
+}
+
+#endif /* StateTable_hpp */
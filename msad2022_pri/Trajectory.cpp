@@ -0,0 +1,96 @@
+/*
+    Trajectory.cpp
+    time-optimal trapezoidal and S-curve motion profiles
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "Trajectory.hpp"
+#include <math.h>
+#include <assert.h>
+
+Trajectory::Trajectory(double vm, double am, double jm) : vmax(vm),amax(am),jmax(jm) {
+    assert(vmax > 0.0 && amax > 0.0 && jmax >= 0.0);
+    plan(0.0);
+}
+
+/*
+    The acceleration phase lasts ta, of which tj at each end ramps the acceleration
+    by the jerk limit, and reaches the cruise speed v. Since the deceleration phase
+    mirrors it, both phases together cover v * ta and the cruise lasts tv.
+*/
+void Trajectory::plan(double distance) {
+    sign = (distance < 0.0) ? -1.0 : 1.0;
+    dist = fabs(distance);
+    v = vmax;
+    if (jmax == 0.0) {
+        tj = 0.0;
+        a = amax;
+        ta = v / a;
+        if (v * ta > dist) {
+            /* vmax is not reached */
+            v = sqrt(a * dist);
+            ta = v / a;
+        }
+    } else {
+        if (v * jmax >= amax * amax) {
+            tj = amax / jmax;
+            ta = tj + v / amax;
+        } else {
+            /* vmax is reached before amax */
+            tj = sqrt(v / jmax);
+            ta = 2.0 * tj;
+        }
+        if (v * ta > dist) {
+            /* vmax is not reached; try with amax first */
+            double k = amax * amax / jmax;
+            v = (-k + sqrt(k * k + 4.0 * amax * dist)) / 2.0;
+            if (v * jmax >= amax * amax) {
+                tj = amax / jmax;
+                ta = tj + v / amax;
+            } else {
+                tj = cbrt(dist / (2.0 * jmax));
+                v = jmax * tj * tj;
+                ta = 2.0 * tj;
+            }
+        }
+        a = jmax * tj;
+    }
+    tv = (v > 0.0) ? dist / v - ta : 0.0;
+    if (tv < 0.0) tv = 0.0;
+    total = 2.0 * ta + tv;
+}
+
+void Trajectory::accelerate(double t, double& pos, double& vel) const {
+    if (t < tj) {
+        vel = jmax * t * t / 2.0;
+        pos = jmax * t * t * t / 6.0;
+    } else if (t < ta - tj) {
+        double v1 = jmax * tj * tj / 2.0, tau = t - tj;
+        vel = v1 + a * tau;
+        pos = jmax * tj * tj * tj / 6.0 + v1 * tau + a * tau * tau / 2.0;
+    } else {
+        /* the end of the phase mirrors its start */
+        double s = ta - t;
+        vel = v - jmax * s * s / 2.0;
+        pos = v * ta / 2.0 - (v * s - jmax * s * s * s / 6.0);
+    }
+}
+
+void Trajectory::sample(double t, double& pos, double& vel) const {
+    if (t <= 0.0) {
+        pos = vel = 0.0;
+    } else if (t >= total) {
+        pos = dist;
+        vel = 0.0;
+    } else if (t < ta) {
+        accelerate(t, pos, vel);
+    } else if (t < ta + tv) {
+        pos = v * ta / 2.0 + v * (t - ta);
+        vel = v;
+    } else {
+        accelerate(total - t, pos, vel);
+        pos = dist - pos;
+    }
+    pos *= sign;
+    vel *= sign;
+}
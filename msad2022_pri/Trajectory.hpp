@@ -0,0 +1,35 @@
+/*
+    Trajectory.hpp
+    time-optimal trapezoidal and S-curve motion profiles
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef Trajectory_hpp
+#define Trajectory_hpp
+
+/*
+    plan() is to compute the fastest rest-to-rest profile covering the distance
+    under the velocity, acceleration and, unless jmax = 0.0, jerk limits;
+    jmax = 0.0 gives a trapezoidal profile and jmax > 0.0 an S-curve.
+    The unit of the distance is arbitrary, e.g., mm, with the limits in the same unit per second.
+*/
+class Trajectory {
+public:
+    Trajectory(double vmax, double amax, double jmax = 0.0);
+    void plan(double distance);
+    /* duration of the profile in second */
+    inline double getDuration() const;
+    /* position and velocity at t second after the start */
+    void sample(double t, double& pos, double& vel) const;
+protected:
+    /* position and velocity in the acceleration phase for the positive distance */
+    void accelerate(double t, double& pos, double& vel) const;
+    double vmax, amax, jmax;
+    double dist, sign, v, a, tj, ta, tv, total;
+};
+
+inline double Trajectory::getDuration() const {
+    return total;
+}
+
+#endif /* Trajectory_hpp */
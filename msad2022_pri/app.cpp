@@ -22,36 +22,62 @@ extern "C" void __sync_synchronize() {}
 /* global variables */
 FILE*           bt;
 Clock*          ev3clock;
-TouchSensor*    touchSensor;
-SonarSensor*    sonarSensor;
-FilteredColorSensor*    colorSensor;
-GyroSensor*     gyroSensor;
+/* devices and shared objects of the robot, handed to the nodes by BrainTree::Builder(&robot) */
+RobotContext    robot;
+/* touched by FilteredMotor::drive() only once set up, see setSrewRate() */
 SRLF*           srlfL;
-FilteredMotor*  leftMotor;
 SRLF*           srlfR;
-FilteredMotor*  rightMotor;
-Motor*          armMotor;
-Plotter*        plotter;
+MotorModel*     modelL = nullptr;
+MotorModel*     modelR = nullptr;
+SpeedController* speedL;
+SpeedController* speedR;
+GainSchedule*   gainSchedule;
+/* under MULTI_RATE, CTL_TSK acquires into sensed and publishes it to snapshots,
+   which UPD_TSK copies into snapshot and LOG_TSK into logged */
+SensorSnapshot* sensed = nullptr;
+SensorSnapshot* logged = nullptr;
+DoubleBuffer<SensorSnapshot>* snapshots = nullptr;
+/* the deadline monitors take the time of monClock, which unlike ev3clock no node resets */
+Clock*          monClock = nullptr;
+DeadlineMonitor* updMonitor = nullptr;
+DeadlineMonitor* ctlMonitor = nullptr;
+bool            logShed = false;
 
 BrainTree::BehaviorTree* tr_calibration = nullptr;
 BrainTree::BehaviorTree* tr_run         = nullptr;
 BrainTree::BehaviorTree* tr_block       = nullptr;
-State state = ST_INITIAL;
+StateTable<ST_NUM, EV_NUM>* hfsm = nullptr;
 
 /*
     === NODE CLASS DEFINITION STARTS HERE ===
     A Node class serves like a LEGO block while a Behavior Tree serves as a blueprint for the LEGO object built using the LEGO blocks.
 */
 
+/*
+    RobotNode is the base of the node classes below, which reach the devices
+    only through ctx, the RobotContext given to BrainTree::Builder(&context)
+    and cached when the builder sets the Blackboard of the tree.
+*/
+class RobotNode : public BrainTree::Node {
+public:
+    void setBlackboard(BrainTree::Blackboard* board) override {
+        BrainTree::Node::setBlackboard(board);
+        ctx = static_cast<RobotContext*>(board->getContext());
+        assert(ctx != nullptr);
+    }
+protected:
+    RobotContext* ctx = nullptr;
+};
+
 /*
     usage:
     ".leaf<ResetClock>()"
     is to reset the clock and indicate the robot departure by LED color.
 */
-class ResetClock : public BrainTree::Node {
+class ResetClock : public RobotNode {
 public:
     Status update() override {
-        ev3clock->reset();
+        ctx->clock->reset();
         _log("clock reset.");
         ev3_led_set_color(LED_GREEN);
         return Status::Success;
@@ -63,11 +89,11 @@ public:
     ".leaf<StopNow>()"
     is to stop the robot.
 */
-class StopNow : public BrainTree::Node {
+class StopNow : public RobotNode {
 public:
     Status update() override {
-        leftMotor->setPWM(0);
-        rightMotor->setPWM(0);
+        ctx->leftMotor->setPWM(0);
+        ctx->rightMotor->setPWM(0);
         _log("robot stopped.");
         return Status::Success;
     }
@@ -78,10 +104,10 @@ public:
     ".leaf<IsTouchOn>()"
     is to check if the touch sensor gets pressed.
 */
-class IsTouchOn : public BrainTree::Node {
+class IsTouchOn : public RobotNode {
 public:
     Status update() override {
-        if (touchSensor->isPressed()) {
+        if (ctx->snapshot->isTouchPressed()) {
             _log("touch sensor pressed.");
             return Status::Success;
         } else {
@@ -95,10 +121,10 @@ public:
     ".leaf<IsBackOn>()"
     is to check if the back button gets pressed.
 */
-class IsBackOn : public BrainTree::Node {
+class IsBackOn : public RobotNode {
 public:
     Status update() override {
-        if (ev3_button_is_pressed(BACK_BUTTON)) {
+        if (ctx->snapshot->isBackPressed()) {
             _log("back button pressed.");
             return Status::Success;
         } else {
@@ -114,11 +140,11 @@ public:
     to an object in front of sonar sensor.
     dist is in millimeter.
 */
-class IsSonarOn : public BrainTree::Node {
+class IsSonarOn : public RobotNode {
 public:
     IsSonarOn(int32_t d) : alertDistance(d) {}
     Status update() override {
-        int32_t distance = 10 * (sonarSensor->getDistance());
+        int32_t distance = 10 * (ctx->snapshot->getSonarDistance());
         if ((distance <= alertDistance) && (distance >= 0)) {
             _log("sonar alert at %d", distance);
             return Status::Success;
@@ -136,11 +162,11 @@ protected:
     is to determine if the angular location of the robot measured by the gyro sensor is larger than the spedified angular value.
     angle is in degree.
 */
-class IsAngleLarger : public BrainTree::Node {
+class IsAngleLarger : public RobotNode {
 public:
     IsAngleLarger(int ang) : angle(ang) {}
     Status update() override {
-        int32_t curAngle = gyroSensor->getAngle(); 
+        int32_t curAngle = ctx->snapshot->getGyroAngle();
         if (curAngle >= angle){
             return Status::Success;
         } else {
@@ -157,11 +183,11 @@ protected:
     is to determine if the angular location of the robot measured by the gyro sensor is smaller than the spedified angular value.
     angle is in degree.
 */
-class IsAngleSmaller : public BrainTree::Node {
+class IsAngleSmaller : public RobotNode {
 public:
     IsAngleSmaller(int ang) : angle(ang) {}
     Status update() override {
-        int32_t curAngle = gyroSensor->getAngle(); 
+        int32_t curAngle = ctx->snapshot->getGyroAngle();
         if (curAngle <= angle){
             return Status::Success;
         } else {
@@ -178,7 +204,7 @@ protected:
     is to determine if the robot has accumulated for the specified distance since update() was invoked for the first time.
     dist is in millimeter.
 */
-class IsDistanceEarned : public BrainTree::Node {
+class IsDistanceEarned : public RobotNode {
 public:
     IsDistanceEarned(int32_t d) : deltaDistTarget(d) {
         updated = false;
@@ -186,15 +212,15 @@ public:
     }
     Status update() override {
         if (!updated) {
-            originalDist = plotter->getDistance();
+            originalDist = ctx->plotter->getDistance();
             _log("ODO=%05d, Distance accumulation started.", originalDist);
             updated = true;
         }
-        int32_t deltaDist = plotter->getDistance() - originalDist;
+        int32_t deltaDist = ctx->plotter->getDistance() - originalDist;
         
         if ((deltaDist >= deltaDistTarget) || (-deltaDist <= -deltaDistTarget)) {
             if (!earned) {
-                _log("ODO=%05d, Delta distance %d is earned.", plotter->getDistance(), deltaDistTarget);
+                _log("ODO=%05d, Delta distance %d is earned.", ctx->plotter->getDistance(), deltaDistTarget);
                 earned = true;
             }
             return Status::Success;
@@ -207,13 +233,39 @@ protected:
     bool updated, earned;
 };
 
+/*
+    usage:
+    ".leaf<IsCurveDetected>(degree, dist)"
+    is to determine if the heading of the robot has changed by the specified degree or more
+    within the last dist millimeter, by looking back the pose history kept by Plotter.
+    degree > 0 for clockwise and degree < 0 for counter-clockwise.
+    dist has to be short enough for the history, i.e., POSE_HISTORY_SIZE * PERIOD_UPD_TSK at the speed.
+*/
+class IsCurveDetected : public RobotNode {
+public:
+    IsCurveDetected(int16_t degree, int32_t d) : deltaDegreeTarget(_COURSE * degree),dist(d) {}
+    Status update() override {
+        int16_t deltaDegree = ctx->plotter->getDegreeChangeOver(dist);
+        if ((deltaDegreeTarget >= 0 && deltaDegree >= deltaDegreeTarget) ||
+            (deltaDegreeTarget <  0 && deltaDegree <= deltaDegreeTarget)) {
+            _log("ODO=%05d, Curve of %d degree detected within %d mm.", ctx->plotter->getDistance(), deltaDegree, dist);
+            return Status::Success;
+        } else {
+            return Status::Running;
+        }
+    }
+protected:
+    int16_t deltaDegreeTarget;
+    int32_t dist;
+};
+
 /*
     usage:
     ".leaf<IsTimeEarned>(time)"
     is to determine if the robot has accumulated for the specified time since update() was invoked for the first time.
     time is in microsecond = 1/1,000,000 second.
 */
-class IsTimeEarned : public BrainTree::Node {
+class IsTimeEarned : public RobotNode {
 public:
     IsTimeEarned(int32_t t) : deltaTimeTarget(t) {
         updated = false;
@@ -221,15 +273,15 @@ public:
     }
     Status update() override {
         if (!updated) {
-            originalTime = ev3clock->now();
-            _log("ODO=%05d, Time accumulation started.", plotter->getDistance());
+            originalTime = ctx->snapshot->getTime();
+            _log("ODO=%05d, Time accumulation started.", ctx->plotter->getDistance());
              updated = true;
         }
-        int32_t deltaTime = ev3clock->now() - originalTime;
+        int32_t deltaTime = ctx->snapshot->getTime() - originalTime;
 
         if (deltaTime >= deltaTimeTarget) {
             if (!earned) {
-                 _log("ODO=%05d, Delta time %d is earned.", plotter->getDistance(), deltaTimeTarget);
+                 _log("ODO=%05d, Delta time %d is earned.", ctx->plotter->getDistance(), deltaTimeTarget);
                 earned = true;
             }
             return Status::Success;
@@ -242,71 +294,79 @@ protected:
     bool updated, earned;
 };
 
+/*
+    whether the raw color reads CL_JETBLACK, the crossings that IsColorDetected
+    and Localizer take as landmarks
+*/
+bool isJetBlack(const rgb_raw_t& rgb) {
+    return (rgb.r <=35 && rgb.g <=35 && rgb.b <=50);
+}
+
 /*
     usage:
     ".leaf<IsColorDetected>(color)"
     is to determine if the specified color gets detected.
     For possible color that can be specified as the argument, see enum Color in "appusr.hpp".
 */
-class IsColorDetected : public BrainTree::Node {
+class IsColorDetected : public RobotNode {
 public:
     IsColorDetected(Color c) : color(c) {
         updated = false;
     }
     Status update() override {
         if (!updated) {
-            _log("ODO=%05d, Color detection started.", plotter->getDistance());
+            _log("ODO=%05d, Color detection started.", ctx->plotter->getDistance());
             updated = true;
         }
         rgb_raw_t cur_rgb;
-        colorSensor->getRawColor(cur_rgb);
+        ctx->snapshot->getRawColor(cur_rgb);
 
         switch(color){
             case CL_JETBLACK:
-                if (cur_rgb.r <=35 && cur_rgb.g <=35 && cur_rgb.b <=50) { 
-                    _log("ODO=%05d, CL_JETBLACK detected.", plotter->getDistance());
+                if (isJetBlack(cur_rgb)) {
+                    _log("ODO=%05d, CL_JETBLACK detected.", ctx->plotter->getDistance());
                     return Status::Success;
                 }
                 break;
             case CL_BLACK:
                 if (cur_rgb.r <=50 && cur_rgb.g <=45 && cur_rgb.b <=60) {
-                    _log("ODO=%05d, CL_BLACK detected.", plotter->getDistance());
+                    _log("ODO=%05d, CL_BLACK detected.", ctx->plotter->getDistance());
                     return Status::Success;
                 }
                 break;
             case CL_BLUE:
                 if (cur_rgb.b - cur_rgb.r > 45 && cur_rgb.b <= 255 && cur_rgb.r <= 255) {
-                    _log("ODO=%05d, CL_BLUE detected.", plotter->getDistance());
+                    _log("ODO=%05d, CL_BLUE detected.", ctx->plotter->getDistance());
                     return Status::Success;
                 }
                 break;
             case CL_RED:
                 if (cur_rgb.r - cur_rgb.b >= 40 && cur_rgb.g < 60 && cur_rgb.r - cur_rgb.g > 30) {
-                    _log("ODO=%05d, CL_RED detected.", plotter->getDistance());
+                    _log("ODO=%05d, CL_RED detected.", ctx->plotter->getDistance());
                     return Status::Success;
                 }
                 break;
             case CL_YELLOW:
                 if (cur_rgb.r + cur_rgb.g - cur_rgb.b >= 130 &&  cur_rgb.r - cur_rgb.g <= 30) {
-                    _log("ODO=%05d, CL_YELLOW detected.", plotter->getDistance());
+                    _log("ODO=%05d, CL_YELLOW detected.", ctx->plotter->getDistance());
                     return Status::Success;
                 }
                 break;
             case CL_GREEN:
                 if (cur_rgb.r <= 10 && cur_rgb.b <= 35 && cur_rgb.g > 43) {
-                    _log("ODO=%05d, CL_GREEN detected.", plotter->getDistance());
+                    _log("ODO=%05d, CL_GREEN detected.", ctx->plotter->getDistance());
                     return Status::Success;
                 }
                 break;
             case CL_GRAY:
                 if (cur_rgb.r <=80 && cur_rgb.g <=75 && cur_rgb.b <=105) {
-                    _log("ODO=%05d, CL_GRAY detected.", plotter->getDistance());
+                    _log("ODO=%05d, CL_GRAY detected.", ctx->plotter->getDistance());
                     return Status::Success;
                 }
                 break;
             case CL_WHITE:
                 if (cur_rgb.r >= 82 && cur_rgb.b >= 112 && cur_rgb.g >= 78) {
-                    _log("ODO=%05d, CL_WHITE detected.", plotter->getDistance());
+                    _log("ODO=%05d, CL_WHITE detected.", ctx->plotter->getDistance());
                     return Status::Success;
                 }
                 break;
@@ -331,12 +391,23 @@ protected:
     until the current speed gradually reaches the instructed target speed.
     trace_side = TS_NORMAL   when in R(L) course and tracing the right(left) side of the line.
     trace_side = TS_OPPOSITE when in R(L) course and tracing the left(right) side of the line.
+    The PID control has the conditional anti-windup, which matters only while the steering saturates at speed.
+
+    ".leaf<TraceLine>(speed, target, gainSchedule, srew_rate, trace_side)"
+    instead takes p, i, d from the gain schedule every execution of update(),
+    interpolated by speed and the curvature measured over the last SCH_CURVATURE_DIST millimeter.
 */
-class TraceLine : public BrainTree::Node {
+class TraceLine : public RobotNode {
 public:
-    TraceLine(int s, int t, double p, double i, double d, double srew_rate, TraceSide trace_side) : speed(s),target(t),srewRate(srew_rate),side(trace_side) {
+    TraceLine(int s, int t, double p, double i, double d, double srew_rate, TraceSide trace_side) : speed(s),target(t),schedule(nullptr),srewRate(srew_rate),side(trace_side) {
+        updated = false;
+        ltPid = new PIDcontroller<float>(p, i, d, PERIOD_UPD_TSK, -speed, speed, AW_CONDITIONAL);
+    }
+    TraceLine(int s, int t, const GainSchedule* gs, double srew_rate, TraceSide trace_side) : speed(s),target(t),schedule(gs),srewRate(srew_rate),side(trace_side) {
+        double p, i, d;
         updated = false;
-        ltPid = new PIDcalculator(p, i, d, PERIOD_UPD_TSK, -speed, speed);
+        schedule->lookup(speed, 0.0, p, i, d);
+        ltPid = new PIDcontroller<float>(p, i, d, PERIOD_UPD_TSK, -speed, speed, AW_CONDITIONAL);
     }
     ~TraceLine() {
         delete ltPid;
@@ -344,11 +415,11 @@ public:
     Status update() override {
         if (!updated) {
             /* The following code chunk is to properly set prevXin in SRLF */
-            srlfL->setRate(0.0);
-            leftMotor->setPWM(leftMotor->getPWM());
-            srlfR->setRate(0.0);
-            rightMotor->setPWM(rightMotor->getPWM());
-            _log("ODO=%05d, Trace run started.", plotter->getDistance());
+            ctx->leftMotor->setSrewRate(0.0);
+            ctx->leftMotor->setPWM(ctx->leftMotor->getPWM());
+            ctx->rightMotor->setSrewRate(0.0);
+            ctx->rightMotor->setPWM(ctx->rightMotor->getPWM());
+            _log("ODO=%05d, Trace run started.", ctx->plotter->getDistance());
             updated = true;
         }
 
@@ -356,32 +427,191 @@ public:
         int8_t forward, turn, pwmL, pwmR;
         rgb_raw_t cur_rgb;
 
-        colorSensor->getRawColor(cur_rgb);
+        ctx->snapshot->getRawColor(cur_rgb);
         sensor = cur_rgb.r;
-        /* compute necessary amount of steering by PID control */
+        if (schedule != nullptr) {
+            double p, i, d;
+            /* curvature in 1/m from the heading change in degree over SCH_CURVATURE_DIST mm */
+            double curvature = fabs((double)ctx->plotter->getDegreeChangeOver(SCH_CURVATURE_DIST))
+                               * M_PI * 1000.0 / (180.0 * SCH_CURVATURE_DIST);
+            schedule->lookup(speed, curvature, p, i, d);
+            ltPid->setGains(p, i, d);
+        }
+        /* compute necessary amount of steering by PID control,
+           where the feed-forward is turned into the same sign as the output */
         if (side == TS_NORMAL) {
-            turn = (-1) * _COURSE * ltPid->compute(sensor, (int16_t)target);
+            turn = (-1) * _COURSE * (int16_t)ltPid->compute(sensor, target, (-1) * _COURSE * feedForward());
         } else { /* side == TS_OPPOSITE */
-            turn = _COURSE * ltPid->compute(sensor, (int16_t)target);
+            turn = _COURSE * (int16_t)ltPid->compute(sensor, target, _COURSE * feedForward());
         }
         forward = speed;
         /* steer EV3 by setting different speed to the motors */
         pwmL = forward - turn;
         pwmR = forward + turn;
-        srlfL->setRate(srewRate);
-        leftMotor->setPWM(pwmL);
-        srlfR->setRate(srewRate);
-        rightMotor->setPWM(pwmR);
+        ctx->leftMotor->setSrewRate(srewRate);
+        ctx->leftMotor->setPWM(pwmL);
+        ctx->rightMotor->setSrewRate(srewRate);
+        ctx->rightMotor->setPWM(pwmR);
         return Status::Running;
     }
 protected:
+    /* turn in pwm known in advance, positive to the left */
+    virtual float feedForward() {
+        return 0.0;
+    }
     int speed, target;
-    PIDcalculator* ltPid;
+    PIDcontroller<float>* ltPid;
+    const GainSchedule* schedule;
     double srewRate;
     TraceSide side;
     bool updated;
 };
 
+/*
+    curvature in radian per milimeter, clockwise positive, of the course map
+    at FF_PREVIEW_DIST ahead of the current distance, or zero without the course map
+*/
+double previewCurvature(const RobotContext* ctx, int& cursor) {
+    if (ctx->courseMap->getNumSections() == 0) return 0.0;
+    return ctx->courseMap->getCurvature(ctx->courseMap->seek(ctx->plotter->getDistance() + FF_PREVIEW_DIST, cursor));
+}
+
+/*
+    usage:
+    ".leaf<TraceLineWithPreview>(speed, target, p, i, d, srew_rate, trace_side)"
+    ".leaf<TraceLineWithPreview>(speed, target, gainSchedule, srew_rate, trace_side)"
+    is the same as TraceLine except that the turn to follow the curvature of the course map
+    is fed forward, so that PID control handles only the residual.
+    The course map is looked up at FF_PREVIEW_DIST ahead by a cursor, i.e., O(1) every execution.
+    Without the course map, it is identical to TraceLine.
+*/
+class TraceLineWithPreview : public TraceLine {
+public:
+    using TraceLine::TraceLine;
+protected:
+    float feedForward() override {
+        /* the turn giving the yaw rate of speed * curvature, i.e., (pwmR - pwmL) / 2 */
+        return (float)(-previewCurvature(ctx, cursor) * WHEEL_TREAD * speed / 2.0);
+    }
+    int cursor = 0;
+};
+
+/*
+    usage:
+    ".leaf<TraceLineMPC>(speed, target, srew_rate, trace_side)"
+    is to trace the line at the given speed by model predictive control instead of PID control.
+    The brightness error is converted to the lateral offset by MPC_EDGE_SLOPE,
+    and LineMPC plans the turn over MPC_HORIZON periods ahead,
+    knowing the curvature at FF_PREVIEW_DIST ahead from the course map if loaded.
+    target, srew_rate and trace_side are the same as TraceLine.
+*/
+class TraceLineMPC : public RobotNode {
+public:
+    TraceLineMPC(int s, int t, double srew_rate, TraceSide trace_side) : speed(s),target(t),srewRate(srew_rate),side(trace_side) {
+        updated = false;
+        mpc = new LineMPC(speed * MPC_MMPS_PER_PWM, 2.0 * MPC_MMPS_PER_PWM / WHEEL_TREAD, MPC_SENSOR_AHEAD,
+                          PERIOD_UPD_TSK, speed, MPC_Q_OFFSET, MPC_Q_HEADING, MPC_R_TURN, MPC_R_RATE);
+    }
+    ~TraceLineMPC() {
+        delete mpc;
+    }
+    Status update() override {
+        if (!updated) {
+            /* The following code chunk is to properly set prevXin in SRLF */
+            ctx->leftMotor->setSrewRate(0.0);
+            ctx->leftMotor->setPWM(ctx->leftMotor->getPWM());
+            ctx->rightMotor->setSrewRate(0.0);
+            ctx->rightMotor->setPWM(ctx->rightMotor->getPWM());
+            _log("ODO=%05d, MPC trace run started.", ctx->plotter->getDistance());
+            updated = true;
+        }
+
+        int8_t turn;
+        rgb_raw_t cur_rgb;
+
+        ctx->snapshot->getRawColor(cur_rgb);
+        /* the offset is positive on the side the turn has to be negative for */
+        double offset = (cur_rgb.r - target) / MPC_EDGE_SLOPE;
+        /* the course map gives the curvature clockwise positive, whereas the model takes it
+           positive in the direction of the positive output */
+        double curvature = previewCurvature(ctx, cursor);
+        if (side == TS_NORMAL) {
+            turn = _COURSE * (int16_t)mpc->compute(offset, (-1) * _COURSE * curvature);
+        } else { /* side == TS_OPPOSITE */
+            turn = (-1) * _COURSE * (int16_t)mpc->compute(offset, _COURSE * curvature);
+        }
+        ctx->leftMotor->setSrewRate(srewRate);
+        ctx->leftMotor->setPWM(speed - turn);
+        ctx->rightMotor->setSrewRate(srewRate);
+        ctx->rightMotor->setPWM(speed + turn);
+        return Status::Running;
+    }
+protected:
+    int speed, target;
+    LineMPC* mpc;
+    int cursor = 0;
+    double srewRate;
+    TraceSide side;
+    bool updated;
+};
+
+/*
+    usage:
+    ".leaf<TuneLine>(speed, target, amplitude, rule, trace_side)"
+    is to trace the line at the given speed by relay feedback instead of PID control,
+    which steers by +/-amplitude pwm and oscillates the robot around the target brightness.
+    After RELAY_CYCLES cycles, it logs the ultimate gain and period with p, i, d
+    by the given rule, i.e., TR_ZIEGLER_NICHOLS or TR_TYREUS_LUYBEN,
+    in the format of GAIN_SCHEDULE_FILE for a straight line, and then returns Success.
+    Use on a straight line and keep amplitude small enough for the sensor to stay on the edge.
+*/
+class TuneLine : public RobotNode {
+public:
+    TuneLine(int s, int t, double amplitude, TuningRule r, TraceSide trace_side) : speed(s),target(t),rule(r),side(trace_side) {
+        updated = false;
+        tuner = new RelayTuner(amplitude, RELAY_HYSTERESIS, RELAY_CYCLES, PERIOD_UPD_TSK);
+    }
+    ~TuneLine() {
+        delete tuner;
+    }
+    Status update() override {
+        if (!updated) {
+            ctx->leftMotor->setSrewRate(0.0);
+            ctx->leftMotor->setPWM(ctx->leftMotor->getPWM());
+            ctx->rightMotor->setSrewRate(0.0);
+            ctx->rightMotor->setPWM(ctx->rightMotor->getPWM());
+            _log("ODO=%05d, Relay tuning started.", ctx->plotter->getDistance());
+            updated = true;
+        }
+
+        int8_t turn;
+        rgb_raw_t cur_rgb;
+
+        ctx->snapshot->getRawColor(cur_rgb);
+        if (side == TS_NORMAL) {
+            turn = (-1) * _COURSE * (int16_t)tuner->update(cur_rgb.r - target);
+        } else { /* side == TS_OPPOSITE */
+            turn = _COURSE * (int16_t)tuner->update(cur_rgb.r - target);
+        }
+        if (tuner->isDone()) {
+            double p, i, d;
+            tuner->getGains(rule, p, i, d);
+            _log("ODO=%05d, Relay tuning done: Ku=%f, Tu=%f", ctx->plotter->getDistance(), tuner->getUltimateGain(), tuner->getUltimatePeriod());
+            _log("speed,curvature,p,i,d = %d,0.0,%f,%f,%f", speed, p, i, d);
+            return Status::Success;
+        }
+        ctx->leftMotor->setPWM(speed - turn);
+        ctx->rightMotor->setPWM(speed + turn);
+        return Status::Running;
+    }
+protected:
+    int speed, target;
+    RelayTuner* tuner;
+    TuningRule rule;
+    TraceSide side;
+    bool updated;
+};
+
 /*
     usage:
     ".leaf<RunAsInstructed>(pwm_l, pwm_r, srew_rate)"
@@ -390,7 +620,7 @@ protected:
     srew_rate = 0.5 instructs FilteredMotor to change 1 pwm every two executions of update()
     until the current speed gradually reaches the instructed target speed.
 */
-class RunAsInstructed : public BrainTree::Node {
+class RunAsInstructed : public RobotNode {
 public:
     RunAsInstructed(int pwm_l, int pwm_r, double srew_rate) : pwmL(pwm_l),pwmR(pwm_r),srewRate(srew_rate) {
         updated = false;
@@ -403,17 +633,17 @@ public:
     Status update() override {
         if (!updated) {
             /* The following code chunk is to properly set prevXin in SRLF */
-            srlfL->setRate(0.0);
-            leftMotor->setPWM(leftMotor->getPWM());
-            srlfR->setRate(0.0);
-            rightMotor->setPWM(rightMotor->getPWM());
-            _log("ODO=%05d, Instructed run started.", plotter->getDistance());
+            ctx->leftMotor->setSrewRate(0.0);
+            ctx->leftMotor->setPWM(ctx->leftMotor->getPWM());
+            ctx->rightMotor->setSrewRate(0.0);
+            ctx->rightMotor->setPWM(ctx->rightMotor->getPWM());
+            _log("ODO=%05d, Instructed run started.", ctx->plotter->getDistance());
             updated = true;
         }
-        srlfL->setRate(srewRate);
-        leftMotor->setPWM(pwmL);
-        srlfR->setRate(srewRate);
-        rightMotor->setPWM(pwmR);
+        ctx->leftMotor->setSrewRate(srewRate);
+        ctx->leftMotor->setPWM(pwmL);
+        ctx->rightMotor->setSrewRate(srewRate);
+        ctx->rightMotor->setPWM(pwmR);
         return Status::Running;
     }
 protected:
@@ -422,6 +652,37 @@ protected:
     bool updated;
 };
 
+/*
+    usage:
+    ".leaf<RunAtSpeed>(mmps_l, mmps_r)"
+    is to move the robot at the instructed wheel speeds in mm/s,
+    which SpeedController keeps regardless of the battery voltage and the floor.
+    The speeds are reached without the SRLF; the next node calling setPWM() returns to pwm mode.
+*/
+class RunAtSpeed : public RobotNode {
+public:
+    RunAtSpeed(double mmps_l, double mmps_r) : mmpsL(mmps_l),mmpsR(mmps_r) {
+        updated = false;
+        if (_COURSE == -1) {
+            double mmps = mmpsL;
+            mmpsL = mmpsR;
+            mmpsR = mmps;
+        }
+    }
+    Status update() override {
+        if (!updated) {
+            _log("ODO=%05d, Run at speed started.", ctx->plotter->getDistance());
+            updated = true;
+        }
+        ctx->leftMotor->setSpeed(mmpsL);
+        ctx->rightMotor->setSpeed(mmpsR);
+        return Status::Running;
+    }
+protected:
+    double mmpsL, mmpsR;
+    bool updated;
+};
+
 /*
     usage:
     ".leaf<RotateEV3>(30, speed, srew_rate)"
@@ -430,7 +691,7 @@ protected:
     srew_rate = 0.5 instructs FilteredMotor to change 1 pwm every two executions of update()
     until the current speed gradually reaches the instructed target speed.
 */
-class RotateEV3 : public BrainTree::Node {
+class RotateEV3 : public RobotNode {
 public:
     RotateEV3(int16_t degree, int s, double srew_rate) : deltaDegreeTarget(degree),speed(s),srewRate(srew_rate) {
         updated = false;
@@ -443,18 +704,18 @@ public:
     }
     Status update() override {
         if (!updated) {
-            originalDegree = plotter->getDegree();
-            srlfL->setRate(srewRate);
-            srlfR->setRate(srewRate);
+            originalDegree = ctx->plotter->getDegree();
+            ctx->leftMotor->setSrewRate(srewRate);
+            ctx->rightMotor->setSrewRate(srewRate);
             /* stop the robot at start */
-            leftMotor->setPWM(0);
-            rightMotor->setPWM(0);
-            _log("ODO=%05d, Rotation started. Current degree = %d", plotter->getDistance(), originalDegree);
+            ctx->leftMotor->setPWM(0);
+            ctx->rightMotor->setPWM(0);
+            _log("ODO=%05d, Rotation started. Current degree = %d", ctx->plotter->getDistance(), originalDegree);
             updated = true;
             return Status::Running;
         }
 
-        int16_t deltaDegree = plotter->getDegree() - originalDegree;
+        int16_t deltaDegree = ctx->plotter->getDegree() - originalDegree;
         if (deltaDegree > 180) {
             deltaDegree -= 360;
         } else if (deltaDegree < -180) {
@@ -463,15 +724,15 @@ public:
         if (clockwise * deltaDegree < clockwise * deltaDegreeTarget) {
             if ((srewRate != 0.0) && (clockwise * deltaDegree >= clockwise * deltaDegreeTarget - 5)) {
                 /* when comes to the half-way, start decreazing the speed by tropezoidal motion */    
-                leftMotor->setPWM(clockwise * 3);
-                rightMotor->setPWM(-clockwise * 3);
+                ctx->leftMotor->setPWM(clockwise * 3);
+                ctx->rightMotor->setPWM(-clockwise * 3);
             } else {
-                leftMotor->setPWM(clockwise * speed);
-                rightMotor->setPWM((-clockwise) * speed);
+                ctx->leftMotor->setPWM(clockwise * speed);
+                ctx->rightMotor->setPWM((-clockwise) * speed);
             }
             return Status::Running;
         } else {
-            _log("ODO=%05d, Rotation ended. Current degree = %d", plotter->getDistance(), plotter->getDegree());
+            _log("ODO=%05d, Rotation ended. Current degree = %d", ctx->plotter->getDistance(), ctx->plotter->getDegree());
             return Status::Success;
         }
     }
@@ -482,20 +743,90 @@ private:
     double srewRate;
 };
 
+/*
+    TrackTrajectory is the base of RotateByTrajectory and MoveByTrajectory.
+    Both wheels follow a Trajectory of the wheel travel, the right wheel in dir_r,
+    by the velocity mode of FilteredMotor with the position error fed back from the encoders.
+    The motors are left holding the position at the end.
+*/
+class TrackTrajectory : public RobotNode {
+public:
+    TrackTrajectory(double travel, int dir_r, double vmax) : trj(vmax, TRJ_AMAX, TRJ_JMAX),travelL(travel),dirR(dir_r) {
+        updated = false;
+    }
+    Status update() override {
+        if (!updated) {
+            trj.plan(travelL);
+            originalTime = ctx->snapshot->getTime();
+            originalCountL = ctx->snapshot->getAngL();
+            originalCountR = ctx->snapshot->getAngR();
+            _log("ODO=%05d, Trajectory started. Current degree = %d, duration = %dms", ctx->plotter->getDistance(),
+                 ctx->plotter->getDegree(), (int)(trj.getDuration() * 1000.0));
+            updated = true;
+        }
+        double t = (ctx->snapshot->getTime() - originalTime) / 1000000.0, pos, vel;
+        trj.sample(t, pos, vel);
+        double errL = pos - (ctx->snapshot->getAngL() - originalCountL) * DIST_PER_DEGREE;
+        double errR = dirR * pos - (ctx->snapshot->getAngR() - originalCountR) * DIST_PER_DEGREE;
+        if (t >= trj.getDuration() &&
+            ((fabs(errL) <= TRJ_TOLERANCE && fabs(errR) <= TRJ_TOLERANCE) || t >= trj.getDuration() + TRJ_SETTLE_TIME)) {
+            ctx->leftMotor->setSpeed(0.0);
+            ctx->rightMotor->setSpeed(0.0);
+            _log("ODO=%05d, Trajectory ended. Current degree = %d, error = %dmm, %dmm", ctx->plotter->getDistance(),
+                 ctx->plotter->getDegree(), (int)errL, (int)errR);
+            return Status::Success;
+        }
+        ctx->leftMotor->setSpeed(vel + TRJ_KP * errL);
+        ctx->rightMotor->setSpeed(dirR * vel + TRJ_KP * errR);
+        return Status::Running;
+    }
+protected:
+    Trajectory trj;
+    double travelL;
+    int dirR;
+    uint32_t originalTime;
+    int32_t originalCountL, originalCountR;
+    bool updated;
+};
+
+/*
+    usage:
+    ".leaf<RotateByTrajectory>(90, vmax)"
+    is to rotate robot 90 degrees (=clockwise) by the fastest profile with
+    the wheel speed up to vmax mm/s, and TRJ_AMAX and TRJ_JMAX, stopping within a degree.
+*/
+class RotateByTrajectory : public TrackTrajectory {
+public:
+    RotateByTrajectory(int16_t degree, double vmax) : TrackTrajectory(degree * M_PI / 180.0 * WHEEL_TREAD / 2.0, -1, vmax) {
+        assert(degree >= -180 && degree <= 180);
+    }
+};
+
+/*
+    usage:
+    ".leaf<MoveByTrajectory>(300, vmax)"
+    is to move the robot 300 mm straight (negative to back) by the fastest profile with
+    the wheel speed up to vmax mm/s, and TRJ_AMAX and TRJ_JMAX.
+*/
+class MoveByTrajectory : public TrackTrajectory {
+public:
+    MoveByTrajectory(int32_t distance, double vmax) : TrackTrajectory(distance, 1, vmax) {}
+};
+
 /*
     usage:
     ".leaf<SetArmPosition>(target_degree, pwm)"
     is to shift the robot arm to the specified degree by the spefied power.
 */
-class SetArmPosition : public BrainTree::Node {
+class SetArmPosition : public RobotNode {
 public:
     SetArmPosition(int32_t target_degree, int pwm) : targetDegree(target_degree),pwmA(pwm) {
         updated = false;
     }
     Status update() override {
-        int32_t currentDegree = armMotor->getCount();
+        int32_t currentDegree = ctx->snapshot->getArmCount();
         if (!updated) {
-            _log("ODO=%05d, Arm position is moving from %d to %d.", plotter->getDistance(), currentDegree, targetDegree);
+            _log("ODO=%05d, Arm position is moving from %d to %d.", ctx->plotter->getDistance(), currentDegree, targetDegree);
             if (currentDegree == targetDegree) {
                 return Status::Success; /* do nothing */
             } else if (currentDegree < targetDegree) {
@@ -503,14 +834,14 @@ public:
             } else {
                 clockwise = -1;
             }
-            armMotor->setPWM(clockwise * pwmA);
+            ctx->armMotor->setPWM(clockwise * pwmA);
             updated = true;
             return Status::Running;
         }
         if (((clockwise ==  1) && (currentDegree >= targetDegree)) ||
             ((clockwise == -1) && (currentDegree <= targetDegree))) {
-            armMotor->setPWM(0);
-            _log("ODO=%05d, Arm position set to %d.", plotter->getDistance(), currentDegree);
+            ctx->armMotor->setPWM(0);
+            _log("ODO=%05d, Arm position set to %d.", ctx->plotter->getDistance(), currentDegree);
             return Status::Success;
         } else {
             return Status::Running;
@@ -527,10 +858,85 @@ private:
 */
 
 
+/*
+    === STATE MACHINE DEFINITION STARTS HERE ===
+    The robot behavior is defined using HFSM (Hierarchical Finite State Machine) with two hierarchies as a whole where:
+    - The upper layer is implemented as a state machine by the tables here.
+    - The lower layer is implemented using Behavior Tree where each tree gets traversed within each corresponding state of the state machine.
+    Adding a state is adding a row to each table, see StateTable.
+*/
+
+/* wake up the main task to end the run */
+void wake_main() {
+    _log("waking up main...");
+    ER ercd = wup_tsk(MAIN_TASK);
+    assert(ercd == E_OK);
+    if (ercd != E_OK) {
+        syslog(LOG_NOTICE, "wup_tsk() returned %d", ercd);
+    }
+}
+
+/* stop the robot as StopNow but without srew */
+void stop_now() {
+    robot.leftMotor->setSrewRate(0.0);
+    robot.leftMotor->setPWM(0);
+    robot.rightMotor->setSrewRate(0.0);
+    robot.rightMotor->setPWM(0);
+    syslog(LOG_NOTICE, "robot stopped by abort.");
+}
+
+constexpr Transition transitions[ST_NUM][EV_NUM] = {
+    /*                     EV_START                     EV_TICK                EV_SUCCESS                                    EV_FAILURE              EV_ABORT */
+    /* ST_INITIAL     */ { { ST_CALIBRATION, nullptr }, { STT_STAY, nullptr }, { STT_STAY, nullptr },                        { STT_STAY, nullptr },  { ST_ENDING, nullptr } },
+    /* ST_CALIBRATION */ { { STT_STAY, nullptr },       { STT_STAY, nullptr }, { (JUMP == 1) ? ST_BLOCK : ST_RUN, nullptr }, { ST_ENDING, nullptr }, { ST_ENDING, stop_now } },
+    /* ST_RUN         */ { { STT_STAY, nullptr },       { STT_STAY, nullptr }, { ST_BLOCK, nullptr },                        { ST_ENDING, nullptr }, { ST_ENDING, stop_now } },
+    /* ST_BLOCK       */ { { STT_STAY, nullptr },       { STT_STAY, nullptr }, { ST_ENDING, nullptr },                       { ST_ENDING, nullptr }, { ST_ENDING, stop_now } },
+    /* ST_ENDING      */ { { STT_STAY, nullptr },       { ST_END, nullptr },   { ST_END, nullptr },                          { ST_END, nullptr },    { STT_STAY, nullptr } },
+    /* ST_END         */ { { STT_STAY, nullptr },       { STT_STAY, nullptr }, { STT_STAY, nullptr },                        { STT_STAY, nullptr },  { STT_STAY, nullptr } },
+};
+
+constexpr StateHooks hooks[ST_NUM] = {
+    /*                  entry        exit */
+    /* ST_INITIAL     */ { nullptr,   nullptr },
+    /* ST_CALIBRATION */ { nullptr,   nullptr },
+    /* ST_RUN         */ { nullptr,   nullptr },
+    /* ST_BLOCK       */ { nullptr,   nullptr },
+    /* ST_ENDING      */ { wake_main, nullptr },
+    /* ST_END         */ { nullptr,   nullptr },
+};
+
+/* the behavior tree traversed in each state, or nullptr */
+BrainTree::BehaviorTree* const* const trees[ST_NUM] = {
+    nullptr, &tr_calibration, &tr_run, &tr_block, nullptr, nullptr,
+};
+
+/* names for printing the trace only */
+const char* const stateNames[ST_NUM] = {
+    STR(ST_INITIAL), STR(ST_CALIBRATION), STR(ST_RUN), STR(ST_BLOCK), STR(ST_ENDING), STR(ST_END),
+};
+const char* const eventNames[EV_NUM] = {
+    STR(EV_START), STR(EV_TICK), STR(EV_SUCCESS), STR(EV_FAILURE), STR(EV_ABORT),
+};
+
+/*
+    === STATE MACHINE DEFINITION ENDS HERE ===
+*/
+
+/* the default policy against consecutive overruns of UPD_TSK */
+OverrunAction overrun_policy(uint32_t consecutive) {
+    if (consecutive >= OVR_STOP_AFTER) {
+        return OVR_SAFE_STOP;
+    } else if (consecutive >= OVR_SHED_AFTER) {
+        return OVR_SHED_LOG;
+    } else {
+        return OVR_SKIP_TICK;
+    }
+}
+
 /* a cyclic handler to activate a task */
 void task_activator(intptr_t tskid) {
     ER ercd = act_tsk(tskid);
-    assert(ercd == E_OK || E_QOVR);
+    assert(ercd == E_OK || ercd == E_QOVR);
     if (ercd != E_OK) {
         syslog(LOG_NOTICE, "act_tsk() returned %d", ercd);
     }
@@ -543,15 +949,38 @@ void main_task(intptr_t unused) {
     //assert(bt != NULL);
     /* create and initialize EV3 objects */
     ev3clock    = new Clock();
-    touchSensor = new TouchSensor(PORT_1);
+    robot.clock       = ev3clock;
+    robot.touchSensor = new TouchSensor(PORT_1);
     // temp fix 2022/6/20 W.Taniguchi, new SonarSensor() blocks apparently
-    //sonarSensor = new SonarSensor(PORT_3);
-    colorSensor = new FilteredColorSensor(PORT_2);
-    gyroSensor  = new GyroSensor(PORT_4);
-    leftMotor   = new FilteredMotor(PORT_C);
-    rightMotor  = new FilteredMotor(PORT_B);
-    armMotor    = new Motor(PORT_A);
-    plotter     = new Plotter(leftMotor, rightMotor, gyroSensor);
+    //robot.sonarSensor = new SonarSensor(PORT_3);
+    robot.colorSensor = new FilteredColorSensor(PORT_2);
+    robot.gyroSensor  = new GyroSensor(PORT_4);
+    robot.leftMotor   = new FilteredMotor(PORT_C);
+    robot.rightMotor  = new FilteredMotor(PORT_B);
+    robot.armMotor    = new Motor(PORT_A);
+    robot.plotter     = new Plotter(robot.leftMotor, robot.rightMotor, robot.gyroSensor);
+    robot.snapshot    = new SensorSnapshot(ev3clock, robot.touchSensor, robot.sonarSensor, robot.colorSensor, robot.gyroSensor, robot.leftMotor, robot.rightMotor, robot.armMotor);
+    monClock    = new Clock();
+    updMonitor  = new DeadlineMonitor(PERIOD_UPD_TSK, overrun_policy);
+    ctlMonitor  = new DeadlineMonitor(PERIOD_CTL_TSK, nullptr);
+#if defined(MULTI_RATE)
+    sensed      = new SensorSnapshot(*robot.snapshot);
+    logged      = new SensorSnapshot(*robot.snapshot);
+    snapshots   = new DoubleBuffer<SensorSnapshot>(*robot.snapshot);
+#endif
+    robot.courseMap   = new CourseMap();
+    if (robot.courseMap->load(COURSE_FILE)) {
+        robot.localizer = new Localizer(robot.plotter, robot.courseMap);
+        _log("course map %s loaded with %d sections.", COURSE_FILE, robot.courseMap->getNumSections());
+    } else {
+        _log("course map %s not loaded, Localizer disabled.", COURSE_FILE);
+    }
+    gainSchedule = new GainSchedule(P_CONST, I_CONST, D_CONST);
+    if (gainSchedule->load(GAIN_SCHEDULE_FILE)) {
+        _log("gain schedule %s loaded.", GAIN_SCHEDULE_FILE);
+    } else {
+        _log("gain schedule %s not loaded, P_CONST/I_CONST/D_CONST used.", GAIN_SCHEDULE_FILE);
+    }
 
     /* FIR parameters for a low-pass filter with normalized cut-off frequency of 0.2
         using a function of the Hamming Window */
@@ -561,17 +990,27 @@ void main_task(intptr_t unused) {
     Filter *lpf_r = new FIR_Transposed(hn, FIR_ORDER);
     Filter *lpf_g = new FIR_Transposed(hn, FIR_ORDER);
     Filter *lpf_b = new FIR_Transposed(hn, FIR_ORDER);
-    colorSensor->setRawColorFilters(lpf_r, lpf_g, lpf_b);
+    robot.colorSensor->setRawColorFilters(lpf_r, lpf_g, lpf_b);
 
-    leftMotor->reset();
+    robot.leftMotor->reset();
     srlfL = new SRLF(0.0);
-    leftMotor->setPWMFilter(srlfL);
-    leftMotor->setPWM(0);
-    rightMotor->reset();
+    robot.leftMotor->setPWMFilter(srlfL);
+    robot.leftMotor->setPWM(0);
+    robot.rightMotor->reset();
     srlfR = new SRLF(0.0);
-    rightMotor->setPWMFilter(srlfR);
-    rightMotor->setPWM(0);
-    armMotor->reset();
+    robot.rightMotor->setPWMFilter(srlfR);
+    robot.rightMotor->setPWM(0);
+#if defined(MOTOR_MODEL)
+    modelL = new MotorModel(MOTOR_DEADBAND, MOTOR_BACKLASH, MOTOR_BACKLASH_PWM, MOTOR_NOMINAL_MV);
+    robot.leftMotor->setMotorModel(modelL);
+    modelR = new MotorModel(MOTOR_DEADBAND, MOTOR_BACKLASH, MOTOR_BACKLASH_PWM, MOTOR_NOMINAL_MV);
+    robot.rightMotor->setMotorModel(modelR);
+#endif
+    speedL = new SpeedController(SPEED_KP, SPEED_KI, SPEED_PWM_PER_MMPS, DIST_PER_DEGREE, PERIOD_DRIVE);
+    robot.leftMotor->setSpeedController(speedL);
+    speedR = new SpeedController(SPEED_KP, SPEED_KI, SPEED_PWM_PER_MMPS, DIST_PER_DEGREE, PERIOD_DRIVE);
+    robot.rightMotor->setSpeedController(speedR);
+    robot.armMotor->reset();
 
 /*
     === BEHAVIOR TREE DEFINITION STARTS HERE ===
@@ -579,12 +1018,13 @@ void main_task(intptr_t unused) {
 */
 
     /* robot starts when touch sensor is turned on */
-    tr_calibration = (BrainTree::BehaviorTree*) BrainTree::Builder()
+    tr_calibration = (BrainTree::BehaviorTree*) BrainTree::Builder(&robot)
         .composite<BrainTree::MemSequence>()
             // temp fix 2022/6/20 W.Taniguchi, as no touch sensor available on RasPike
             //.decorator<BrainTree::UntilSuccess>()
             //    .leaf<IsTouchOn>()
             //.end()
+            .leaf<IsTimeEarned>(100000) // let the FIR of the color sensor settle, or CL_JETBLACK is detected at once
             .leaf<ResetClock>()
         .end()
         .build();
@@ -598,12 +1038,28 @@ void main_task(intptr_t unused) {
     #endif
 */ 
 
-#if defined(MAKE_RIGHT) /* BEHAVIOR FOR THE RIGHT COURSE STARTS HERE */
+#if defined(MAKE_TUNE) /* RELAY AUTO-TUNING ON A STRAIGHT LINE STARTS HERE */
+    tr_run = (BrainTree::BehaviorTree*) BrainTree::Builder(&robot)
+        .composite<BrainTree::ParallelSequence>(1,2)
+            .leaf<IsBackOn>()
+            .composite<BrainTree::MemSequence>()
+                .composite<BrainTree::ParallelSequence>(1,2)
+                   .leaf<IsTimeEarned>(1000000)
+                   .leaf<TraceLine>(SPEED_NORM, GS_TARGET, P_CONST, I_CONST, D_CONST, 0.0, TS_NORMAL)
+                .end()
+                .leaf<TuneLine>(SPEED_NORM, GS_TARGET, 5.0, TR_TYREUS_LUYBEN, TS_NORMAL)
+                .leaf<StopNow>()
+            .end()
+        .end()
+        .build();
+    tr_block = nullptr;
+
+#elif defined(MAKE_RIGHT) /* BEHAVIOR FOR THE RIGHT COURSE STARTS HERE */
     tr_run = nullptr;
     tr_block = nullptr;
 
 #else /* BEHAVIOR FOR THE LEFT COURSE STARTS HERE */
-tr_run = (BrainTree::BehaviorTree*) BrainTree::Builder()
+tr_run = (BrainTree::BehaviorTree*) BrainTree::Builder(&robot)
         .composite<BrainTree::ParallelSequence>(1,2)
             .leaf<IsBackOn>()
             .composite<BrainTree::MemSequence>()
@@ -678,7 +1134,7 @@ tr_run = (BrainTree::BehaviorTree*) BrainTree::Builder()
         .end()
         .build();
 
-    tr_block = (BrainTree::BehaviorTree*) BrainTree::Builder()
+    tr_block = (BrainTree::BehaviorTree*) BrainTree::Builder(&robot)
         .composite<BrainTree::MemSequence>()
             .leaf<StopNow>()
             .leaf<IsTimeEarned>(3000000) // wait 3 seconds
@@ -690,19 +1146,28 @@ tr_run = (BrainTree::BehaviorTree*) BrainTree::Builder()
         .end()
         .build();
 
-#endif /* if defined(MAKE_RIGHT) */
+#endif /* if defined(MAKE_TUNE) */
 
 /*
     === BEHAVIOR TREE DEFINITION ENDS HERE ===
 */
 
+    hfsm = new StateTable<ST_NUM, EV_NUM>(transitions, hooks, ST_INITIAL);
+    hfsm->dispatch(EV_START, ev3clock->now());
+
     /* register cyclic handler to EV3RT */
+#if defined(PLOT_HIGH_RATE)
+    sta_cyc(CYC_PLT_TSK);
+#endif
+#if defined(MULTI_RATE)
+    sta_cyc(CYC_CTL_TSK);
+    sta_cyc(CYC_LOG_TSK);
+#endif
     sta_cyc(CYC_UPD_TSK);
 
     /* indicate initialization completion by LED color */
     _log("initialization completed.");
     ev3_led_set_color(LED_ORANGE);
-    state = ST_CALIBRATION;
 
     /* the main task sleep until being waken up and let the registered cyclic handler to traverse the behavir trees */
     _log("going to sleep...");
@@ -714,6 +1179,23 @@ tr_run = (BrainTree::BehaviorTree*) BrainTree::Builder()
 
     /* deregister cyclic handler from EV3RT */
     stp_cyc(CYC_UPD_TSK);
+#if defined(MULTI_RATE)
+    stp_cyc(CYC_LOG_TSK);
+    stp_cyc(CYC_CTL_TSK);
+#endif
+#if defined(PLOT_HIGH_RATE)
+    stp_cyc(CYC_PLT_TSK);
+#endif
+    for (int i = 0; i < hfsm->getTraceCount(); i++) {
+        const TraceRecord& r = hfsm->getTrace(i);
+        _log("%08u: %s to %s by %s", r.time, stateNames[r.from], stateNames[r.to], eventNames[r.event]);
+    }
+    _log("UPD_TSK: %u activations, %u overruns, max %uus", updMonitor->getActivations(),
+         updMonitor->getOverruns(), updMonitor->getMaxExecTime());
+#if defined(MULTI_RATE)
+    _log("CTL_TSK: %u activations, %u overruns, max %uus", ctlMonitor->getActivations(),
+         ctlMonitor->getOverruns(), ctlMonitor->getMaxExecTime());
+#endif
     /* destroy behavior tree */
     delete tr_block;
     delete tr_run;
@@ -722,14 +1204,31 @@ tr_run = (BrainTree::BehaviorTree*) BrainTree::Builder()
     delete lpf_b;
     delete lpf_g;
     delete lpf_r;
-    delete plotter;
-    delete armMotor;
-    delete rightMotor;
-    delete leftMotor;
-    delete gyroSensor;
-    delete colorSensor;
-    delete sonarSensor;
-    delete touchSensor;
+    delete speedR;
+    delete speedL;
+    delete modelR;
+    delete modelL;
+    delete hfsm;
+    delete ctlMonitor;
+    delete updMonitor;
+    delete monClock;
+    delete snapshots;
+    delete logged;
+    delete sensed;
+    delete robot.snapshot;
+    delete gainSchedule;
+    delete robot.localizer;
+    delete robot.courseMap;
+    delete robot.plotter;
+    delete robot.armMotor;
+    delete robot.rightMotor;
+    delete robot.leftMotor;
+    delete srlfR;
+    delete srlfL;
+    delete robot.gyroSensor;
+    delete robot.colorSensor;
+    delete robot.sonarSensor;
+    delete robot.touchSensor;
     delete ev3clock;
     _log("being terminated...");
     // temp fix 2022/6/20 W.Taniguchi, as Bluetooth not implemented yet
@@ -740,99 +1239,96 @@ tr_run = (BrainTree::BehaviorTree*) BrainTree::Builder()
     ext_tsk();
 }
 
+/* high-rate periodic task to integrate odometry, effective only when PLOT_HIGH_RATE is defined */
+void plotter_task(intptr_t unused) {
+    if (robot.plotter != nullptr) robot.plotter->plot();
+}
+
 /* periodic task to update the behavior tree */
 void update_task(intptr_t unused) {
-    BrainTree::Node::Status status;
-    ER ercd;
+    OverrunAction action = updMonitor->begin(monClock->now());
+    /* keep logging shed until UPD_TSK runs as usual and ends in time again */
+    logShed = (updMonitor->getDegraded() >= OVR_SHED_LOG);
 
-    colorSensor->sense();
-    plotter->plot();
+#if defined(MULTI_RATE)
+    /* sensed and plotted by CTL_TSK */
+    snapshots->read(*robot.snapshot);
+#else
+    robot.colorSensor->sense();
+    robot.snapshot->acquire();
+#if !defined(PLOT_HIGH_RATE)
+    robot.plotter->plot(robot.snapshot->getAngL(), robot.snapshot->getAngR());
+#endif
+#endif
+    if (robot.localizer != nullptr) {
+        /* CL_JETBLACK crossings serve as landmarks, see isJetBlack() */
+        rgb_raw_t cur_rgb;
+        robot.snapshot->getRawColor(cur_rgb);
+        robot.localizer->update(isJetBlack(cur_rgb));
+    }
 
-/*
-    === STATE MACHINE DEFINITION STARTS HERE ===
-    The robot behavior is defined using HFSM (Hierarchical Finite State Machine) with two hierarchies as a whole where:
-    - The upper layer is implemented as a state machine here.
-    - The lower layer is implemented using Behavior Tree where each tree gets traversed within each corresponding state of the state machine.
-*/
-    switch (state) {
-    case ST_CALIBRATION:
-        if (tr_calibration != nullptr) {
-            status = tr_calibration->update();
-            switch (status) {
-            case BrainTree::Node::Status::Success:
-                switch (JUMP) { /* JUMP = 1... is for testing only */
-                    case 1:
-                        state = ST_BLOCK;
-                        _log("State changed: ST_CALIBRATION to ST_BLOCK");
-                        break;
-                    default:
-                        state = ST_RUN;
-                        _log("State changed: ST_CALIBRATION to ST_RUN");
-                        break;
-                }
-                break;
-            case BrainTree::Node::Status::Failure:
-                state = ST_ENDING;
-                _log("State changed: ST_CALIBRATION to ST_ENDING");
-                break;
-            default:
-                break;
-            }
-        }
-        break;
-    case ST_RUN:
-        if (tr_run != nullptr) {
-            status = tr_run->update();
-            switch (status) {
+    if (action == OVR_SAFE_STOP) {
+        syslog(LOG_NOTICE, "%u consecutive overruns.", updMonitor->getConsecutive());
+        hfsm->dispatch(EV_ABORT, ev3clock->now());
+    }
+    /* traverse the tree of the state and pass its status to the state machine,
+       except in the tick after an overrun, which skips the tree to catch up */
+    if (action == OVR_NONE || action == OVR_SAFE_STOP) {
+        BrainTree::BehaviorTree* const* tree = trees[hfsm->getState()];
+        Event event = EV_TICK;
+        if (tree != nullptr && *tree != nullptr) {
+            switch ((*tree)->update()) {
             case BrainTree::Node::Status::Success:
-                state = ST_BLOCK;
-                _log("State changed: ST_RUN to ST_BLOCK");
+                event = EV_SUCCESS;
                 break;
             case BrainTree::Node::Status::Failure:
-                state = ST_ENDING;
-                _log("State changed: ST_RUN to ST_ENDING");
+                event = EV_FAILURE;
                 break;
             default:
                 break;
             }
         }
-        break;
-    case ST_BLOCK:
-        if (tr_block != nullptr) {
-            status = tr_block->update();
-            switch (status) {
-            case BrainTree::Node::Status::Success:
-            case BrainTree::Node::Status::Failure:
-                state = ST_ENDING;
-                _log("State changed: ST_BLOCK to ST_ENDING");
-                break;
-            default:
-                break;
-            }
-        }
-        break;
-    case ST_ENDING:
-        _log("waking up main...");
-        /* wake up the main task */
-        ercd = wup_tsk(MAIN_TASK);
-        assert(ercd == E_OK);
-        if (ercd != E_OK) {
-            syslog(LOG_NOTICE, "wup_tsk() returned %d", ercd);
-        }
-        state = ST_END;
-        _log("State changed: ST_ENDING to ST_END");
-        break;    
-    case ST_INITIAL:    /* do nothing */
-    case ST_END:        /* do nothing */
-    default:            /* do nothing */
-        break;
+        hfsm->dispatch(event, ev3clock->now());
     }
-/*
-    === STATE MACHINE DEFINITION ENDS HERE ===
-*/
 
-    rightMotor->drive();
-    leftMotor->drive();
+#if !defined(MULTI_RATE)
+    if (modelL != nullptr) {
+        modelL->setBattery(robot.snapshot->getBatteryVoltage());
+        modelR->setBattery(robot.snapshot->getBatteryVoltage());
+    }
+    robot.rightMotor->drive(robot.snapshot->getAngR());
+    robot.leftMotor->drive(robot.snapshot->getAngL());
+#endif
 
     //logger->outputLog(LOG_INTERVAL);
+    updMonitor->end(monClock->now());
+}
+
+/* high-rate periodic task to sense, plot and drive the wheels, effective only when MULTI_RATE is defined */
+void control_task(intptr_t unused) {
+    ctlMonitor->begin(monClock->now());
+    robot.colorSensor->sense();
+    sensed->acquire();
+    robot.plotter->plot(sensed->getAngL(), sensed->getAngR());
+    snapshots->write(*sensed);
+    if (modelL != nullptr) {
+        modelL->setBattery(sensed->getBatteryVoltage());
+        modelR->setBattery(sensed->getBatteryVoltage());
+    }
+    /* MotorCommand by UPD_TSK are latched here */
+    robot.rightMotor->drive(sensed->getAngR());
+    robot.leftMotor->drive(sensed->getAngL());
+    ctlMonitor->end(monClock->now());
+}
+
+/* low-priority periodic task to print telemetry including overruns, effective only when MULTI_RATE is defined;
+   shed by logShed along with _log() */
+void log_task(intptr_t unused) {
+    rgb_raw_t cur_rgb;
+    snapshots->read(*logged);
+    logged->getRawColor(cur_rgb);
+    _log("snapshot#%u, t=%u, odo=%05d, deg=%03d, pwm=%d,%d, rgb=%d,%d,%d, mV=%d, ovr=%u/%u, exec=%u/%uus",
+         snapshots->getWrites(), logged->getTime(), robot.plotter->getDistance(), robot.plotter->getDegree(),
+         robot.leftMotor->getPWM(), robot.rightMotor->getPWM(), cur_rgb.r, cur_rgb.g, cur_rgb.b, logged->getBatteryVoltage(),
+         updMonitor->getOverruns(), ctlMonitor->getOverruns(), updMonitor->getLastExecTime(), ctlMonitor->getLastExecTime());
 }
\ No newline at end of file
@@ -15,11 +15,17 @@ extern "C" {
 #include "target_test.h"
 
 /* task priorities (smaller number has higher priority) */
-#define PRIORITY_UPD_TSK    TMIN_APP_TPRI
-#define PRIORITY_MAIN_TASK  (TMIN_APP_TPRI + 1)
+#define PRIORITY_CTL_TSK    TMIN_APP_TPRI
+#define PRIORITY_PLT_TSK    TMIN_APP_TPRI
+#define PRIORITY_UPD_TSK    (TMIN_APP_TPRI + 1)
+#define PRIORITY_MAIN_TASK  (TMIN_APP_TPRI + 2)
+#define PRIORITY_LOG_TSK    (TMIN_APP_TPRI + 3)
 
 /* task periods in micro seconds */
 #define PERIOD_UPD_TSK  (10 * 1000)
+#define PERIOD_PLT_TSK  ( 2 * 1000)  /* effective only when PLOT_HIGH_RATE is defined */
+#define PERIOD_CTL_TSK  ( 4 * 1000)  /* effective only when MULTI_RATE is defined */
+#define PERIOD_LOG_TSK  (100 * 1000) /* effective only when MULTI_RATE is defined */
 
 /* default task stack size in bytes */
 #ifndef STACK_SIZE
@@ -31,6 +37,9 @@ extern "C" {
 
 extern void main_task(intptr_t unused);
 extern void update_task(intptr_t unused);
+extern void plotter_task(intptr_t unused);
+extern void control_task(intptr_t unused);
+extern void log_task(intptr_t unused);
 extern void task_activator(intptr_t tskid);
 
 #endif /* TOPPERS_MACRO_ONLY */
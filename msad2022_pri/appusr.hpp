@@ -25,25 +25,30 @@ using namespace ev3api;
 #include <math.h>
 
 #include "FilteredMotor.hpp"
+#include "MotorModel.hpp"
+#include "SpeedController.hpp"
+#include "Trajectory.hpp"
 #include "SRLF.hpp"
 #include "FilteredColorSensor.hpp"
 #include "FIR.hpp"
 #include "Plotter.hpp"
 #include "PIDcalculator.hpp"
+#include "PIDcontroller.hpp"
+#include "CourseMap.hpp"
+#include "Localizer.hpp"
+#include "SensorSnapshot.hpp"
+#include "DoubleBuffer.hpp"
+#include "DeadlineMonitor.hpp"
+#include "StateTable.hpp"
+#include "GainSchedule.hpp"
+#include "RelayTuner.hpp"
+#include "LineMPC.hpp"
+#include "RobotContext.hpp"
 
-/* global variables */
+/* global variables; the devices are in RobotContext */
 extern FILE*        bt;
 extern Clock*       ev3clock;
-extern TouchSensor* touchSensor;
-extern SonarSensor* sonarSensor;
-extern FilteredColorSensor* colorSensor;
-extern GyroSensor*  gyroSensor;
-extern SRLF*        srlf_l;
-extern FilteredMotor*       leftMotor;
-extern SRLF*        srlf_r;
-extern FilteredMotor*       rightMotor;
-extern Motor*       armMotor;
-extern Plotter*     plotter;
+extern bool         logShed;
 
 #define DEBUG
 
@@ -56,15 +61,16 @@ extern Plotter*     plotter;
 //#define LOG_ON_CONSOL
 
 /* ##__VA_ARGS__ is gcc proprietary extention.
-   this is also where -std=gnu++11 option is necessary */
+   this is also where -std=gnu++11 option is necessary;
+   logShed is set while UPD_TSK sheds logging against overruns */
 #ifdef LOG_ON_CONSOL
 #define _log(fmt, ...) \
-    syslog(LOG_NOTICE, "%08u, %s: " fmt, \
-    ev3clock->now(), __PRETTY_FUNCTION__, ##__VA_ARGS__)
+    do { if (!logShed) syslog(LOG_NOTICE, "%08u, %s: " fmt, \
+    ev3clock->now(), __PRETTY_FUNCTION__, ##__VA_ARGS__); } while (0)
 #else
 #define _log(fmt, ...) \
-    printf("%08u, %s: " fmt "\n", \
-    ev3clock->now(), __PRETTY_FUNCTION__, ##__VA_ARGS__)
+    do { if (!logShed) printf("%08u, %s: " fmt "\n", \
+    ev3clock->now(), __PRETTY_FUNCTION__, ##__VA_ARGS__); } while (0)
     // temp fix 2022/6/20 W.Taniguchi, as Bluetooth not implemented yet
     /* fprintf(bt, "%08u, %s: " fmt "\n", \ */
 #endif
@@ -99,6 +105,126 @@ extern Plotter*     plotter;
 #define JUMP                    0
 #endif
 
+/* define PLOT_HIGH_RATE, e.g., -DPLOT_HIGH_RATE, to integrate odometry
+   in PLT_TSK every PERIOD_PLT_TSK instead of every PERIOD_UPD_TSK         */
+
+/* define MULTI_RATE, e.g., -DMULTI_RATE, to split the work of UPD_TSK into
+   CTL_TSK sensing, plotting and driving the wheels every PERIOD_CTL_TSK,
+   UPD_TSK traversing the behavior trees every PERIOD_UPD_TSK, and
+   LOG_TSK printing telemetry every PERIOD_LOG_TSK, which exchange
+   SensorSnapshot and MotorCommand through DoubleBuffer.
+   Note that srew rates of SRLF then apply every PERIOD_CTL_TSK
+   and the pose history of Plotter covers POSE_HISTORY_SIZE * PERIOD_CTL_TSK  */
+#if defined(MULTI_RATE)
+#if defined(PLOT_HIGH_RATE)
+#error "MULTI_RATE plots in CTL_TSK and excludes PLOT_HIGH_RATE"
+#endif
+#define PERIOD_DRIVE            PERIOD_CTL_TSK
+#else
+#define PERIOD_DRIVE            PERIOD_UPD_TSK
+#endif
+
+/* consecutive overruns of UPD_TSK, i.e., without a clean tick in between,
+   from which overrun_policy() sheds logging and stops the run; a single overrun
+   skips the behavior tree in the next tick, see DeadlineMonitor                */
+#ifndef OVR_SHED_AFTER
+#define OVR_SHED_AFTER          3
+#endif
+#ifndef OVR_STOP_AFTER
+#define OVR_STOP_AFTER          10
+#endif
+
+/* course map for Localizer in the format of aflac2020/BlindRunner_prop.txt;
+   Localizer is disabled when the file is not found, as on the robot, where
+   no course file is shipped yet; hostsim/course_L.txt is the simulated one */
+#ifndef COURSE_FILE
+#if defined(MAKE_RIGHT)
+#define COURSE_FILE             "course_R.txt"
+#else
+#define COURSE_FILE             "course_L.txt"
+#endif
+#endif
+
+/* PID gains by speed and curvature for TraceLine, see GainSchedule.hpp for the format;
+   a flat schedule of P_CONST, I_CONST and D_CONST is used when the file is not found */
+#ifndef GAIN_SCHEDULE_FILE
+#define GAIN_SCHEDULE_FILE      "gain_schedule.txt"
+#endif
+#ifndef SCH_CURVATURE_DIST
+#define SCH_CURVATURE_DIST      100     /* mm to measure the curvature over     */
+#endif
+
+/* define MAKE_TUNE, e.g., -DMAKE_TUNE, to run the relay auto-tuning on a straight line
+   instead of the course; TuneLine logs the gains for GAIN_SCHEDULE_FILE  */
+#ifndef RELAY_HYSTERESIS
+#define RELAY_HYSTERESIS        1.0     /* brightness band to switch the relay  */
+#endif
+#ifndef RELAY_CYCLES
+#define RELAY_CYCLES            4       /* oscillation cycles to average        */
+#endif
+
+/* distance in mm ahead of the robot to look up the course map for the feed-forward
+   of TraceLineWithPreview and TraceLineMPC; a positive value compensates the lag of the motors */
+#ifndef FF_PREVIEW_DIST
+#define FF_PREVIEW_DIST         0
+#endif
+
+/* define MOTOR_MODEL, e.g., -DMOTOR_MODEL, to compensate the deadband, the backlash
+   and the battery voltage of the wheel motors by MotorModel                */
+#ifndef MOTOR_DEADBAND
+#define MOTOR_DEADBAND          6.0     /* pwm just overcoming the static friction */
+#endif
+#ifndef MOTOR_BACKLASH
+#define MOTOR_BACKLASH          8       /* degree of the gear slack, cf. BACKLASHHALF in ev3way */
+#endif
+#ifndef MOTOR_BACKLASH_PWM
+#define MOTOR_BACKLASH_PWM      20.0    /* pwm to take up the slack on reversal  */
+#endif
+#ifndef MOTOR_NOMINAL_MV
+#define MOTOR_NOMINAL_MV        8000    /* battery voltage the pwm is tuned at   */
+#endif
+
+/* gains of SpeedController for the velocity mode of FilteredMotor, cf. RunAtSpeed */
+#ifndef SPEED_PWM_PER_MMPS
+#define SPEED_PWM_PER_MMPS      0.11    /* feed-forward pwm per mm/s of the wheel */
+#endif
+#ifndef SPEED_KP
+#define SPEED_KP                0.05    /* pwm per mm/s of the averaged speed error */
+#endif
+#ifndef SPEED_KI
+#define SPEED_KI                0.5     /* pwm per mm of the distance error     */
+#endif
+
+/* limits and tracking of the profile by RotateByTrajectory and MoveByTrajectory;
+   the unit is mm of the wheel travel; the tracking ends when both wheels are within
+   TRJ_TOLERANCE of the end, or TRJ_SETTLE_TIME seconds after the profile ends */
+#ifndef TRJ_AMAX
+#define TRJ_AMAX                800.0   /* mm/s^2                               */
+#endif
+#ifndef TRJ_JMAX
+#define TRJ_JMAX                8000.0  /* mm/s^3; 0.0 for trapezoidal profiles  */
+#endif
+#ifndef TRJ_KP
+#define TRJ_KP                  10.0    /* mm/s per mm of the position error    */
+#endif
+#define TRJ_TOLERANCE           DIST_PER_DEGREE
+#define TRJ_SETTLE_TIME         0.5
+
+/* model and weights of LineMPC for TraceLineMPC */
+#ifndef MPC_MMPS_PER_PWM
+#define MPC_MMPS_PER_PWM        5.0     /* wheel speed in mm/s per pwm          */
+#endif
+#ifndef MPC_EDGE_SLOPE
+#define MPC_EDGE_SLOPE          5.5     /* red brightness per mm across the edge */
+#endif
+#ifndef MPC_SENSOR_AHEAD
+#define MPC_SENSOR_AHEAD        60.0    /* mm from the axle to the color sensor */
+#endif
+#define MPC_Q_OFFSET            1.0
+#define MPC_Q_HEADING           0.0
+#define MPC_R_TURN              1.0e-3
+#define MPC_R_RATE              1.0e-2
+
 #ifndef LOG_INTERVAL
 #define LOG_INTERVAL            0
 #endif
@@ -133,6 +259,18 @@ enum State {
     ST_BLOCK,
     ST_ENDING,
     ST_END,
+    ST_NUM,     /* number of states */
+};
+
+/* events to the state machine; EV_TICK, EV_SUCCESS and EV_FAILURE tell
+   the status of the behavior tree traversed in the state on every tick */
+enum Event {
+    EV_START,
+    EV_TICK,
+    EV_SUCCESS,
+    EV_FAILURE,
+    EV_ABORT,
+    EV_NUM,     /* number of events */
 };
 
 enum TraceSide {
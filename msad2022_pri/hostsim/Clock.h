@@ -0,0 +1,30 @@
+/*
+    Clock.h
+    host stand-in of ev3api::Clock counting the simulated time of SimWorld
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef Clock_h
+#define Clock_h
+
+#include "ev3api.h"
+
+namespace ev3api {
+
+/* in micro second as the app expects */
+class Clock {
+public:
+    Clock();
+    void reset();
+    uint32_t now() const;
+    /* the simulated time advances only while the main task sleeps in slp_tsk(),
+       so waiting in a task is a no-op */
+    void wait(uint32_t duration);
+    void sleep(uint32_t duration);
+protected:
+    uint64_t mStartTime;
+};
+
+} /* namespace ev3api */
+
+#endif /* Clock_h */
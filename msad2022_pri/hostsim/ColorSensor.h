@@ -0,0 +1,27 @@
+/*
+    ColorSensor.h
+    host stand-in of ev3api::ColorSensor reading the course raster of SimWorld
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef ColorSensor_h
+#define ColorSensor_h
+
+#include "Port.h"
+
+namespace ev3api {
+
+class ColorSensor {
+public:
+    explicit ColorSensor(ePortS port);
+    virtual ~ColorSensor();
+    void getRawColor(rgb_raw_t& rgb) const;
+    /* reflected light in percent, from the red of the raw color */
+    int8_t getBrightness() const;
+protected:
+    ePortS mPort;
+};
+
+} /* namespace ev3api */
+
+#endif /* ColorSensor_h */
@@ -0,0 +1,189 @@
+/*
+    CourseRaster.cpp
+    raster image of a course for the color sensor of SimWorld
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "CourseRaster.hpp"
+#include "../CourseMap.hpp"
+#include <stdio.h>
+#include <math.h>
+#include <float.h>
+
+static const uint8_t WHITE[3] = { 255, 255, 255 };
+static const uint8_t BLACK[3] = {  20,  20,  24 };
+static const uint8_t BLUE[3]  = {  40,  70, 210 };
+
+CourseRaster::CourseRaster() : width(0),height(0),mmPerPx(SIM_MM_PER_PX),left(0.0),top(0.0) {}
+
+void CourseRaster::allocate(double minX, double minY, double maxX, double maxY) {
+    left = minX;
+    top = maxY;
+    width = (int)ceil((maxX - minX) / mmPerPx);
+    height = (int)ceil((maxY - minY) / mmPerPx);
+    pixels.assign((size_t)width * height * 3, 255);
+}
+
+bool CourseRaster::render(const char* courseFile, double blueFrom, double blueTo) {
+    CourseMap map;
+    if (!map.load(courseFile)) {
+        return false;
+    }
+    /* integrate the course every milimater at the midpoint azimuth */
+    int32_t length = map.getLength();
+    path.clear();
+    path.reserve(length + 1);
+    double x = 0.0, y = 0.0, theta = 0.0;
+    double minX = 0.0, minY = 0.0, maxX = 0.0, maxY = 0.0;
+    int cursor = 0;
+    for (int32_t s = 0; s <= length; s++) {
+        path.push_back({ (float)x, (float)y, (float)theta });
+        minX = fmin(minX, x); maxX = fmax(maxX, x);
+        minY = fmin(minY, y); maxY = fmax(maxY, y);
+        /* the curvature of CourseMap is clockwise positive */
+        double dTheta = -map.getCurvature(map.seek(s + 0.5, cursor));
+        x += cos(theta + dTheta / 2.0);
+        y += sin(theta + dTheta / 2.0);
+        theta += dTheta;
+    }
+    mmPerPx = SIM_MM_PER_PX;
+    allocate(minX - SIM_COURSE_MARGIN, minY - SIM_COURSE_MARGIN,
+             maxX + SIM_COURSE_MARGIN, maxY + SIM_COURSE_MARGIN);
+
+    for (const PathPoint& p : path) {
+        paintDisc(p.x, p.y, SIM_LINE_HALFWIDTH, BLACK);
+    }
+    for (int32_t s = (int32_t)fmax(blueFrom, 0.0); s <= length && s <= blueTo; s++) {
+        paintDisc(path[s].x, path[s].y, SIM_LINE_HALFWIDTH, BLUE);
+    }
+    for (int i = 0; i < map.getNumLandmarks(); i++) {
+        int32_t s = map.getLandmark(i);
+        if (s >= 0 && s <= length) paintBar(path[s], BLACK);
+    }
+    return true;
+}
+
+bool CourseRaster::loadPPM(const char* filename, double mmpp) {
+    FILE* fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        return false;
+    }
+    int header[3], n = 0, c;
+    bool ok = (fgetc(fp) == 'P' && fgetc(fp) == '6');
+    while (ok && n < 3 && (c = fgetc(fp)) != EOF) {
+        if (c == '#') {
+            while ((c = fgetc(fp)) != EOF && c != '\n') ;
+        } else if (c >= '0' && c <= '9') {
+            ungetc(c, fp);
+            ok = (fscanf(fp, "%d", &header[n++]) == 1);
+        }
+    }
+    ok = ok && (n == 3) && (header[2] == 255) && (fgetc(fp) != EOF); /* a white space after maxval */
+    if (ok) {
+        mmPerPx = mmpp;
+        allocate(0.0, 0.0, header[0] * mmPerPx, header[1] * mmPerPx);
+        ok = (fread(pixels.data(), 1, pixels.size(), fp) == pixels.size());
+    }
+    fclose(fp);
+    path.clear();
+    return ok;
+}
+
+bool CourseRaster::savePPM(const char* filename) const {
+    FILE* fp = fopen(filename, "wb");
+    if (fp == NULL) {
+        return false;
+    }
+    fprintf(fp, "P6\n# %.3f mm per pixel\n%d %d\n255\n", mmPerPx, width, height);
+    bool ok = (fwrite(pixels.data(), 1, pixels.size(), fp) == pixels.size());
+    return (fclose(fp) == 0) && ok;
+}
+
+void CourseRaster::paintDisc(double x, double y, double r, const uint8_t color[3]) {
+    int px0 = (int)floor((x - r - left) / mmPerPx), px1 = (int)ceil((x + r - left) / mmPerPx);
+    int py0 = (int)floor((top - y - r) / mmPerPx),  py1 = (int)ceil((top - y + r) / mmPerPx);
+    for (int py = (py0 < 0) ? 0 : py0; py <= py1 && py < height; py++) {
+        for (int px = (px0 < 0) ? 0 : px0; px <= px1 && px < width; px++) {
+            double dx = left + (px + 0.5) * mmPerPx - x, dy = top - (py + 0.5) * mmPerPx - y;
+            if (dx * dx + dy * dy <= r * r) {
+                uint8_t* p = &pixels[((size_t)py * width + px) * 3];
+                p[0] = color[0]; p[1] = color[1]; p[2] = color[2];
+            }
+        }
+    }
+}
+
+void CourseRaster::paintBar(const PathPoint& pp, const uint8_t color[3]) {
+    double r = SIM_JETBLACK_HALFLENGTH + SIM_JETBLACK_HALFWIDTH;
+    double c = cos(pp.theta), s = sin(pp.theta);
+    int px0 = (int)floor((pp.x - r - left) / mmPerPx), px1 = (int)ceil((pp.x + r - left) / mmPerPx);
+    int py0 = (int)floor((top - pp.y - r) / mmPerPx),  py1 = (int)ceil((top - pp.y + r) / mmPerPx);
+    for (int py = (py0 < 0) ? 0 : py0; py <= py1 && py < height; py++) {
+        for (int px = (px0 < 0) ? 0 : px0; px <= px1 && px < width; px++) {
+            double dx = left + (px + 0.5) * mmPerPx - pp.x, dy = top - (py + 0.5) * mmPerPx - pp.y;
+            double along = dx * c + dy * s, across = -dx * s + dy * c;
+            if (fabs(along) <= SIM_JETBLACK_HALFWIDTH && fabs(across) <= SIM_JETBLACK_HALFLENGTH) {
+                uint8_t* p = &pixels[((size_t)py * width + px) * 3];
+                p[0] = color[0]; p[1] = color[1]; p[2] = color[2];
+            }
+        }
+    }
+}
+
+void CourseRaster::sample(double x, double y, double radius, double rgb[3]) const {
+    int px0 = (int)floor((x - radius - left) / mmPerPx), px1 = (int)ceil((x + radius - left) / mmPerPx);
+    int py0 = (int)floor((top - y - radius) / mmPerPx),  py1 = (int)ceil((top - y + radius) / mmPerPx);
+    double sum[3] = { 0.0, 0.0, 0.0 };
+    int n = 0;
+    for (int py = py0; py <= py1; py++) {
+        for (int px = px0; px <= px1; px++) {
+            double dx = left + (px + 0.5) * mmPerPx - x, dy = top - (py + 0.5) * mmPerPx - y;
+            if (dx * dx + dy * dy > radius * radius) continue;
+            const uint8_t* p = (px >= 0 && px < width && py >= 0 && py < height) ?
+                               &pixels[((size_t)py * width + px) * 3] : WHITE;
+            sum[0] += p[0]; sum[1] += p[1]; sum[2] += p[2];
+            n++;
+        }
+    }
+    if (n == 0) { /* the disc smaller than a pixel */
+        int px = (int)floor((x - left) / mmPerPx), py = (int)floor((top - y) / mmPerPx);
+        const uint8_t* p = (px >= 0 && px < width && py >= 0 && py < height) ?
+                           &pixels[((size_t)py * width + px) * 3] : WHITE;
+        sum[0] = p[0]; sum[1] = p[1]; sum[2] = p[2];
+        n = 1;
+    }
+    for (int i = 0; i < 3; i++) rgb[i] = sum[i] / n;
+}
+
+void CourseRaster::getPoseAt(double s, double& x, double& y, double& theta) const {
+    if (path.empty()) {
+        x = y = theta = 0.0;
+        return;
+    }
+    int i = (int)fmin(fmax(s, 0.0), getLength());
+    x = path[i].x;
+    y = path[i].y;
+    theta = path[i].theta;
+}
+
+double CourseRaster::project(double x, double y, double hint, double& offset) const {
+    offset = 0.0;
+    if (path.empty()) return 0.0;
+    int from = 0, to = (int)path.size() - 1;
+    if (hint >= 0.0) { /* a robot moves little by little */
+        from = (int)fmax(hint - 300.0, 0.0);
+        to = (int)fmin(hint + 300.0, (double)to);
+    }
+    double best = DBL_MAX;
+    int nearest = from;
+    for (int i = from; i <= to; i++) {
+        double dx = x - path[i].x, dy = y - path[i].y;
+        if (dx * dx + dy * dy < best) {
+            best = dx * dx + dy * dy;
+            nearest = i;
+        }
+    }
+    const PathPoint& p = path[nearest];
+    offset = cos(p.theta) * (y - p.y) - sin(p.theta) * (x - p.x);
+    return (double)nearest;
+}
@@ -0,0 +1,64 @@
+/*
+    CourseRaster.hpp
+    raster image of a course for the color sensor of SimWorld
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef CourseRaster_hpp
+#define CourseRaster_hpp
+
+#include <stdint.h>
+#include <vector>
+
+#ifndef SIM_MM_PER_PX
+#define SIM_MM_PER_PX           2.0     /* resolution of a rendered course */
+#endif
+#define SIM_LINE_HALFWIDTH      10.0    /* the line is 20 mm wide */
+#define SIM_JETBLACK_HALFWIDTH  15.0    /* half the width of a CL_JETBLACK bar along the line */
+#define SIM_JETBLACK_HALFLENGTH 100.0   /* half the length of a CL_JETBLACK bar across the line */
+#define SIM_COURSE_MARGIN       400.0   /* white around the rendered course */
+
+/*
+    The world is in milimater, x to the right and y upwards, and the heading theta
+    is in radian, counterclockwise positive from the x axis.
+    render() draws the course of a CourseMap file, e.g., ../course_L.txt,
+    as a black line starting at the origin towards the x axis,
+    CL_JETBLACK bars across the line at the landmarks and the line painted blue
+    over [blueFrom, blueTo] in distance from the start.
+    loadPPM() takes any binary PPM (P6) instead, with its bottom-left corner at the origin.
+    Note CourseMap treats the curvature as that of the BlindRunner sense, which
+    is not always the geometry of the real course, and so is the rendered course.
+*/
+class CourseRaster {
+public:
+    CourseRaster();
+    bool render(const char* courseFile, double blueFrom, double blueTo);
+    bool loadPPM(const char* filename, double mmPerPx);
+    bool savePPM(const char* filename) const;
+    /* mean color in 0 to 255 over the disc of radius mm around (x, y), white outside the image */
+    void sample(double x, double y, double radius, double rgb[3]) const;
+    /* length of the rendered course, or 0 for an image loaded */
+    inline double getLength() const;
+    /* pose on the line at distance s from the start, clipped into the rendered course */
+    void getPoseAt(double s, double& x, double& y, double& theta) const;
+    /* distance from the start of the point of the line nearest to (x, y), searched around hint,
+       and the offset from the line, positive to the left */
+    double project(double x, double y, double hint, double& offset) const;
+protected:
+    struct PathPoint {
+        float x, y, theta;
+    };
+    int width, height;
+    double mmPerPx, left, top;          /* world coordinates of the top-left corner */
+    std::vector<uint8_t> pixels;        /* RGB from the top-left corner */
+    std::vector<PathPoint> path;        /* every milimater along the rendered course */
+    void allocate(double minX, double minY, double maxX, double maxY);
+    void paintDisc(double x, double y, double r, const uint8_t color[3]);
+    void paintBar(const PathPoint& p, const uint8_t color[3]);
+};
+
+inline double CourseRaster::getLength() const {
+    return path.empty() ? 0.0 : (double)(path.size() - 1);
+}
+
+#endif /* CourseRaster_hpp */
@@ -0,0 +1,30 @@
+/*
+    GyroSensor.h
+    host stand-in of ev3api::GyroSensor measuring the heading of SimWorld
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef GyroSensor_h
+#define GyroSensor_h
+
+#include "Port.h"
+
+namespace ev3api {
+
+/* the angle is clockwise positive in degree as the sensor mounted upright */
+class GyroSensor {
+public:
+    explicit GyroSensor(ePortS port);
+    virtual ~GyroSensor();
+    int16_t getAngle() const;
+    int16_t getAnglerVelocity() const;
+    void reset();
+    void setOffset(int16_t offset);
+protected:
+    ePortS mPort;
+    int16_t mOffset;
+};
+
+} /* namespace ev3api */
+
+#endif /* GyroSensor_h */
@@ -0,0 +1,33 @@
+/*
+    Motor.h
+    host stand-in of ev3api::Motor driving a wheel of SimWorld
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef Motor_h
+#define Motor_h
+
+#include "Port.h"
+
+namespace ev3api {
+
+class Motor {
+public:
+    explicit Motor(ePortM port, bool brake = true, motor_type_t type = LARGE_MOTOR);
+    virtual ~Motor();
+    /* resets the encoder count and stops the motor */
+    void reset();
+    int32_t getCount() const;
+    void setCount(int32_t count);
+    int getPWM() const;
+    void setPWM(int pwm);
+    void setBrake(bool brake);
+    void stop();
+protected:
+    ePortM mPort;
+    bool mBrake;
+};
+
+} /* namespace ev3api */
+
+#endif /* Motor_h */
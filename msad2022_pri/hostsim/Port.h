@@ -0,0 +1,26 @@
+/*
+    Port.h
+    host stand-in of the EV3RT C++ API port numbers, for hostsim
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef Port_h
+#define Port_h
+
+#include "ev3api.h"
+
+enum ePortS {
+    PORT_1 = EV3_PORT_1,
+    PORT_2 = EV3_PORT_2,
+    PORT_3 = EV3_PORT_3,
+    PORT_4 = EV3_PORT_4,
+};
+
+enum ePortM {
+    PORT_A = EV3_PORT_A,
+    PORT_B = EV3_PORT_B,
+    PORT_C = EV3_PORT_C,
+    PORT_D = EV3_PORT_D,
+};
+
+#endif /* Port_h */
@@ -0,0 +1,187 @@
+/*
+    SimWorld.cpp
+    deterministic 2-D world of the robot behind the ev3api stand-ins of hostsim
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "SimWorld.hpp"
+#include "../app.h"
+#include "../Plotter.hpp"
+#include <string.h>
+
+SimWorld* simWorld = nullptr;
+
+/* raw color of the EV3 color sensor per 0 to 255 of the image, i.e., white paper reads 102, 97, 133 */
+static const double RAW_PER_PIXEL[3] = { 0.40, 0.38, 0.52 };
+
+SimWorld::SimWorld(const CourseRaster* r, const SimConfig& c) :
+raster(r),config(c),wakeups(0),timedOut(false),time(0),x(0.0),y(0.0),theta(0.0),gyroZero(0.0),
+led(LED_OFF),rng(c.seed ? c.seed : 1U),tracer(nullptr),tracerArg(nullptr),tracerPeriod(0) {
+    memset(pwm, 0, sizeof(pwm));
+    memset(speed, 0, sizeof(speed));
+    memset(angle, 0, sizeof(angle));
+    memset(countZero, 0, sizeof(countZero));
+    memset(&lastRaw, 0, sizeof(lastRaw));
+    memset(tasks, 0, sizeof(tasks));
+    memset(cyclics, 0, sizeof(cyclics));
+    /* as CRE_TSK and CRE_CYC in ../app.cfg */
+    tasks[MAIN_TASK] = { main_task,    PRIORITY_MAIN_TASK, 0 };
+    tasks[UPD_TSK]   = { update_task,  PRIORITY_UPD_TSK,   0 };
+    tasks[PLT_TSK]   = { plotter_task, PRIORITY_PLT_TSK,   0 };
+    tasks[CTL_TSK]   = { control_task, PRIORITY_CTL_TSK,   0 };
+    tasks[LOG_TSK]   = { log_task,     PRIORITY_LOG_TSK,   0 };
+    cyclics[CYC_UPD_TSK] = { nullptr,        UPD_TSK, PERIOD_UPD_TSK, false, 0 };
+    cyclics[CYC_PLT_TSK] = { nullptr,        PLT_TSK, PERIOD_PLT_TSK, false, 0 };
+    cyclics[CYC_CTL_TSK] = { nullptr,        CTL_TSK, PERIOD_CTL_TSK, false, 0 };
+    cyclics[CYC_LOG_TSK] = { nullptr,        LOG_TSK, PERIOD_LOG_TSK, false, 0 };
+}
+
+void SimWorld::place(double px, double py, double pt) {
+    x = px;
+    y = py;
+    theta = pt;
+}
+
+void SimWorld::setTracer(void (*t)(SimWorld* world, void* arg), void* arg, uint32_t period) {
+    tracer = t;
+    tracerArg = arg;
+    tracerPeriod = period;
+}
+
+/* the activation requests are queued up to one as TMAX_ACTCNT of TOPPERS/ASP3 */
+ER SimWorld::activate(ID tskid) {
+    if (tskid < 1 || tskid > TNUM_TSKID) return E_OBJ;
+    if (tasks[tskid].activations > 0) return E_QOVR;
+    tasks[tskid].activations++;
+    return E_OK;
+}
+
+ER SimWorld::wakeup(ID tskid) {
+    if (tskid != MAIN_TASK) return E_OBJ; /* only the main task sleeps */
+    if (wakeups > 0) return E_QOVR;
+    wakeups++;
+    return E_OK;
+}
+
+/* returns E_OK also on the time limit for the main task to clean up */
+ER SimWorld::sleep() {
+    while (wakeups == 0) {
+        if (time >= config.timeLimit) {
+            timedOut = true;
+            return E_OK;
+        }
+        step();
+    }
+    wakeups--;
+    return E_OK;
+}
+
+ER SimWorld::startCyclic(ID cycid) {
+    if (cycid < 1 || cycid > TNUM_CYCID) return E_OBJ;
+    cyclics[cycid].started = true;
+    cyclics[cycid].next = time; /* cycle phase of 0 */
+    return E_OK;
+}
+
+ER SimWorld::stopCyclic(ID cycid) {
+    if (cycid < 1 || cycid > TNUM_CYCID) return E_OBJ;
+    cyclics[cycid].started = false;
+    return E_OK;
+}
+
+void SimWorld::step() {
+    for (int i = 1; i <= TNUM_CYCID; i++) {
+        Cyclic& c = cyclics[i];
+        if (!c.started || time < c.next) continue;
+        c.next += c.period;
+        if (c.handler != nullptr) {
+            c.handler(c.exinf);
+        } else {
+            activate((ID)c.exinf);
+        }
+    }
+    dispatch();
+    if (tracer != nullptr && tracerPeriod > 0 && time % tracerPeriod == 0) {
+        tracer(this, tracerArg);
+    }
+    move(SIM_TICK / 1000000.0);
+    time += SIM_TICK;
+}
+
+/* run the activated tasks to completion, the highest priority first */
+void SimWorld::dispatch() {
+    for (;;) {
+        ID next = 0;
+        for (ID i = 1; i <= TNUM_TSKID; i++) {
+            if (i == MAIN_TASK || tasks[i].activations == 0) continue;
+            if (next == 0 || tasks[i].priority < tasks[next].priority) next = i;
+        }
+        if (next == 0) return;
+        tasks[next].activations--;
+        tasks[next].entry(0);
+    }
+}
+
+/* first-order lag of the wheel speed and the differential drive at the midpoint azimuth */
+void SimWorld::move(double dt) {
+    for (int p = 0; p < TNUM_MOTOR_PORT; p++) {
+        double target = 0.0;
+        if (pwm[p] > SIM_MOTOR_DEADBAND || pwm[p] < -SIM_MOTOR_DEADBAND) {
+            target = pwm[p] * SIM_DPS_PER_PWM * config.batteryMV / SIM_NOMINAL_MV;
+        }
+        speed[p] += (target - speed[p]) * dt / SIM_MOTOR_TAU;
+        angle[p] += speed[p] * dt;
+    }
+    double vL = speed[config.leftPort] * DIST_PER_DEGREE, vR = speed[config.rightPort] * DIST_PER_DEGREE;
+    double dTheta = (vR - vL) / WHEEL_TREAD * dt;
+    x += (vL + vR) / 2.0 * cos(theta + dTheta / 2.0) * dt;
+    y += (vL + vR) / 2.0 * sin(theta + dTheta / 2.0) * dt;
+    theta += dTheta;
+}
+
+int32_t SimWorld::getCount(int port) const {
+    return (int32_t)floor(angle[port] - countZero[port]);
+}
+
+void SimWorld::setCount(int port, int32_t count) {
+    countZero[port] = angle[port] - count;
+}
+
+void SimWorld::setPWM(int port, int p) {
+    pwm[port] = (p > 100) ? 100 : ((p < -100) ? -100 : p);
+}
+
+void SimWorld::getRawColor(rgb_raw_t& rgb) {
+    double sx = x + SIM_SENSOR_AHEAD * cos(theta), sy = y + SIM_SENSOR_AHEAD * sin(theta);
+    double c[3];
+    raster->sample(sx, sy, SIM_SPOT_RADIUS, c);
+    uint16_t* raw[3] = { &rgb.r, &rgb.g, &rgb.b };
+    for (int i = 0; i < 3; i++) {
+        double v = c[i] * RAW_PER_PIXEL[i] * config.lightGain + config.noise * gaussian();
+        *raw[i] = (uint16_t)lround(fmin(fmax(v, 0.0), 1023.0));
+    }
+    lastRaw = rgb;
+}
+
+int16_t SimWorld::getGyroAngle() const {
+    return (int16_t)lround(-(theta - gyroZero) * 180.0 / M_PI);
+}
+
+int16_t SimWorld::getGyroRate() const {
+    double vL = speed[config.leftPort] * DIST_PER_DEGREE, vR = speed[config.rightPort] * DIST_PER_DEGREE;
+    return (int16_t)lround(-(vR - vL) / WHEEL_TREAD * 180.0 / M_PI);
+}
+
+void SimWorld::resetGyro() {
+    gyroZero = theta;
+}
+
+/* sum of four uniforms by xorshift32, close enough to the normal distribution */
+double SimWorld::gaussian() {
+    double sum = 0.0;
+    for (int i = 0; i < 4; i++) {
+        rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+        sum += (rng & 0xffff) / 65536.0;
+    }
+    return (sum - 2.0) * sqrt(3.0);
+}
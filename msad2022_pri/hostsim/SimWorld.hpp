@@ -0,0 +1,168 @@
+/*
+    SimWorld.hpp
+    deterministic 2-D world of the robot behind the ev3api stand-ins of hostsim
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef SimWorld_hpp
+#define SimWorld_hpp
+
+#include "ev3api.h"
+#include "CourseRaster.hpp"
+
+#define SIM_TICK                1000    /* micro second per step of the world */
+#ifndef SIM_DPS_PER_PWM
+#define SIM_DPS_PER_PWM         9.0     /* wheel speed by pwm of the large motor at SIM_NOMINAL_MV */
+#endif
+#ifndef SIM_MOTOR_TAU
+#define SIM_MOTOR_TAU           0.08    /* time constant of the wheel speed in second */
+#endif
+#ifndef SIM_MOTOR_DEADBAND
+#define SIM_MOTOR_DEADBAND      2       /* pwm below which the motor does not turn */
+#endif
+#define SIM_NOMINAL_MV          8000
+#ifndef SIM_SENSOR_AHEAD
+#define SIM_SENSOR_AHEAD        60.0    /* mm from the axle to the color sensor */
+#endif
+#ifndef SIM_SPOT_RADIUS
+#define SIM_SPOT_RADIUS         8.0     /* mm of the spot the color sensor averages */
+#endif
+
+struct SimConfig {
+    uint32_t seed       = 1;
+    double   noise      = 1.5;      /* standard deviation of the raw color */
+    double   lightGain  = 1.0;      /* the gain of the reflected light */
+    int      batteryMV  = SIM_NOMINAL_MV;
+    uint64_t timeLimit  = 180000000;    /* micro second */
+    uint64_t backAt     = 0;        /* micro second when the back button gets pressed, 0 for never */
+    int      leftPort   = EV3_PORT_C;
+    int      rightPort  = EV3_PORT_B;
+};
+
+/*
+    SimWorld plays both the robot on the course and the kernel.
+    The main task is called directly by the driver as TA_ACT does, and its slp_tsk()
+    runs the world by SIM_TICK until wup_tsk(MAIN_TASK) or the time limit, where
+    at each step the cyclic handlers of ../app.cfg fire as they are due, then
+    the tasks activated run to completion in the order of the priorities of ../app.h,
+    and finally the robot moves for SIM_TICK by the pwm given to the motors.
+    Tasks take no time, i.e., neither preemption nor overruns happen,
+    which keeps a run deterministic by SimConfig::seed.
+*/
+class SimWorld {
+public:
+    SimWorld(const CourseRaster* raster, const SimConfig& config);
+    /* pose of the axle center */
+    void place(double x, double y, double theta);
+    /* kernel */
+    ER activate(ID tskid);
+    ER sleep();
+    ER wakeup(ID tskid);
+    ER startCyclic(ID cycid);
+    ER stopCyclic(ID cycid);
+    /* devices */
+    inline uint64_t getTime() const;
+    int32_t getCount(int port) const;
+    void setCount(int port, int32_t count);
+    inline int getPWM(int port) const;
+    void setPWM(int port, int pwm);
+    void getRawColor(rgb_raw_t& rgb);
+    /* the color read last, without drawing the noise again */
+    inline const rgb_raw_t& getLastRawColor() const;
+    int16_t getGyroAngle() const;
+    int16_t getGyroRate() const;
+    void resetGyro();
+    inline bool isBackPressed() const;
+    inline int getBatteryMV() const;
+    inline void setLED(ledcolor_t color);
+    inline ledcolor_t getLED() const;
+    /* ground truth */
+    inline double getX() const;
+    inline double getY() const;
+    inline double getTheta() const;
+    inline bool isTimedOut() const;
+    /* called every period micro seconds after the tasks, e.g., to record the trajectory */
+    void setTracer(void (*tracer)(SimWorld* world, void* arg), void* arg, uint32_t period);
+protected:
+    struct Task {
+        void (*entry)(intptr_t);
+        PRI priority;
+        int activations;
+    };
+    struct Cyclic {
+        void (*handler)(intptr_t);  /* nullptr for TNFY_ACTTSK */
+        intptr_t exinf;
+        uint32_t period;
+        bool started;
+        uint64_t next;
+    };
+    const CourseRaster* raster;
+    SimConfig config;
+    Task tasks[TNUM_TSKID + 1];
+    Cyclic cyclics[TNUM_CYCID + 1];
+    int wakeups;
+    bool timedOut;
+    uint64_t time;
+    double x, y, theta, gyroZero;
+    int pwm[TNUM_MOTOR_PORT];
+    double speed[TNUM_MOTOR_PORT], angle[TNUM_MOTOR_PORT], countZero[TNUM_MOTOR_PORT];
+    rgb_raw_t lastRaw;
+    ledcolor_t led;
+    uint32_t rng;
+    void (*tracer)(SimWorld* world, void* arg);
+    void* tracerArg;
+    uint32_t tracerPeriod;
+    void step();
+    void dispatch();
+    void move(double dt);
+    double gaussian();
+};
+
+/* the world behind the stand-ins, set by the driver */
+extern SimWorld* simWorld;
+
+inline uint64_t SimWorld::getTime() const {
+    return time;
+}
+
+inline int SimWorld::getPWM(int port) const {
+    return pwm[port];
+}
+
+inline const rgb_raw_t& SimWorld::getLastRawColor() const {
+    return lastRaw;
+}
+
+inline bool SimWorld::isBackPressed() const {
+    return config.backAt != 0 && time >= config.backAt;
+}
+
+inline int SimWorld::getBatteryMV() const {
+    return config.batteryMV;
+}
+
+inline void SimWorld::setLED(ledcolor_t color) {
+    led = color;
+}
+
+inline ledcolor_t SimWorld::getLED() const {
+    return led;
+}
+
+inline double SimWorld::getX() const {
+    return x;
+}
+
+inline double SimWorld::getY() const {
+    return y;
+}
+
+inline double SimWorld::getTheta() const {
+    return theta;
+}
+
+inline bool SimWorld::isTimedOut() const {
+    return timedOut;
+}
+
+#endif /* SimWorld_hpp */
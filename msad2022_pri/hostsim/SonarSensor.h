@@ -0,0 +1,27 @@
+/*
+    SonarSensor.h
+    host stand-in of ev3api::SonarSensor seeing no obstacle
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef SonarSensor_h
+#define SonarSensor_h
+
+#include "Port.h"
+
+namespace ev3api {
+
+class SonarSensor {
+public:
+    explicit SonarSensor(ePortS port);
+    virtual ~SonarSensor();
+    /* in centimeter; SimWorld has no obstacles, hence always the maximum range */
+    int16_t getDistance() const;
+    bool listen() const;
+protected:
+    ePortS mPort;
+};
+
+} /* namespace ev3api */
+
+#endif /* SonarSensor_h */
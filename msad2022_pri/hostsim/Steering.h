@@ -0,0 +1,26 @@
+/*
+    Steering.h
+    host stand-in of ev3api::Steering over the stand-in Motor
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef Steering_h
+#define Steering_h
+
+#include "Motor.h"
+
+namespace ev3api {
+
+class Steering {
+public:
+    Steering(Motor& leftMotor, Motor& rightMotor);
+    /* turnRatio from -100 (spin to the left) to 100 (spin to the right) */
+    void setPower(int power, int turnRatio);
+protected:
+    Motor& mLeftMotor;
+    Motor& mRightMotor;
+};
+
+} /* namespace ev3api */
+
+#endif /* Steering_h */
@@ -0,0 +1,25 @@
+/*
+    TouchSensor.h
+    host stand-in of ev3api::TouchSensor, never pressed
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef TouchSensor_h
+#define TouchSensor_h
+
+#include "Port.h"
+
+namespace ev3api {
+
+class TouchSensor {
+public:
+    explicit TouchSensor(ePortS port);
+    virtual ~TouchSensor();
+    bool isPressed() const;
+protected:
+    ePortS mPort;
+};
+
+} /* namespace ev3api */
+
+#endif /* TouchSensor_h */
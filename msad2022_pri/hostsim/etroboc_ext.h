@@ -0,0 +1,21 @@
+/*
+    etroboc_ext.h
+    host stand-in of the extension of the ET robocon simulator, for the apps that call it
+    unconditionally, e.g., ms2021 built by ms2021/tool/lt_sweep.cpp
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef etroboc_ext_h
+#define etroboc_ext_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void ETRoboc_notifyCompletedToSimulator(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* etroboc_ext_h */
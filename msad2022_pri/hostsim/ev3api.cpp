@@ -0,0 +1,184 @@
+/*
+    ev3api.cpp
+    host stand-in of the EV3RT API and the TOPPERS kernel services over SimWorld
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#include "SimWorld.hpp"
+#include "Clock.h"
+#include "Motor.h"
+#include "ColorSensor.h"
+#include "GyroSensor.h"
+#include "TouchSensor.h"
+#include "SonarSensor.h"
+#include "Steering.h"
+#include <stdarg.h>
+#include <stdlib.h>
+
+ER act_tsk(ID tskid) {
+    return simWorld->activate(tskid);
+}
+
+ER slp_tsk(void) {
+    return simWorld->sleep();
+}
+
+ER wup_tsk(ID tskid) {
+    return simWorld->wakeup(tskid);
+}
+
+/* the main task is the only task calling this, which returns to the driver right after */
+ER ext_tsk(void) {
+    return E_OK;
+}
+
+ER sta_cyc(ID cycid) {
+    return simWorld->startCyclic(cycid);
+}
+
+ER stp_cyc(ID cycid) {
+    return simWorld->stopCyclic(cycid);
+}
+
+void syslog(uint_t prio, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+}
+
+ER ev3_led_set_color(ledcolor_t color) {
+    simWorld->setLED(color);
+    return E_OK;
+}
+
+bool_t ev3_button_is_pressed(button_t button) {
+    return (button == BACK_BUTTON) && simWorld->isBackPressed();
+}
+
+/* no Bluetooth on the host */
+FILE* ev3_serial_open_file(serial_port_t port) {
+    return stdout;
+}
+
+int ev3_battery_voltage_mV(void) {
+    return simWorld->getBatteryMV();
+}
+
+namespace ev3api {
+
+Clock::Clock() : mStartTime(simWorld->getTime()) {}
+
+void Clock::reset() {
+    mStartTime = simWorld->getTime();
+}
+
+uint32_t Clock::now() const {
+    return (uint32_t)(simWorld->getTime() - mStartTime);
+}
+
+void Clock::wait(uint32_t duration) {}
+
+void Clock::sleep(uint32_t duration) {}
+
+Motor::Motor(ePortM port, bool brake, motor_type_t type) : mPort(port),mBrake(brake) {
+    reset();
+}
+
+Motor::~Motor() {
+    stop();
+}
+
+void Motor::reset() {
+    simWorld->setPWM(mPort, 0);
+    simWorld->setCount(mPort, 0);
+}
+
+int32_t Motor::getCount() const {
+    return simWorld->getCount(mPort);
+}
+
+void Motor::setCount(int32_t count) {
+    simWorld->setCount(mPort, count);
+}
+
+int Motor::getPWM() const {
+    return simWorld->getPWM(mPort);
+}
+
+void Motor::setPWM(int pwm) {
+    simWorld->setPWM(mPort, pwm);
+}
+
+void Motor::setBrake(bool brake) {
+    mBrake = brake;
+}
+
+void Motor::stop() {
+    simWorld->setPWM(mPort, 0);
+}
+
+ColorSensor::ColorSensor(ePortS port) : mPort(port) {}
+
+ColorSensor::~ColorSensor() {}
+
+void ColorSensor::getRawColor(rgb_raw_t& rgb) const {
+    simWorld->getRawColor(rgb);
+}
+
+int8_t ColorSensor::getBrightness() const {
+    rgb_raw_t rgb;
+    simWorld->getRawColor(rgb);
+    return (int8_t)((rgb.r > 100) ? 100 : rgb.r);
+}
+
+GyroSensor::GyroSensor(ePortS port) : mPort(port),mOffset(0) {}
+
+GyroSensor::~GyroSensor() {}
+
+int16_t GyroSensor::getAngle() const {
+    return simWorld->getGyroAngle();
+}
+
+int16_t GyroSensor::getAnglerVelocity() const {
+    return simWorld->getGyroRate() - mOffset;
+}
+
+void GyroSensor::reset() {
+    simWorld->resetGyro();
+}
+
+void GyroSensor::setOffset(int16_t offset) {
+    mOffset = offset;
+}
+
+TouchSensor::TouchSensor(ePortS port) : mPort(port) {}
+
+TouchSensor::~TouchSensor() {}
+
+bool TouchSensor::isPressed() const {
+    return false;
+}
+
+SonarSensor::SonarSensor(ePortS port) : mPort(port) {}
+
+SonarSensor::~SonarSensor() {}
+
+int16_t SonarSensor::getDistance() const {
+    return 255;
+}
+
+bool SonarSensor::listen() const {
+    return false;
+}
+
+Steering::Steering(Motor& leftMotor, Motor& rightMotor) : mLeftMotor(leftMotor),mRightMotor(rightMotor) {}
+
+void Steering::setPower(int power, int turnRatio) {
+    int slow = power * (50 - abs(turnRatio)) / 50;
+    mLeftMotor.setPWM((turnRatio > 0) ? power : slow);
+    mRightMotor.setPWM((turnRatio > 0) ? slow : power);
+}
+
+} /* namespace ev3api */
@@ -0,0 +1,92 @@
+/*
+    ev3api.h
+    host stand-in of the EV3RT C API and the TOPPERS kernel services used by the app, for hostsim
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef ev3api_h
+#define ev3api_h
+
+/* app.h includes this file in extern "C", so keep it plain C */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <assert.h>
+#include "kernel_cfg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* TOPPERS kernel types and error codes */
+typedef int             ER;
+typedef int             ID;
+typedef int             PRI;
+typedef unsigned int    uint_t;
+typedef bool            bool_t;
+
+#define E_OK            0
+#define E_OBJ           (-41)
+#define E_QOVR          (-43)
+
+/* only the order of the priorities matters to the simulated kernel */
+#define TMIN_APP_TPRI   1
+
+/* syslog levels */
+#define LOG_EMERG       0
+#define LOG_ALERT       1
+#define LOG_CRIT        2
+#define LOG_ERROR       3
+#define LOG_WARNING     4
+#define LOG_NOTICE      5
+#define LOG_INFO        6
+#define LOG_DEBUG       7
+
+typedef enum {
+    EV3_PORT_A, EV3_PORT_B, EV3_PORT_C, EV3_PORT_D, TNUM_MOTOR_PORT
+} motor_port_t;
+
+typedef enum {
+    EV3_PORT_1, EV3_PORT_2, EV3_PORT_3, EV3_PORT_4, TNUM_SENSOR_PORT
+} sensor_port_t;
+
+typedef enum {
+    NONE_MOTOR, MEDIUM_MOTOR, LARGE_MOTOR, UNREGULATED_MOTOR
+} motor_type_t;
+
+typedef enum {
+    LEFT_BUTTON, RIGHT_BUTTON, UP_BUTTON, DOWN_BUTTON, ENTER_BUTTON, BACK_BUTTON, TNUM_BUTTON
+} button_t;
+
+typedef enum {
+    LED_OFF, LED_RED, LED_GREEN, LED_ORANGE
+} ledcolor_t;
+
+typedef enum {
+    EV3_SERIAL_DEFAULT, EV3_SERIAL_UART, EV3_SERIAL_BT
+} serial_port_t;
+
+typedef struct {
+    uint16_t r, g, b;
+} rgb_raw_t;
+
+/* kernel services; tasks run to completion in the simulated time of SimWorld */
+ER      act_tsk(ID tskid);
+ER      slp_tsk(void);
+ER      wup_tsk(ID tskid);
+ER      ext_tsk(void);
+ER      sta_cyc(ID cycid);
+ER      stp_cyc(ID cycid);
+void    syslog(uint_t prio, const char* format, ...);
+
+/* EV3 platform */
+ER      ev3_led_set_color(ledcolor_t color);
+bool_t  ev3_button_is_pressed(button_t button);
+FILE*   ev3_serial_open_file(serial_port_t port);
+int     ev3_battery_voltage_mV(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ev3api_h */
@@ -0,0 +1,23 @@
+/*
+    kernel_cfg.h
+    object IDs as the configurator would generate them from ../app.cfg, for hostsim
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef kernel_cfg_h
+#define kernel_cfg_h
+
+#define TNUM_TSKID      5
+#define MAIN_TASK       1
+#define UPD_TSK         2
+#define PLT_TSK         3
+#define CTL_TSK         4
+#define LOG_TSK         5
+
+#define TNUM_CYCID      4
+#define CYC_UPD_TSK     1
+#define CYC_PLT_TSK     2
+#define CYC_CTL_TSK     3
+#define CYC_LOG_TSK     4
+
+#endif /* kernel_cfg_h */
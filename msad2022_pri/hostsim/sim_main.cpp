@@ -0,0 +1,170 @@
+/*
+    sim_main.cpp
+    runs main_task of ../app.cpp on SimWorld and reports how the run ended
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+// Build and run in this directory, where course_L.txt is loaded by the app as COURSE_FILE:
+//
+//     g++ -std=gnu++11 -O2 -I. -o hostsim ../*.cpp *.cpp && ./hostsim -q
+//
+// USER_COPTS of the EV3RT build are given as usual, e.g., -DMULTI_RATE -DSPEED_NORM=50.
+// The run is deterministic by the options; the exit status is 0 when the state machine
+// wakes up the main task within the time limit, 1 when the time runs out.
+//
+// options:
+//     -c file     course file rendered into the raster, COURSE_FILE by default
+//     -b from:to  distances of the blue line painted over the black one, the last 300 mm by default
+//     -m file     binary PPM (P6) used as the raster instead of the course
+//     -r mm       milimater per pixel of the PPM, SIM_MM_PER_PX by default
+//     -x mm -y mm -a degree
+//                 start pose of the axle on the PPM, counterclockwise from the x axis
+//     -e mm       offset of the color sensor at the start of the course from the line center,
+//                 positive to the left, the edge traced first by default
+//     -l gain     gain of the reflected light, 1.0 by default
+//     -n sigma    standard deviation of the noise on the raw color, 1.5 by default
+//     -s seed     seed of the noise
+//     -v mV       battery voltage
+//     -k second   press the back button at the time
+//     -t second   time limit, 180 by default
+//     -o file     CSV of the trajectory every PERIOD_UPD_TSK
+//     -w file     write the raster as PPM
+//     -q          discard the log of the app, i.e., the standard output
+#include "SimWorld.hpp"
+#include "../app.h"
+#include "../appusr.hpp"
+#include "../StateTable.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern StateTable<ST_NUM, EV_NUM>* hfsm;
+
+/* progress of a run measured against the rendered course */
+struct RunRecord {
+    const CourseRaster* raster;
+    FILE* csv;
+    double progress, maxOffset;
+};
+
+static void trace(SimWorld* world, void* arg) {
+    RunRecord* rec = (RunRecord*)arg;
+    double sx = world->getX() + SIM_SENSOR_AHEAD * cos(world->getTheta());
+    double sy = world->getY() + SIM_SENSOR_AHEAD * sin(world->getTheta());
+    double offset = 0.0;
+    if (rec->raster->getLength() > 0.0) {
+        rec->progress = rec->raster->project(sx, sy, rec->progress, offset);
+        rec->maxOffset = fmax(rec->maxOffset, fabs(offset));
+    }
+    if (rec->csv != NULL) {
+        const rgb_raw_t& rgb = world->getLastRawColor();
+        fprintf(rec->csv, "%.3f,%.1f,%.1f,%.2f,%.0f,%.1f,%d,%d,%u,%u,%u,%d\n",
+                world->getTime() / 1000000.0, world->getX(), world->getY(), world->getTheta() * 180.0 / M_PI,
+                rec->progress, offset, world->getPWM(EV3_PORT_C), world->getPWM(EV3_PORT_B),
+                rgb.r, rgb.g, rgb.b, (hfsm != nullptr) ? hfsm->getState() : -1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    SimConfig config;
+    const char* courseFile = COURSE_FILE;
+    const char* ppmFile = NULL;
+    const char* csvFile = NULL;
+    const char* mapFile = NULL;
+    double blueFrom = -1.0, blueTo = -1.0, mmPerPx = SIM_MM_PER_PX;
+    double x0 = 0.0, y0 = 0.0, a0 = 0.0, e0 = -_COURSE * SIM_LINE_HALFWIDTH;
+    bool quiet = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:b:m:r:x:y:a:e:l:n:s:v:k:t:o:w:q")) != -1) {
+        switch (opt) {
+            case 'c': courseFile = optarg; break;
+            case 'b':
+                if (sscanf(optarg, "%lf:%lf", &blueFrom, &blueTo) != 2) {
+                    fprintf(stderr, "-b takes from:to\n");
+                    return 2;
+                }
+                break;
+            case 'm': ppmFile = optarg; break;
+            case 'r': mmPerPx = atof(optarg); break;
+            case 'x': x0 = atof(optarg); break;
+            case 'y': y0 = atof(optarg); break;
+            case 'a': a0 = atof(optarg); break;
+            case 'e': e0 = atof(optarg); break;
+            case 'l': config.lightGain = atof(optarg); break;
+            case 'n': config.noise = atof(optarg); break;
+            case 's': config.seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'v': config.batteryMV = atoi(optarg); break;
+            case 'k': config.backAt = (uint64_t)(atof(optarg) * 1000000.0); break;
+            case 't': config.timeLimit = (uint64_t)(atof(optarg) * 1000000.0); break;
+            case 'o': csvFile = optarg; break;
+            case 'w': mapFile = optarg; break;
+            case 'q': quiet = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-c course] [-b from:to] [-m ppm -r mm -x mm -y mm -a degree] [-e mm]\n"
+                                "       [-l gain] [-n sigma] [-s seed] [-v mV] [-k second] [-t second]\n"
+                                "       [-o csv] [-w ppm] [-q]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    CourseRaster raster;
+    if (ppmFile != NULL) {
+        if (!raster.loadPPM(ppmFile, mmPerPx)) {
+            fprintf(stderr, "cannot load %s\n", ppmFile);
+            return 2;
+        }
+    } else {
+        CourseMap map;
+        if (!map.load(courseFile)) {
+            fprintf(stderr, "cannot load %s\n", courseFile);
+            return 2;
+        }
+        if (blueFrom < 0.0) {
+            blueFrom = map.getLength() - 300.0;
+            blueTo = map.getLength();
+        }
+        raster.render(courseFile, blueFrom, blueTo);
+    }
+    if (mapFile != NULL && !raster.savePPM(mapFile)) {
+        fprintf(stderr, "cannot write %s\n", mapFile);
+        return 2;
+    }
+
+    SimWorld world(&raster, config);
+    simWorld = &world;
+    if (ppmFile != NULL) {
+        world.place(x0, y0, a0 * M_PI / 180.0);
+    } else {
+        /* the color sensor on the start of the line */
+        double x, y, theta;
+        raster.getPoseAt(0.0, x, y, theta);
+        world.place(x - SIM_SENSOR_AHEAD * cos(theta) - e0 * sin(theta),
+                    y - SIM_SENSOR_AHEAD * sin(theta) + e0 * cos(theta), theta);
+    }
+    RunRecord rec = { &raster, NULL, 0.0, 0.0 };
+    if (csvFile != NULL) {
+        rec.csv = fopen(csvFile, "w");
+        if (rec.csv == NULL) {
+            fprintf(stderr, "cannot write %s\n", csvFile);
+            return 2;
+        }
+        fprintf(rec.csv, "time,x,y,heading,progress,offset,pwmL,pwmR,r,g,b,state\n");
+    }
+    world.setTracer(trace, &rec, PERIOD_UPD_TSK);
+    if (quiet && freopen("/dev/null", "w", stdout) == NULL) {
+        return 2;
+    }
+
+    main_task(0);
+
+    fflush(stdout);
+    if (rec.csv != NULL) fclose(rec.csv);
+    fprintf(stderr, "%s at %.3f s", world.isTimedOut() ? "timed out" : "main task woken up",
+            world.getTime() / 1000000.0);
+    if (raster.getLength() > 0.0) {
+        fprintf(stderr, ", %.0f of %.0f mm along the course, max offset %.1f mm",
+                rec.progress, raster.getLength(), rec.maxOffset);
+    }
+    fprintf(stderr, "\n");
+    return world.isTimedOut() ? 1 : 0;
+}
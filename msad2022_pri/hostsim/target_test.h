@@ -0,0 +1,9 @@
+/*
+    target_test.h
+    empty stand-in of the TOPPERS target test header, for hostsim
+
+    Copyright © 2022 MSAD Mode2P. All rights reserved.
+*/
+#ifndef target_test_h
+#define target_test_h
+#endif /* target_test_h */
@@ -0,0 +1,111 @@
+// this example shows how DeadlineMonitor tells the overruns of a 10 ms task activated by TNFY_ACTTSK
+// and escalates the actions, with the policy of overrun_policy() in app.cpp;
+// it checks that logging stays shed, as logShed in update_task(), until a tick runs as usual in time,
+// and that a clock going backwards during an activation, as ev3clock by ResetClock, is not measured
+//
+// g++ -std=gnu++11 DeadlineMonitor_demo.cpp ../DeadlineMonitor.cpp && ./a.out
+#include <iostream>
+using namespace std;
+#include "../DeadlineMonitor.hpp"
+
+#define PERIOD          10000   // PERIOD_UPD_TSK in microsecond
+#define OVR_SHED_AFTER  3
+#define OVR_STOP_AFTER  10
+
+OverrunAction overrun_policy(uint32_t consecutive) {
+    if (consecutive >= OVR_STOP_AFTER) {
+        return OVR_SAFE_STOP;
+    } else if (consecutive >= OVR_SHED_AFTER) {
+        return OVR_SHED_LOG;
+    } else {
+        return OVR_SKIP_TICK;
+    }
+}
+
+static const char* names[] = { "OVR_NONE", "OVR_SKIP_TICK", "OVR_SHED_LOG", "OVR_SAFE_STOP" };
+
+// the activations to run with logging shed: from the burst, escalated to OVR_SHED_LOG at 3 overruns,
+// to the first normal tick that ends in time, then from the stuck tree on to the end
+static bool expectShed(uint32_t now) {
+    return (now >= 143000 && now <= 150000) || now >= 245000;
+}
+
+// execution time of the behavior tree in microsecond; a skipped tick only drives the motors
+static uint32_t execTime(int tick) {
+    if (tick == 3) return 14000;                    // a single spike
+    if (tick >= 8 && tick < 10) return 23000;       // a burst
+    if (tick >= 16) return 35000;                   // stuck for good
+    return 6000;
+}
+
+// the task on a single core under TOPPERS, where act_tsk() queues one activation
+class Kernel {
+public:
+    Kernel(DeadlineMonitor& monitor) : m(monitor),running(false),queued(false),stopped(false),
+        busyUntil(0),tick(0),failures(0) {}
+    // the cyclic handler at time of release, after the task has run up to then
+    void release(uint32_t time) {
+        while (running && busyUntil <= time) {
+            m.end(busyUntil);
+            running = false;
+            if (queued && !stopped) {
+                queued = false;
+                start(busyUntil);
+            }
+        }
+        if (stopped) return;
+        if (!running) {
+            start(time);
+        } else if (!queued) {
+            queued = true;
+            cout << " t=" << time / 1000.0 << "ms: still running, activation queued" << endl;
+        } else {
+            cout << " t=" << time / 1000.0 << "ms: still running, E_QOVR" << endl;
+        }
+    }
+    DeadlineMonitor& m;
+    bool running, queued, stopped;
+    uint32_t busyUntil;
+    int tick, failures;
+protected:
+    void start(uint32_t time) {
+        OverrunAction action = m.begin(time);
+        uint32_t exec = (action == OVR_NONE) ? execTime(tick++) : 500;
+        busyUntil = time + exec;
+        running = true;
+        bool logShed = (m.getDegraded() >= OVR_SHED_LOG);
+        bool ok = (logShed == expectShed(time));
+        cout << " t=" << time / 1000.0 << "ms: " << names[action] << ", runs " << exec << "us"
+             << (logShed ? ", logging shed" : "") << (ok ? "" : " FAILED") << endl;
+        if (!ok) failures++;
+        if (action == OVR_SAFE_STOP) stopped = true;
+    }
+};
+
+int main() {
+    DeadlineMonitor m(PERIOD, overrun_policy);
+    Kernel kernel(m);
+    for (uint32_t now = 0; now < 800000 && !kernel.stopped; now += PERIOD) kernel.release(now);
+    int failures = kernel.failures;
+    cout << m.getActivations() << " activations, " << m.getOverruns() << " overruns, consecutive "
+         << m.getConsecutive() << ", max " << m.getMaxExecTime() << "us" << endl;
+    if (!kernel.stopped) failures++;
+
+    /* 6 ms every period, while the clock is reset to 0 at 12 ms, i.e., in the second activation */
+    cout << "the clock reset during an activation:" << endl;
+    DeadlineMonitor r(PERIOD, overrun_policy);
+    bool inTime = true;
+    for (uint32_t now = 0; now < 50000; now += PERIOD) {
+        uint32_t begin = (now < 12000) ? now : now - 12000, end = (now + 6000 < 12000) ? now + 6000 : now + 6000 - 12000;
+        if (r.begin(begin) != OVR_NONE) inTime = false;
+        r.end(end);
+        cout << " t=" << now / 1000 << "ms: clock " << begin << " to " << end << "us, "
+             << (end < begin ? "not measured" : "measured") << ", last " << r.getLastExecTime() << "us" << endl;
+    }
+    bool ok = inTime && r.getOverruns() == 0 && r.getMaxExecTime() == 6000;
+    cout << " " << r.getOverruns() << " overruns, max " << r.getMaxExecTime() << "us" << (ok ? "" : " FAILED") << endl;
+    if (!ok) failures++;
+
+    cout << (failures == 0 ? "all passed" : "FAILED") << endl;
+    return failures;
+}
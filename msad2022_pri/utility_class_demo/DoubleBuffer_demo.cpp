@@ -0,0 +1,210 @@
+// this example validates DoubleBuffer for the MULTI_RATE tasks of app.cpp
+// with POSIX threads standing in for the cyclic handlers and tasks of TOPPERS
+//
+// g++ -std=gnu++11 -O2 -pthread DoubleBuffer_demo.cpp && ./a.out
+#include <iostream>
+#include <atomic>
+#include <pthread.h>
+#include <time.h>
+#include <stdint.h>
+using namespace std;
+#include "../DoubleBuffer.hpp"
+
+// stand-in for SensorSnapshot; every field is derived from n to detect a torn copy
+struct Snapshot {
+    uint32_t n, time;
+    int32_t angL, angR, armCount;
+    int16_t rgb[3], gyroAngle, sonarDistance;
+    int batteryVoltage;
+    bool consistent() const {
+        return angL == (int32_t)n * 3 && angR == -(int32_t)n && armCount == (int32_t)(n ^ 0x5a5a) &&
+               rgb[0] == (int16_t)n && rgb[1] == (int16_t)(n >> 3) && rgb[2] == (int16_t)(n >> 7) &&
+               gyroAngle == (int16_t)(n * 7) && sonarDistance == (int16_t)(n + 1) && batteryVoltage == (int)n * 2;
+    }
+    void fill(uint32_t k, uint32_t t) {
+        n = k; time = t; angL = k * 3; angR = -(int32_t)k; armCount = k ^ 0x5a5a;
+        rgb[0] = k; rgb[1] = k >> 3; rgb[2] = k >> 7; gyroAngle = k * 7; sonarDistance = k + 1; batteryVoltage = k * 2;
+    }
+};
+
+// stand-in for MotorCommand, with the time it was issued
+struct Command {
+    int pwm;
+    double mmps;
+    bool velocity;
+    uint32_t issued;
+};
+
+static uint32_t now_us() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+}
+
+// ---- stand-in for CRE_TSK + CRE_CYC {TNFY_ACTTSK}, i.e., a periodic task by priority ----
+static atomic<bool> running;
+struct CyclicTask {
+    CyclicTask(const char* n, int prio, uint32_t p, void (*tsk)(intptr_t)) :
+        name(n),priority(prio),period(p),task(tsk),thread(),activations(0) {}
+    const char* name;
+    int priority;       // larger is higher as SCHED_FIFO, unlike TOPPERS
+    uint32_t period;    // microsecond
+    void (*task)(intptr_t);
+    pthread_t thread;
+    uint32_t activations;
+};
+static bool fifo = true;
+
+static void* cyclic_handler(void* arg) {
+    CyclicTask* t = (CyclicTask*)arg;
+    timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (running) {
+        t->task(0);
+        t->activations++;
+        next.tv_nsec += t->period * 1000L;
+        while (next.tv_nsec >= 1000000000L) { next.tv_nsec -= 1000000000L; next.tv_sec++; }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+    }
+    return nullptr;
+}
+
+static void sta_cyc(CyclicTask& t) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    sched_param sp;
+    sp.sched_priority = t.priority;
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &sp);
+    if (pthread_create(&t.thread, &attr, cyclic_handler, &t) != 0) {
+        /* not permitted to use real-time priorities; run them as normal threads */
+        fifo = false;
+        pthread_create(&t.thread, nullptr, cyclic_handler, &t);
+    }
+    pthread_attr_destroy(&attr);
+}
+
+// ---- part 1: stress, a writer and readers racing in threads ----
+template<typename B> struct Stress {
+    B* buf;
+    atomic<uint64_t> reads, torn;
+};
+
+struct Naive {
+    Snapshot s;
+    void write(const Snapshot& v) { s = v; _compiler_barrier(); }
+    void read(Snapshot& v) const { _compiler_barrier(); v = s; _compiler_barrier(); }
+};
+
+template<typename B> static void* stress_writer(void* arg) {
+    Stress<B>* st = (Stress<B>*)arg;
+    Snapshot s;
+    for (uint32_t k = 1; running; k++) { s.fill(k, 0); st->buf->write(s); }
+    return nullptr;
+}
+
+template<typename B> static void* stress_reader(void* arg) {
+    Stress<B>* st = (Stress<B>*)arg;
+    Snapshot s;
+    uint64_t reads = 0, torn = 0;
+    while (running) {
+        st->buf->read(s);
+        reads++;
+        if (!s.consistent()) torn++;
+    }
+    st->reads += reads;
+    st->torn += torn;
+    return nullptr;
+}
+
+template<typename B> static void stress(const char* name, B* buf) {
+    Stress<B> st;
+    st.buf = buf;
+    st.reads = 0;
+    st.torn = 0;
+    running = true;
+    pthread_t w, r[2];
+    pthread_create(&w, nullptr, stress_writer<B>, &st);
+    for (auto& t : r) pthread_create(&t, nullptr, stress_reader<B>, &st);
+    timespec one = { 1, 0 };
+    nanosleep(&one, nullptr);
+    running = false;
+    pthread_join(w, nullptr);
+    for (auto& t : r) pthread_join(t, nullptr);
+    cout << " " << name << ": " << st.reads << " reads, " << st.torn << " torn" << endl;
+}
+
+// ---- part 2: CTL_TSK, UPD_TSK and LOG_TSK of app.cpp under MULTI_RATE ----
+static Snapshot init;
+static DoubleBuffer<Snapshot> snapshots(init);
+static DoubleBuffer<Command> commands({ 0, 0.0, false, 0 });
+static uint32_t sensedCount, lastIssued;
+static uint64_t ageSum, latencySum, latched;
+static uint32_t ageMax, latencyMax, tornCount, updRuns, logRuns;
+
+// sense, plot and drive as control_task()
+static void control_task(intptr_t) {
+    Snapshot s;
+    s.fill(++sensedCount, now_us());
+    snapshots.write(s);
+    Command c;
+    commands.read(c);
+    if (c.issued != lastIssued) {
+        /* a new command from UPD_TSK reaches the wheels now */
+        uint32_t latency = now_us() - c.issued;
+        latencySum += latency;
+        if (latency > latencyMax) latencyMax = latency;
+        latched++;
+        lastIssued = c.issued;
+    }
+}
+
+// traverse the trees as update_task()
+static void update_task(intptr_t) {
+    Snapshot s;
+    snapshots.read(s);
+    if (!s.consistent()) tornCount++;
+    uint32_t age = now_us() - s.time;
+    ageSum += age;
+    if (age > ageMax) ageMax = age;
+    updRuns++;
+    commands.write({ (int)(s.n % 100), 300.0, (s.n & 1) != 0, now_us() });
+}
+
+static void log_task(intptr_t) {
+    Snapshot s;
+    snapshots.read(s);
+    if (!s.consistent()) tornCount++;
+    logRuns++;
+}
+
+int main() {
+    cout << "stress for 1 second, a writer and two readers in parallel" << endl;
+    Naive naive;
+    naive.s.fill(0, 0);
+    stress("plain copy  ", &naive);
+    DoubleBuffer<Snapshot> db(init);
+    stress("DoubleBuffer", &db);
+
+    cout << "CTL_TSK every 4 ms, UPD_TSK every 10 ms and LOG_TSK every 100 ms for 3 seconds" << endl;
+    init.fill(0, now_us());
+    snapshots.write(init);
+    CyclicTask ctl("CTL_TSK", 3, 4000, control_task), upd("UPD_TSK", 2, 10000, update_task),
+               log("LOG_TSK", 1, 100000, log_task);
+    running = true;
+    sta_cyc(ctl);
+    sta_cyc(upd);
+    sta_cyc(log);
+    timespec three = { 3, 0 };
+    nanosleep(&three, nullptr);
+    running = false;
+    for (auto t : { &ctl, &upd, &log }) pthread_join(t->thread, nullptr);
+    cout << " scheduled by " << (fifo ? "SCHED_FIFO" : "SCHED_OTHER (no permission for SCHED_FIFO)") << endl;
+    cout << " activations: CTL_TSK " << ctl.activations << ", UPD_TSK " << upd.activations
+         << ", LOG_TSK " << log.activations << ", torn snapshots " << tornCount << endl;
+    cout << " snapshot age seen by UPD_TSK: mean " << ageSum / updRuns << " us, max " << ageMax << " us" << endl;
+    cout << " command latency to CTL_TSK: mean " << latencySum / latched << " us, max " << latencyMax << " us" << endl;
+    cout << " (single-rate UPD_TSK senses and drives every 10000 us)" << endl;
+    return 0;
+}
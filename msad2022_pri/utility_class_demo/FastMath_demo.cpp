@@ -0,0 +1,46 @@
+// this example compares accuracy and throughput of FastMath against libm
+//
+// g++ -std=gnu++11 -O2 FastMath_demo.cpp ../FastMath.cpp && ./a.out
+#include <iostream>
+#include <chrono>
+using namespace std;
+#include "../FastMath.hpp"
+
+#define N 1000000
+
+template<typename F> double measure(F f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double, nano>(end - start).count() / N;
+}
+
+int main() {
+    double errSin = 0.0, errCos = 0.0, errSinQ = 0.0, errAtan = 0.0;
+    for (int i = 0; i < N; i++) {
+        float rad = (float)(4.0 * M_PI * i / N - 2.0 * M_PI);
+        float s, c;
+        fm_sincos(rad, s, c);
+        errSin = fmax(errSin, fabs(s - sin(rad)));
+        errCos = fmax(errCos, fabs(c - cos(rad)));
+        int16_t sq, cq;
+        fm_sincos_q14(fm_rad_to_bam(rad), sq, cq);
+        errSinQ = fmax(errSinQ, fabs((double)sq / FM_Q14_ONE - sin(rad)));
+        float y = sin(rad), x = cos(rad) * 0.7F;
+        errAtan = fmax(errAtan, fabs(fm_atan2(y, x) - atan2(y, x)));
+    }
+    cout << "table entries per turn = " << FM_TABLE_SIZE << endl;
+    cout << " max error: fm_sincos = " << errSin << " / " << errCos
+         << ", fm_sincos_q14 = " << errSinQ << ", fm_atan2 = " << errAtan << endl;
+
+    volatile float sink = 0.0F;
+    volatile int16_t sinkQ = 0;
+    double libm = measure([&] { for (int i = 0; i < N; i++) { double r = i * 1.0e-5; sink = sin(r) + cos(r); } });
+    double fast = measure([&] { for (int i = 0; i < N; i++) { float s, c; fm_sincos(i * 1.0e-5F, s, c); sink = s + c; } });
+    double fixq = measure([&] { for (int i = 0; i < N; i++) { int16_t s, c; fm_sincos_q14((uint16_t)i, s, c); sinkQ = s + c; } });
+    double atanLibm = measure([&] { for (int i = 0; i < N; i++) { sink = atan2(i * 1.0e-5, 128.0); } });
+    double atanFast = measure([&] { for (int i = 0; i < N; i++) { sink = fm_atan2(i * 1.0e-5F, 128.0F); } });
+    cout << " ns per call: sin+cos = " << libm << ", fm_sincos = " << fast << ", fm_sincos_q14 = " << fixq << endl;
+    cout << " ns per call: atan2 = " << atanLibm << ", fm_atan2 = " << atanFast << endl;
+    return 0;
+}
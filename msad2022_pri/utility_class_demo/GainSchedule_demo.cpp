@@ -0,0 +1,82 @@
+// this example loads gain schedules and checks the bilinear interpolation and the clamping
+// of GainSchedule::lookup(), and that a broken schedule is rejected keeping the gains in use
+//
+// g++ -std=gnu++11 GainSchedule_demo.cpp ../GainSchedule.cpp && ./a.out
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+using namespace std;
+#include "../GainSchedule.hpp"
+
+// the example of GainSchedule.hpp with a third speed, the rows in no particular order
+static const char* schedule =
+    "speed,curvature,p,i,d\n"
+    "60,0.0,0.60,0.30,0.08\n"
+    "45,0.0,0.75,0.39,0.08\n"
+    "45,2.5,0.90,0.39,0.10\n"
+    "60,2.5,0.80,0.30,0.12\n"
+    "75,2.5,0.70,0.20,0.16\n"
+    "75,0.0,0.50,0.20,0.08\n";
+// 60,2.5 missing
+static const char* incomplete =
+    "45,0.0,1,1,1\n45,2.5,1,1,1\n60,0.0,1,1,1\n";
+// 45,0.0 given twice and 60,2.5 missing
+static const char* duplicate =
+    "45,0.0,1,1,1\n45,2.5,1,1,1\n60,0.0,1,1,1\n45,0.0,1,1,1\n";
+
+static bool loadText(GainSchedule& gs, const char* text) {
+    char path[] = "/tmp/GainSchedule_demoXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, text, strlen(text)) < 0) return false;
+    close(fd);
+    bool loaded = gs.load(path);
+    unlink(path);
+    return loaded;
+}
+
+static int failures = 0;
+
+static void check(const GainSchedule& gs, const char* what, double speed, double curvature,
+                  double p, double i, double d) {
+    double gp, gi, gd;
+    gs.lookup(speed, curvature, gp, gi, gd);
+    bool ok = fabs(gp - p) < 1e-9 && fabs(gi - i) < 1e-9 && fabs(gd - d) < 1e-9;
+    printf(" %-28s speed %5.1f, curvature %4.2f: p %.4f, i %.4f, d %.4f%s\n",
+           what, speed, curvature, gp, gi, gd, ok ? "" : "  FAILED");
+    if (!ok) failures++;
+}
+
+int main() {
+    GainSchedule gs(0.75, 0.39, 0.08);
+    cout << "flat schedule before loading:" << endl;
+    check(gs, "anywhere", 52.0, 1.3, 0.75, 0.39, 0.08);
+
+    bool loaded = loadText(gs, schedule);
+    cout << "schedule of 3 speeds and 2 curvatures " << (loaded ? "loaded" : "NOT loaded") << ":" << endl;
+    if (!loaded) failures++;
+    check(gs, "grid point", 45.0, 2.5, 0.90, 0.39, 0.10);
+    check(gs, "grid point", 75.0, 0.0, 0.50, 0.20, 0.08);
+    /* halfway along one axis, then between four grid points */
+    check(gs, "between speeds", 52.5, 0.0, 0.675, 0.345, 0.08);
+    check(gs, "between curvatures", 60.0, 1.25, 0.70, 0.30, 0.10);
+    /* a quarter toward 2.5 gives p 0.65 at speed 60 and 0.55 at 75, d 0.09 and 0.10 */
+    check(gs, "bilinear", 67.5, 0.625, (0.65 + 0.55) / 2.0, 0.25, (0.09 + 0.10) / 2.0);
+    /* beyond the grid, the nearest edge */
+    check(gs, "clamped below", 30.0, -1.0, 0.75, 0.39, 0.08);
+    check(gs, "clamped above", 90.0, 5.0, 0.70, 0.20, 0.16);
+    check(gs, "clamped speed only", 90.0, 1.25, 0.60, 0.20, 0.12);
+
+    cout << "broken schedules, rejected with the gains kept:" << endl;
+    if (loadText(gs, incomplete)) failures++;
+    check(gs, "after an incomplete grid", 45.0, 2.5, 0.90, 0.39, 0.10);
+    if (loadText(gs, duplicate)) failures++;
+    check(gs, "after a duplicate", 45.0, 2.5, 0.90, 0.39, 0.10);
+    if (gs.load("/nonexistent/schedule.txt")) failures++;
+    check(gs, "after a missing file", 45.0, 2.5, 0.90, 0.39, 0.10);
+
+    cout << (failures == 0 ? "all passed" : "FAILED") << endl;
+    return failures;
+}
@@ -0,0 +1,169 @@
+// this example compares LineMPC with PIDcontroller tracing a simulated course,
+// shows the distribution of the MPC solve time and checks the feed-forward of the course curvature
+// signed as TraceLineWithPreview and TraceLineMPC of app.cpp for both courses and trace sides
+//
+// g++ -std=gnu++11 -O2 LineMPC_demo.cpp ../LineMPC.cpp && ./a.out
+#include <iostream>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+using namespace std;
+#include "../LineMPC.hpp"
+#include "../PIDcontroller.hpp"
+
+#define DT          10000   // PERIOD_UPD_TSK in microsecond
+#define WHEEL_TREAD 128.0   // as in Plotter.hpp
+#define MMPS_PER_PWM 5.0    // forward speed per pwm
+#define EDGE_SLOPE  5.5     // brightness per mm across the edge
+#define TARGET      47.0    // GS_TARGET
+#define SPEED       50
+#define SENSOR_AHEAD 60.0
+#define STEPS       1000
+#define STEP_DIST   (SPEED * MMPS_PER_PWM * DT / 1000000.0)    // mm run per tick
+
+enum TraceSide { TS_NORMAL, TS_OPPOSITE };      // as appusr.hpp
+
+// curvature in 1/mm of the course: straight, left curve of 500 mm radius, right curve of 400 mm radius
+static double courseCurvature(int k) {
+    if (k < 200) return 0.0;
+    if (k < 550) return 1.0 / 500.0;
+    if (k < 850) return -1.0 / 400.0;
+    return 0.0;
+}
+
+// curvature of the course map at the distance in radian per mm, clockwise positive as CourseMap gives
+static double mapCurvature(double dist) {
+    return -courseCurvature((int)floor(dist / STEP_DIST));
+}
+
+// kinematic robot over the edge of a line as in RelayTuner_demo.cpp;
+// the reflection is delayed by two samples as FIR_Transposed in FilteredColorSensor does.
+// y and psi are positive to the left, and so are turn and curvature of step();
+// edge is 1 tracing the left edge of the line, i.e., brighter to the left, or -1 the right edge
+struct LinePlant {
+    double y = 5.0, psi = 0.0, edge = 1.0;
+    double buf[3] = {TARGET, TARGET, TARGET};
+    double sense() {
+        double r = TARGET + edge * EDGE_SLOPE * (y + SENSOR_AHEAD * sin(psi));
+        r = fmin(fmax(r, 5.0), 90.0);
+        buf[2] = buf[1]; buf[1] = buf[0]; buf[0] = r;
+        return buf[2];
+    }
+    void step(double turn, double curvature) {
+        double dt = DT / 1000000.0, v = SPEED * MMPS_PER_PWM;
+        double omega = 2.0 * turn * MMPS_PER_PWM / WHEEL_TREAD;
+        psi += (omega - v * curvature) * dt;
+        y += v * sin(psi) * dt;
+    }
+};
+
+struct Result { double rms, peak; };
+
+// controller(sensor, k) gives the turn at the k-th tick
+template<class F> static Result trace(F controller, double edge = 1.0) {
+    LinePlant plant;
+    plant.edge = edge;
+    double sum = 0.0, peak = 0.0;
+    for (int k = 0; k < STEPS; k++) {
+        double sensor = plant.sense();
+        double turn = controller(sensor, k);
+        turn = fmin(fmax(turn, -SPEED), SPEED);
+        plant.step(turn, courseCurvature(k));
+        if (k >= 100) {
+            double err = sensor - TARGET;
+            sum += err * err;
+            peak = fmax(peak, fabs(err));
+        }
+    }
+    return { sqrt(sum / (STEPS - 100)), peak };
+}
+
+static void report(const char* name, Result r) {
+    cout << " " << name << ": rms error = " << r.rms << ", peak error = " << r.peak << endl;
+}
+
+// the turn of TraceLine::update() given the feed-forward of TraceLineWithPreview::feedForward(),
+// which is computed from the curvature of the course map
+static double traceLine(PIDcontroller<float>& pid, double sensor, double curvature, int course, TraceSide side) {
+    double ff = -curvature * WHEEL_TREAD * SPEED / 2.0;
+    if (side == TS_NORMAL) return (-1) * course * pid.compute(sensor, TARGET, (-1) * course * ff);
+    return course * pid.compute(sensor, TARGET, course * ff);
+}
+
+// the turn of TraceLineMPC::update()
+static double traceLineMPC(LineMPC& mpc, double sensor, double curvature, int course, TraceSide side) {
+    double offset = (sensor - TARGET) / EDGE_SLOPE;
+    if (side == TS_NORMAL) return course * mpc.compute(offset, (-1) * course * curvature);
+    return (-1) * course * mpc.compute(offset, course * curvature);
+}
+
+int main() {
+    cout << "tracking error in brightness over straight, R500 left and R400 right" << endl;
+    {
+        PIDcontroller<float> pid(0.75, 0.39, 0.08, DT, -SPEED, SPEED, AW_CONDITIONAL);
+        report("PID default          ", trace([&](double s, int) { return -pid.compute(s, TARGET); }));
+    }
+    {
+        // as tuned by RelayTuner_demo.cpp on the same plant
+        PIDcontroller<float> pid(0.668, 2.25, 0.0143, DT, -SPEED, SPEED, AW_CONDITIONAL);
+        report("PID Tyreus-Luyben    ", trace([&](double s, int) { return -pid.compute(s, TARGET); }));
+    }
+    vector<double> us;
+    int sweeps = 0, calls = 0;
+    {
+        LineMPC mpc(SPEED * MMPS_PER_PWM, 2.0 * MMPS_PER_PWM / WHEEL_TREAD, SENSOR_AHEAD, DT, SPEED, 1.0, 0.0, 1.0e-3, 1.0e-2);
+        report("MPC                  ", trace([&](double s, int) {
+            auto t0 = chrono::steady_clock::now();
+            double u = mpc.compute((s - TARGET) / EDGE_SLOPE);
+            auto t1 = chrono::steady_clock::now();
+            us.push_back(chrono::duration<double, micro>(t1 - t0).count());
+            sweeps += mpc.getIterations();
+            calls++;
+            return u;
+        }));
+    }
+    sort(us.begin(), us.end());
+    cout << "MPC of horizon " << MPC_HORIZON << " solve time in microsecond over " << calls << " ticks, " << (double)sweeps / calls << " sweeps on average" << endl;
+    cout << " min = " << us.front() << ", median = " << us[us.size() / 2]
+         << ", 99% = " << us[us.size() * 99 / 100] << ", max = " << us.back() << endl;
+
+    /* _COURSE 1 is the L course, where TS_NORMAL traces the left edge; -1 the R course the right edge */
+    int failures = 0;
+    cout << "feed-forward of the course map, with the PID of Tyreus-Luyben and FF_PREVIEW_DIST 0" << endl;
+    for (int course : { 1, -1 }) {
+        for (TraceSide side : { TS_NORMAL, TS_OPPOSITE }) {
+            double edge = ((course == 1) == (side == TS_NORMAL)) ? 1.0 : -1.0;
+            cout << (course == 1 ? "L" : "R") << " course, " << (side == TS_NORMAL ? "TS_NORMAL" : "TS_OPPOSITE")
+                 << ", the " << (edge > 0.0 ? "left" : "right") << " edge" << endl;
+            Result r[5];
+            /* no course map, the exact map, and the map 15 mm early, i.e., sections ending 15 mm short */
+            double shifts[3] = { 0.0, 0.0, 15.0 };
+            for (int m = 0; m < 3; m++) {
+                PIDcontroller<float> pid(0.668, 2.25, 0.0143, DT, -SPEED, SPEED, AW_CONDITIONAL);
+                r[m] = trace([&](double s, int k) {
+                    double curvature = (m == 0) ? 0.0 : mapCurvature(k * STEP_DIST + shifts[m]);
+                    return traceLine(pid, s, curvature, course, side);
+                }, edge);
+            }
+            for (int m = 0; m < 2; m++) {
+                LineMPC mpc(SPEED * MMPS_PER_PWM, 2.0 * MMPS_PER_PWM / WHEEL_TREAD, SENSOR_AHEAD, DT, SPEED, 1.0, 0.0, 1.0e-3, 1.0e-2);
+                r[3 + m] = trace([&](double s, int k) {
+                    double curvature = (m == 0) ? 0.0 : mapCurvature(k * STEP_DIST);
+                    return traceLineMPC(mpc, s, curvature, course, side);
+                }, edge);
+            }
+            report("TraceLine            ", r[0]);
+            report("TraceLineWithPreview ", r[1]);
+            report(" with the map 15 mm early", r[2]);
+            report("TraceLineMPC, no map ", r[3]);
+            report("TraceLineMPC         ", r[4]);
+            /* a wrong sign would make the feed-forward worse than none */
+            if (r[1].rms >= r[0].rms || r[4].rms >= r[3].rms) {
+                cout << " FAILED: the feed-forward does not help" << endl;
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
@@ -0,0 +1,102 @@
+// this example runs Localizer on a synthetic course with wheel slip, comparing its estimate
+// and the raw odometry with the true distance, and measures the time taken by update()
+//
+// g++ -std=gnu++11 -O2 -I../hostsim Localizer_demo.cpp ../Localizer.cpp ../CourseMap.cpp ../Plotter.cpp ../FastMath.cpp && ./a.out
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+using namespace std;
+#include "../Localizer.hpp"
+
+#define PERIOD      10000   // PERIOD_UPD_TSK in microsecond
+#define STEP        6.0     // mm per tick at 600 mm/s
+#define SLIP        0.05    // the wheels travel 5% less than the encoders read
+#define LANDMARK    10.0    // mm from a landmark within which the color sensor reads CL_JETBLACK
+
+// ---- stand-ins of the devices declared by the headers of hostsim, as in Plotter_demo.cpp ----
+static int32_t counts[4];   // encoder of each motor port
+static uint64_t simTime;    // simulated time in microsecond
+
+namespace ev3api {
+Clock::Clock() : mStartTime(simTime) {}
+uint32_t Clock::now() const { return (uint32_t)(simTime - mStartTime); }
+Motor::Motor(ePortM port, bool brake, motor_type_t) : mPort(port),mBrake(brake) {}
+Motor::~Motor() {}
+void Motor::reset() { counts[mPort] = 0; }
+int32_t Motor::getCount() const { return counts[mPort]; }
+GyroSensor::GyroSensor(ePortS port) : mPort(port),mOffset(0) {}
+GyroSensor::~GyroSensor() {}
+void GyroSensor::reset() {}
+}
+
+// 5 m of straights and curves in the format of BlindRunner_prop.txt with three CL_JETBLACK crossings
+static const char* course =
+    "lable,distanceTo,curvature\n"
+    "st00,00800,0\n"
+    "cv01,01600,-0.4\n"
+    "jb01,01700,0\n"
+    "st02,02200,0\n"
+    "cv03,02900,0.3\n"
+    "st04,03400,0\n"
+    "jb02,03300,0\n"
+    "cv05,04200,-0.25\n"
+    "jb03,04500,0\n"
+    "st06,05200,0\n";
+
+int main() {
+    char path[] = "/tmp/Localizer_demoXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, course, strlen(course)) < 0) return 1;
+    close(fd);
+    CourseMap map;
+    bool loaded = map.load(path);
+    unlink(path);
+    if (!loaded) return 1;
+
+    ev3api::Motor left(PORT_C), right(PORT_B);
+    ev3api::GyroSensor gyro(PORT_4);
+    Plotter plotter(&left, &right, &gyro);
+    Localizer localizer(&plotter, &map);
+
+    double s = 0.0, distL = 0.0, distR = 0.0, maxError = 0.0, total = 0.0, worst = 0.0;
+    int cursor = 0, updates = 0;
+    cout << "true distance, odometry and the estimate of Localizer with " << SLIP * 100.0 << "% slip:" << endl;
+    while (s < map.getLength() - STEP) {
+        /* the encoders read the wheel travel over the course plus the slip */
+        double k = map.getCurvature(map.seek(s + STEP / 2.0, cursor));
+        distL += STEP / (1.0 - SLIP) * (1.0 + k * WHEEL_TREAD / 2.0);
+        distR += STEP / (1.0 - SLIP) * (1.0 - k * WHEEL_TREAD / 2.0);
+        counts[PORT_C] = (int32_t)floor(distL / DIST_PER_DEGREE);
+        counts[PORT_B] = (int32_t)floor(distR / DIST_PER_DEGREE);
+        simTime += PERIOD;
+        s += STEP;
+        plotter.plot();
+
+        bool onLandmark = fabs(s - map.getNearestLandmark(s)) < LANDMARK;
+        auto t0 = chrono::steady_clock::now();
+        localizer.update(onLandmark);
+        double elapsed = chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count();
+        total += elapsed;
+        worst = fmax(worst, elapsed);
+        updates++;
+
+        Pose pose;
+        plotter.getPoseAt(plotter.getTime(), pose);
+        double error = localizer.getDistance() - s;
+        if (s > 1000.0) maxError = fmax(maxError, fabs(error));
+        if (updates % 100 == 0) {
+            printf(" %6.0f mm: odometry %+6.0f, estimate %+5.0f\n", s, pose.distance - s, error);
+        }
+    }
+    Pose pose;
+    plotter.getPoseAt(plotter.getTime(), pose);
+    printf(" at the end: odometry %+.0f mm, estimate %+d mm, %.0f mm at most after the first 1000 mm\n",
+           pose.distance - s, localizer.getDistance() - (int32_t)s, maxError);
+    printf("update() of %d particles: %.1f usec on average, %.1f usec at most on this host, against %d usec of a tick\n",
+           LOC_NUM_PARTICLES, total / updates, worst, PERIOD);
+    return (maxError < 50.0) ? 0 : 1;
+}
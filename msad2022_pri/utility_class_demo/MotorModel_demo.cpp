@@ -0,0 +1,73 @@
+// this example drives a simulated EV3 motor with and without MotorModel
+//
+// g++ -std=gnu++11 MotorModel_demo.cpp ../MotorModel.cpp && ./a.out
+#include <iostream>
+#include <cmath>
+using namespace std;
+#include "../MotorModel.hpp"
+
+#define DT      0.01    // PERIOD_UPD_TSK in second
+
+// motor with static friction, first-order lag and gear backlash between the encoder and the wheel;
+// the effective pwm is proportional to the battery voltage
+struct MotorPlant {
+    double battery;         // mV
+    double omega = 0.0;     // deg/s of the motor shaft
+    double motor = 0.0;     // deg of the motor shaft, i.e., the encoder
+    double wheel = 0.0;     // deg of the wheel
+    MotorPlant(double mV) : battery(mV) {}
+    int32_t count() const { return (int32_t)lrint(motor); }
+    void step(double pwm) {
+        const double friction = 7.0, degPerPwm = 11.0, tau = 0.05, gap = 8.0;
+        double effective = pwm * battery / 8000.0;
+        double mag = fabs(effective) - friction;
+        double target = (mag > 0.0) ? copysign(mag * degPerPwm, effective) : 0.0;
+        omega += (target - omega) * DT / tau;
+        motor += omega * DT;
+        // the wheel is pushed only by the side of the gap the motor is on
+        if (motor - wheel > gap / 2.0) wheel = motor - gap / 2.0;
+        if (wheel - motor > gap / 2.0) wheel = motor + gap / 2.0;
+    }
+};
+
+// wheel degree after driving pwm for the duration, through the model unless nullptr
+static double drive(MotorPlant& p, MotorModel* mm, double pwm, double seconds) {
+    double start = p.wheel;
+    if (mm != nullptr) mm->setBattery((int)p.battery);
+    for (int k = 0; k < lrint(seconds / DT); k++) {
+        p.step((mm != nullptr) ? mm->apply(pwm, p.count()) : pwm);
+    }
+    return p.wheel - start;
+}
+
+static double drive(double pwm, double seconds, double mV, bool model) {
+    MotorPlant p(mV);
+    MotorModel mm(6.0, 8, 20.0, 8000);
+    return drive(p, model ? &mm : nullptr, pwm, seconds);
+}
+
+int main() {
+    cout << "wheel degree in 1 s at pwm 3, e.g., approach speed of RotateEV3" << endl;
+    cout << " raw pwm     : " << drive(3.0, 1.0, 8000.0, false) << endl;
+    cout << " MotorModel  : " << drive(3.0, 1.0, 8000.0, true) << endl;
+
+    cout << "wheel degree in 1 s at pwm 30 at 7.2 V and 8.4 V" << endl;
+    cout << " raw pwm     : " << drive(30.0, 1.0, 7200.0, false) << ", " << drive(30.0, 1.0, 8400.0, false) << endl;
+    cout << " MotorModel  : " << drive(30.0, 1.0, 7200.0, true) << ", " << drive(30.0, 1.0, 8400.0, true) << endl;
+
+    cout << "msec until the wheel backs 5 degrees after reversing from pwm 15 to -15" << endl;
+    for (int model = 0; model < 2; model++) {
+        MotorPlant p(8000.0);
+        MotorModel mm(6.0, 8, 20.0, 8000);
+        MotorModel* m = model ? &mm : nullptr;
+        drive(p, m, 15.0, 0.5);
+        double peak = p.wheel;
+        int k;
+        for (k = 1; k <= 100; k++) {
+            drive(p, m, -15.0, DT);
+            if (peak - p.wheel >= 5.0) break;
+        }
+        cout << (model ? " MotorModel  : " : " raw pwm     : ") << k * DT * 1000.0 << endl;
+    }
+    return 0;
+}
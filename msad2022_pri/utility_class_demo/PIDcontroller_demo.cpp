@@ -0,0 +1,53 @@
+// this example shows step responses of PIDcontroller on a simulated plant
+//
+// g++ -std=gnu++11 PIDcontroller_demo.cpp && ./a.out
+#include <iostream>
+#include <cmath>
+using namespace std;
+#include "../PIDcontroller.hpp"
+
+#define DT      10000   // control period in microsecond
+#define STEPS   500
+
+// first-order plant with dead-time-free lag: tau * dy/dt = gain * u - y
+struct Plant {
+    double y = 0.0;
+    double step(double u) {
+        const double tau = 1.0, gain = 1.0;
+        y += (gain * u - y) * (DT / 1000000.0) / tau;
+        return y;
+    }
+};
+
+// the controller drives the plant output to the target; its error sign is (sensor - target),
+// hence the gains are negated the same as TraceLine negates the output for TS_NORMAL
+template<typename T> void run(const char* name, AntiWindup aw, double tf) {
+    PIDcontroller<T> pid(T(-3.0), T(-6.0), T(-0.05), DT, T(-18.0), T(18.0), aw, T(tf), T(5.0));
+    Plant plant;
+    double target = 0.0, peak = 0.0, settled = -1.0;
+    for (int k = 0; k < STEPS; k++) {
+        if (k == 10) target = 15.0;         // step up
+        double u = (double)pid.compute(T(plant.y), T(target));
+        double y = plant.step(u);
+        if (k >= 10) {
+            peak = fmax(peak, y);
+            if (fabs(y - target) > 0.02 * target) settled = -1.0;
+            else if (settled < 0.0) settled = (k - 10) * DT / 1000.0;
+        }
+    }
+    cout << " " << name << ": overshoot = " << (peak - 15.0) / 15.0 * 100.0 << "%, 2% settling = ";
+    if (settled < 0.0) cout << "not within " << STEPS * DT / 1000 << " ms";
+    else cout << settled << " ms";
+    cout << ", final = " << plant.y << endl;
+}
+
+int main() {
+    cout << "step 0 -> 15 with output limited to +/-18" << endl;
+    run<float>("float, AW_NONE           ", AW_NONE, 0.0);
+    run<float>("float, AW_CONDITIONAL    ", AW_CONDITIONAL, 0.0);
+    run<float>("float, AW_BACK_CALCULATION", AW_BACK_CALCULATION, 0.0);
+    run<float>("float, AW_CONDITIONAL, tf ", AW_CONDITIONAL, 0.02);
+    run<Q16>  ("Q16,   AW_NONE           ", AW_NONE, 0.0);
+    run<Q16>  ("Q16,   AW_CONDITIONAL    ", AW_CONDITIONAL, 0.0);
+    return 0;
+}
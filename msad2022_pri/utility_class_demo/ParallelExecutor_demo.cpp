@@ -0,0 +1,106 @@
+// this example evaluates line-trace speeds by Monte-Carlo runs of behavior trees
+// racing a toy run against a time limit, as the trees of app.cpp race TraceLine
+// against IsTimeEarned, ticked serially and then across all the cores
+//
+// g++ -std=gnu++11 -O2 -pthread ParallelExecutor_demo.cpp && ./a.out
+#include <iostream>
+#include <chrono>
+#include <math.h>
+using namespace std;
+#include "../ParallelExecutor.hpp"
+
+#define PERIOD      0.01    // PERIOD_UPD_TSK in second
+#define SUBSTEPS    50      // integration steps of the toy physics per tick
+#define GOAL        3000.0  // mm to run
+#define TIME_LIMIT  12.0    // second
+#define TRIALS      200     // runs per speed
+
+// state of a run kept in the Blackboard of its tree; nothing is shared between trees
+class ToyRun : public BrainTree::Node {
+public:
+    ToyRun(double speed) : speed(speed) {}
+    void initialize() override {
+        blackboard->setDouble("dist", 0.0);
+        blackboard->setDouble("off", 0.0);
+    }
+    Status update() override {
+        uint32_t rng = blackboard->getInt("seed");
+        double dist = blackboard->getDouble("dist"), off = blackboard->getDouble("off");
+        double dt = PERIOD / SUBSTEPS;
+        for (int i = 0; i < SUBSTEPS; i++) {
+            rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+            double noise = ((rng & 0xffff) / 32768.0 - 1.0) * 1500.0;
+            /* the faster, the more the lateral offset swings on the curves */
+            double curve = sin(dist / 300.0) * speed * speed / 25.0;
+            off += (curve + noise - 8.0 * off) * dt;
+            /* slows down when the robot strays from the line */
+            dist += speed * 10.0 * (1.0 - fmin(fabs(off) / 25.0, 0.9)) * dt;
+        }
+        blackboard->setInt("seed", (int)rng);
+        blackboard->setDouble("dist", dist);
+        blackboard->setDouble("off", off);
+        if (fabs(off) > 20.0) return Status::Failure;  // lost the line
+        return (dist >= GOAL) ? Status::Success : Status::Running;
+    }
+protected:
+    double speed;
+};
+
+class IsTimeEarned : public BrainTree::Node {
+public:
+    IsTimeEarned(double limit) : limit(limit) {}
+    Status update() override {
+        int ticks = blackboard->getInt("ticks") + 1;
+        blackboard->setInt("ticks", ticks);
+        return (ticks * PERIOD >= limit) ? Status::Success : Status::Running;
+    }
+protected:
+    double limit;
+};
+
+static const int speeds[] = { 30, 35, 40, 45, 50, 55, 60, 65 };
+#define NUM_SPEEDS  (int)(sizeof(speeds) / sizeof(speeds[0]))
+
+// one tree per trial; ParallelSequence(1, 1) ends on the first child to end
+static double evaluate(int numThreads, int success[], double& ticks) {
+    ParallelExecutor ex(numThreads);
+    for (int s = 0; s < NUM_SPEEDS; s++) {
+        for (int k = 0; k < TRIALS; k++) {
+            BrainTree::Node* tree = BrainTree::Builder()
+                .composite<BrainTree::ParallelSequence>(1, 1)
+                    .leaf<ToyRun>((double)speeds[s])
+                    .decorator<BrainTree::Inverter>()
+                        .leaf<IsTimeEarned>(TIME_LIMIT)
+                    .end()
+                .end()
+                .build();
+            tree->getBlackboard()->setInt("seed", 2463534242U ^ (k * 7919 + 1));
+            ex.add(tree);
+        }
+    }
+    auto t0 = chrono::steady_clock::now();
+    ex.run((int)(TIME_LIMIT / PERIOD) + 1);
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    ticks = 0.0;
+    for (int i = 0; i < ex.getSize(); i++) {
+        if (ex.getStatus(i) == BrainTree::Node::Status::Success) success[i / TRIALS]++;
+        ticks += ex.getTicks(i);
+    }
+    cout << " " << ex.getNumThreads() << " thread(s): " << elapsed << " sec" << endl;
+    return elapsed;
+}
+
+int main() {
+    int serial[NUM_SPEEDS] = {}, parallel[NUM_SPEEDS] = {};
+    double ticksSerial, ticksParallel;
+    cout << NUM_SPEEDS * TRIALS << " trees of " << TRIALS << " trials per speed" << endl;
+    double t1 = evaluate(1, serial, ticksSerial);
+    double tn = evaluate(0, parallel, ticksParallel);
+    cout << " speedup " << t1 / tn << ", " << ticksParallel << " tree ticks" << endl;
+    for (int s = 0; s < NUM_SPEEDS; s++) {
+        cout << " speed " << speeds[s] << ": " << 100.0 * parallel[s] / TRIALS << " % completed";
+        if (serial[s] != parallel[s]) cout << " (MISMATCH with serial " << serial[s] << ")";
+        cout << endl;
+    }
+    return (ticksSerial == ticksParallel) ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+// this example drives known paths through Plotter with the devices of ev3api stood in;
+// it compares the end-point error of the integrators over a slalom
+// and checks getDegreeChangeOver() while the heading crosses north, i.e., 0 and 360 degrees
+//
+// g++ -std=gnu++11 -I../hostsim Plotter_demo.cpp ../Plotter.cpp ../FastMath.cpp && ./a.out
+#include <iostream>
+#include <cmath>
+using namespace std;
+#include "../Plotter.hpp"
+
+#define PERIOD      10000   // PERIOD_UPD_TSK in microsecond
+#define STEP        6.0     // mm per tick at 600 mm/s
+#define SUBSTEPS    100     // of the ground truth per tick
+
+// ---- stand-ins of the devices declared by the headers of hostsim ----
+static int32_t counts[4];   // encoder of each motor port
+static uint64_t simTime;    // simulated time in microsecond
+
+namespace ev3api {
+Clock::Clock() : mStartTime(simTime) {}
+uint32_t Clock::now() const { return (uint32_t)(simTime - mStartTime); }
+Motor::Motor(ePortM port, bool brake, motor_type_t) : mPort(port),mBrake(brake) {}
+Motor::~Motor() {}
+void Motor::reset() { counts[mPort] = 0; }
+int32_t Motor::getCount() const { return counts[mPort]; }
+GyroSensor::GyroSensor(ePortS port) : mPort(port),mOffset(0) {}
+GyroSensor::~GyroSensor() {}
+void GyroSensor::reset() {}
+}
+
+// wheels following a path of the given curvature, positive to the right as the azimuth of Plotter,
+// along with the exact pose; the encoders read whole degrees of the wheel travel
+class Wheels {
+public:
+    Wheels() : distL(0.0), distR(0.0), x(0.0), y(0.0), theta(0.0) {}
+    void move(double dist, double curvature) {
+        distL += dist * (1.0 + curvature * WHEEL_TREAD / 2.0);
+        distR += dist * (1.0 - curvature * WHEEL_TREAD / 2.0);
+        double mid = theta + curvature * dist / 2.0;
+        x += dist * sin(mid);
+        y += dist * cos(mid);
+        theta += curvature * dist;
+    }
+    void tick() {
+        counts[PORT_C] = (int32_t)floor(distL / DIST_PER_DEGREE);
+        counts[PORT_B] = (int32_t)floor(distR / DIST_PER_DEGREE);
+        simTime += PERIOD;
+    }
+    double distL, distR, x, y, theta;
+};
+
+// a slalom of 36 m weaving by 1200 mm with the curvature up to 1/300 mm
+static double slalom(double s) {
+    return sin(2.0 * M_PI * s / 1200.0) / 300.0;
+}
+
+// replays the slalom through Plotter; returns the error of the location at the end and the maximum
+static double replay(Integrator integrator, double& maxError) {
+    ev3api::Motor left(PORT_C), right(PORT_B);
+    ev3api::GyroSensor gyro(PORT_4);
+    Plotter plotter(&left, &right, &gyro, integrator);
+    Wheels wheels;
+    double error = 0.0;
+    maxError = 0.0;
+    for (double s = 0.0; s < 36000.0; s += STEP) {
+        for (int k = 0; k < SUBSTEPS; k++) {
+            double ds = STEP / SUBSTEPS;
+            wheels.move(ds, slalom(s + (k + 0.5) * ds));
+        }
+        wheels.tick();
+        plotter.plot();
+        /* the pose in float rather than getLocX() and getLocY() truncated to mm */
+        Pose pose;
+        plotter.getPoseAt(plotter.getTime(), pose);
+        error = hypot(pose.x - wheels.x, pose.y - wheels.y);
+        maxError = fmax(maxError, error);
+    }
+    return error;
+}
+
+// drives dist at 600 mm/s, 6 mm per tick, and returns getDegreeChangeOver(over) at the end
+static int16_t turn(double dist, double curvature, int32_t over, int16_t& azimuth) {
+    ev3api::Motor left(PORT_C), right(PORT_B);
+    ev3api::GyroSensor gyro(PORT_4);
+    Plotter plotter(&left, &right, &gyro);
+    Wheels wheels;
+    for (double d = 0.0; d < dist; d += STEP) {
+        wheels.move(STEP, curvature);
+        wheels.tick();
+        plotter.plot();
+    }
+    azimuth = plotter.getDegree();
+    return plotter.getDegreeChangeOver(over);
+}
+
+int main() {
+    int failures = 0;
+    cout << "location error over 36 m of slalom at 600 mm/s, encoders in whole degrees:" << endl;
+    struct { const char* name; Integrator integrator; } integrators[] = {
+        { "INT_EULER   ", INT_EULER }, { "INT_MIDPOINT", INT_MIDPOINT }, { "INT_ARC     ", INT_ARC },
+    };
+    for (auto& i : integrators) {
+        double maxError, error = replay(i.integrator, maxError);
+        cout << " " << i.name << ": " << error << " mm at the end, " << maxError << " mm at most" << endl;
+    }
+    cout << "heading change over the last distance, across north:" << endl;
+    struct { const char* name; double dist, curvature; int32_t over; int expected; } cases[] = {
+        /* 2 degrees left over 100 mm from the start, ending at 358 */
+        { "2 deg left from north",  100.0, -2.0 * M_PI / 180.0 / 100.0, 100, -2 },
+        { "2 deg right from north", 100.0,  2.0 * M_PI / 180.0 / 100.0, 100,  2 },
+        /* a full circle and a quarter of 400 mm radius, crossing north on the way */
+        { "1.25 turns left",  2.5 * M_PI * 400.0, -1.0 / 400.0, (int32_t)(M_PI * 200.0), -90 },
+        { "1.25 turns right", 2.5 * M_PI * 400.0,  1.0 / 400.0, (int32_t)(M_PI * 200.0),  90 },
+    };
+    for (auto& c : cases) {
+        int16_t azimuth, change = turn(c.dist, c.curvature, c.over, azimuth);
+        bool ok = abs(change - c.expected) <= 2;
+        cout << " " << c.name << ": getDegreeChangeOver(" << c.over << ") = " << change
+             << " (expected " << c.expected << "), getDegree() = " << azimuth << (ok ? "" : " FAILED") << endl;
+        if (!ok) failures++;
+    }
+    return failures;
+}
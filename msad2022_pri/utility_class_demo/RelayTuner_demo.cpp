@@ -0,0 +1,84 @@
+// this example auto-tunes the line tracer by RelayTuner on a simulated robot
+// and compares tracking of the tuned gains with the default P_CONST, I_CONST and D_CONST
+//
+// g++ -std=gnu++11 RelayTuner_demo.cpp ../RelayTuner.cpp && ./a.out
+#include <iostream>
+#include <cmath>
+using namespace std;
+#include "../RelayTuner.hpp"
+#include "../PIDcontroller.hpp"
+
+#define DT          10000   // PERIOD_UPD_TSK in microsecond
+#define WHEEL_TREAD 128.0   // as in Plotter.hpp
+#define MMPS_PER_PWM 5.0    // forward speed per pwm
+#define TARGET      47.0    // GS_TARGET
+#define SPEED       50
+#define SENSOR_AHEAD 60.0
+
+// kinematic robot over the edge of a line; the line turns at the given curvature after 3 seconds.
+// y is the lateral offset of the axle center to the left of the edge; the color sensor sits
+// SENSOR_AHEAD mm in front of the axle and reads a ramp across the edge,
+// delayed by two samples as FIR_Transposed in FilteredColorSensor does
+struct LinePlant {
+    double y = 5.0, psi = 0.0, t = 0.0, curvature;
+    double buf[3] = {TARGET, TARGET, TARGET};
+    LinePlant(double c) : curvature(c) {}
+    double sense() {
+        double r = TARGET + 5.5 * (y + SENSOR_AHEAD * sin(psi));
+        r = fmin(fmax(r, 5.0), 90.0);
+        buf[2] = buf[1]; buf[1] = buf[0]; buf[0] = r;
+        return buf[2];
+    }
+    // turn as in TraceLine: pwmL = forward - turn, pwmR = forward + turn
+    void step(double turn) {
+        double dt = DT / 1000000.0, v = SPEED * MMPS_PER_PWM;
+        double omega = 2.0 * turn * MMPS_PER_PWM / WHEEL_TREAD;
+        double lineRate = (t >= 3.0) ? v * curvature : 0.0;
+        psi += (omega - lineRate) * dt;
+        y += v * sin(psi) * dt;
+        t += dt;
+    }
+};
+
+static void track(const char* name, double p, double i, double d) {
+    LinePlant plant(1.0 / 500.0);
+    PIDcontroller<float> pid(p, i, d, DT, -SPEED, SPEED, AW_CONDITIONAL);
+    double sum = 0.0, peak = 0.0;
+    int n = 0;
+    for (int k = 0; k < 800; k++) {
+        double sensor = plant.sense();
+        double err = sensor - TARGET;
+        plant.step(-pid.compute(sensor, TARGET));
+        if (k >= 100) { // after the initial offset is gone
+            sum += err * err;
+            peak = fmax(peak, fabs(err));
+            n++;
+        }
+    }
+    cout << " " << name << ": p = " << p << ", i = " << i << ", d = " << d
+         << ", rms error = " << sqrt(sum / n) << ", peak error = " << peak << endl;
+}
+
+int main() {
+    LinePlant plant(0.0);
+    RelayTuner tuner(5.0, 1.0, 4, DT);
+    int k;
+    for (k = 0; k < 3000 && !tuner.isDone(); k++) {
+        double sensor = plant.sense();
+        plant.step(-tuner.update(sensor - TARGET));
+    }
+    if (!tuner.isDone()) {
+        cout << "no sustained oscillation" << endl;
+        return 1;
+    }
+    cout << "relay finished in " << k * DT / 1000 << " ms: Ku = " << tuner.getUltimateGain()
+         << ", Tu = " << tuner.getUltimatePeriod() << " s" << endl;
+    cout << "tracking a curve of 500 mm radius at pwm " << SPEED << endl;
+    double p, i, d;
+    track("default         ", 0.75, 0.39, 0.08);
+    tuner.getGains(TR_ZIEGLER_NICHOLS, p, i, d);
+    track("Ziegler-Nichols ", p, i, d);
+    tuner.getGains(TR_TYREUS_LUYBEN, p, i, d);
+    track("Tyreus-Luyben   ", p, i, d);
+    return 0;
+}
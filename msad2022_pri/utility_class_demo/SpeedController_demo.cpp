@@ -0,0 +1,69 @@
+// this example compares the distance run by a constant pwm and by SpeedController
+// on a simulated EV3 motor across battery voltage and floor friction
+//
+// g++ -std=gnu++11 SpeedController_demo.cpp ../SpeedController.cpp ../MotorModel.cpp && ./a.out
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+using namespace std;
+#include "../SpeedController.hpp"
+#include "../MotorModel.hpp"
+
+#define DT              10000   // PERIOD_UPD_TSK in microsecond
+#define MM_PER_DEGREE   (M_PI * 100.0 / 360.0)  // DIST_PER_DEGREE of Plotter.hpp
+#define TARGET          300.0   // mm/s
+
+// motor as in MotorModel_demo.cpp without backlash, with the friction of the floor
+struct MotorPlant {
+    double battery, friction;
+    double omega = 0.0, motor = 0.0;
+    MotorPlant(double mV, double f) : battery(mV), friction(f) {}
+    int32_t count() const { return (int32_t)lrint(motor); }
+    void step(double pwm) {
+        const double degPerPwm = 11.0, tau = 0.05, dt = DT / 1000000.0;
+        double effective = pwm * battery / 8000.0;
+        double mag = fabs(effective) - friction;
+        double target = (mag > 0.0) ? copysign(mag * degPerPwm, effective) : 0.0;
+        omega += (target - omega) * dt / tau;
+        motor += omega * dt;
+    }
+};
+
+// distance in mm after 3 seconds and the speed error rms in the last 2 seconds
+static void run(const char* name, double mV, double friction, bool closed, bool model) {
+    MotorPlant p(mV, friction);
+    SpeedController sc(0.05, 0.5, 0.11, MM_PER_DEGREE, DT);
+    MotorModel mm(6.0, 8, 20.0, 8000);
+    mm.setBattery((int)mV);
+    sc.setTarget(TARGET);
+    double sum = 0.0, prev = 0.0;
+    int n = 0;
+    for (int k = 0; k < 300; k++) {
+        double pwm = closed ? sc.update(p.count()) : TARGET * 0.11;
+        if (model) pwm = mm.apply(pwm, p.count());
+        p.step(pwm);
+        double pos = p.motor * MM_PER_DEGREE;
+        if (k >= 100) {
+            double e = (pos - prev) / (DT / 1000000.0) - TARGET;
+            sum += e * e;
+            n++;
+        }
+        prev = pos;
+    }
+    cout << " " << name << ": " << setw(7) << p.motor * MM_PER_DEGREE << " mm, speed error rms "
+         << sqrt(sum / n) << " mm/s" << endl;
+}
+
+int main() {
+    cout << fixed << setprecision(1);
+    struct { const char* name; double mV, friction; } cases[] = {
+        { "8.0 V, friction 7 ", 8000.0, 7.0 }, { "7.2 V, friction 7 ", 7200.0, 7.0 },
+        { "8.4 V, friction 7 ", 8400.0, 7.0 }, { "8.0 V, friction 10", 8000.0, 10.0 },
+    };
+    cout << "running " << TARGET << " mm/s for 3 s, i.e., 900 mm" << endl;
+    for (int mode = 0; mode < 3; mode++) {
+        cout << (mode == 0 ? "constant pwm" : mode == 1 ? "SpeedController" : "SpeedController with MotorModel") << endl;
+        for (auto& c : cases) run(c.name, c.mV, c.friction, mode > 0, mode == 2);
+    }
+    return 0;
+}
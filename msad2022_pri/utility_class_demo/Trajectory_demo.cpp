@@ -0,0 +1,97 @@
+// this example compares RotateEV3 with the trajectory tracking of RotateByTrajectory
+// and MoveByTrajectory on two simulated EV3 motors
+//
+// g++ -std=gnu++11 Trajectory_demo.cpp ../Trajectory.cpp ../SpeedController.cpp && ./a.out
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+using namespace std;
+#include "../Trajectory.hpp"
+#include "../SpeedController.hpp"
+
+#define DT              10000   // PERIOD_UPD_TSK in microsecond
+#define MM_PER_DEGREE   (M_PI * 100.0 / 360.0)  // DIST_PER_DEGREE of Plotter.hpp
+#define TREAD           128.0   // WHEEL_TREAD of Plotter.hpp
+#define VMAX            400.0   // vmax of RotateByTrajectory and MoveByTrajectory
+#define AMAX            800.0   // TRJ_AMAX in appusr.hpp
+#define JMAX            8000.0  // TRJ_JMAX
+#define KP              10.0    // TRJ_KP
+#define TOLERANCE       MM_PER_DEGREE   // TRJ_TOLERANCE
+#define SETTLE          0.5     // TRJ_SETTLE_TIME
+
+// motor as in SpeedController_demo.cpp
+struct MotorPlant {
+    double omega = 0.0, motor = 0.0;
+    int32_t count() const { return (int32_t)lrint(motor); }
+    void step(double pwm) {
+        const double degPerPwm = 11.0, friction = 7.0, tau = 0.05, dt = DT / 1000000.0;
+        double mag = fabs(pwm) - friction;
+        double target = (mag > 0.0) ? copysign(mag * degPerPwm, pwm) : 0.0;
+        omega += (target - omega) * dt / tau;
+        motor += omega * dt;
+    }
+};
+
+// heading in degree by the odometry of Plotter
+static double heading(const MotorPlant& l, const MotorPlant& r) {
+    return (l.count() - r.count()) * MM_PER_DEGREE / TREAD * 180.0 / M_PI;
+}
+
+// let the wheels coast to rest after the maneuver
+static void coast(MotorPlant& l, MotorPlant& r) {
+    for (int k = 0; k < 100; k++) { l.step(0); r.step(0); }
+}
+
+// RotateEV3 with srew_rate = 0.0, stopped by StopNow when ended
+static void rotateEV3(int degree, int speed) {
+    MotorPlant l, r;
+    int k = 0;
+    while (heading(l, r) < degree) {
+        l.step(speed); r.step(-speed);
+        k++;
+    }
+    coast(l, r);
+    cout << " RotateEV3(" << degree << ", " << speed << ", 0.0)     " << setw(5) << k * DT / 1000 << " ms, stopped at "
+         << heading(l, r) << " deg" << endl;
+}
+
+// TrackTrajectory; dir_r = -1 rotates and dir_r = 1 moves straight
+static void track(const char* name, double arc, int dirR, double jmax) {
+    MotorPlant l, r;
+    SpeedController sl(0.05, 0.5, 0.11, MM_PER_DEGREE, DT), sr(0.05, 0.5, 0.11, MM_PER_DEGREE, DT);
+    Trajectory trj(VMAX, AMAX, jmax);
+    trj.plan(arc);
+    int k = 0;
+    for (;; k++) {
+        double t = k * DT / 1000000.0, pos, vel;
+        trj.sample(t, pos, vel);
+        double errL = pos - l.count() * MM_PER_DEGREE;
+        double errR = dirR * pos - r.count() * MM_PER_DEGREE;
+        if (t >= trj.getDuration() &&
+            ((fabs(errL) <= TOLERANCE && fabs(errR) <= TOLERANCE) || t >= trj.getDuration() + SETTLE)) break;
+        sl.setTarget(vel + KP * errL);
+        sr.setTarget(dirR * vel + KP * errR);
+        l.step(sl.update(l.count()));
+        r.step(sr.update(r.count()));
+    }
+    // hold the position as setSpeed(0.0) does when ended
+    sl.setTarget(0.0); sr.setTarget(0.0);
+    for (int j = 0; j < 100; j++) { l.step(sl.update(l.count())); r.step(sr.update(r.count())); }
+    cout << " " << name << setw(5) << k * DT / 1000 << " ms, stopped at ";
+    if (dirR < 0) cout << heading(l, r) << " deg" << endl;
+    else cout << (l.count() + r.count()) * MM_PER_DEGREE / 2.0 << " mm, heading " << heading(l, r) << " deg" << endl;
+}
+
+int main() {
+    cout << fixed << setprecision(1);
+    cout << "rotate 90 degrees" << endl;
+    rotateEV3(90, 30);
+    rotateEV3(90, 50);
+    double arc = 90.0 * M_PI / 180.0 * TREAD / 2.0;
+    track("RotateByTrajectory trapezoid", arc, -1, 0.0);
+    track("RotateByTrajectory S-curve  ", arc, -1, JMAX);
+    cout << "move 500 mm" << endl;
+    track("MoveByTrajectory trapezoid  ", 500.0, 1, 0.0);
+    track("MoveByTrajectory S-curve    ", 500.0, 1, JMAX);
+    return 0;
+}